@@ -10,7 +10,8 @@ enum class task_t : int
 {
     ground_state_new     = 0,
     ground_state_restart = 1,
-    k_point_path         = 2
+    k_point_path         = 2,
+    relaxation           = 3
 };
 
 const double au2angs = 0.5291772108;
@@ -187,6 +188,82 @@ double ground_state(Simulation_context& ctx,
     return dft.total_energy();
 }
 
+/// Relax atomic positions with the steepest descent method.
+/** Density and wave-functions of the previous ionic steps are extrapolated to the new atomic positions. */
+void relaxation(Simulation_context& ctx, cmd_args const& args)
+{
+    Potential potential(ctx);
+    potential.allocate();
+
+    Density density(ctx);
+    density.allocate();
+
+    Hamiltonian H(ctx, potential);
+
+    auto& inp = ctx.parameters_input();
+
+    K_point_set ks(ctx, inp.ngridk_, inp.shiftk_, ctx.use_symmetry());
+    ks.initialize();
+
+    DFT_ground_state dft(ctx, H, density, ks);
+
+    Extrapolation extrapolation(ctx, density, ks, inp.extrapolation_order_);
+
+    int num_ionic_steps = args.value<int>("num_ionic_steps", 10);
+    double ionic_step   = args.value<double>("ionic_step", 1.0);
+
+    density.initial_density();
+    potential.generate(density);
+    dft.band().initialize_subspace(ks, H);
+
+    auto& uc = ctx.unit_cell();
+
+    for (int istep = 0; istep < num_ionic_steps; istep++) {
+        int result = dft.find(inp.potential_tol_, inp.energy_tol_, inp.num_dft_iter_, false);
+
+        Force f(ctx, density, potential, ks);
+        f.calc_forces_total();
+        auto& forces = f.forces_total();
+
+        double fmax{0};
+        for (int ia = 0; ia < uc.num_atoms(); ia++) {
+            fmax = std::max(fmax, vector3d<double>(forces(0, ia), forces(1, ia), forces(2, ia)).length());
+        }
+        if (ctx.comm().rank() == 0) {
+            printf("ionic step: %i, number of SCF iterations: %i, total energy: %18.10f, maximum force: %12.6f\n",
+                   istep, result, dft.total_energy(), fmax);
+        }
+        if (fmax < 1e-4) {
+            break;
+        }
+
+        extrapolation.save();
+
+        /* move atoms along the forces */
+        for (int ia = 0; ia < uc.num_atoms(); ia++) {
+            vector3d<double> dr(forces(0, ia), forces(1, ia), forces(2, ia));
+            auto pos = uc.atom(ia).position() + uc.get_fractional_coordinates(dr * ionic_step);
+            uc.atom(ia).set_position(pos);
+        }
+        ctx.update_atomic_positions();
+        dft.update();
+
+        extrapolation.extrapolate();
+        potential.generate(density);
+    }
+
+    if (ctx.comm().rank() == 0) {
+        uc.print_info(ctx.control().verbosity_);
+    }
+
+    /* wait for all */
+    ctx.comm().barrier();
+
+    if (ctx.control().print_timers_ && ctx.comm().rank() == 0)  {
+        sddk::timer::print();
+    }
+}
+
 /// Run a task based on a command line input.
 void run_tasks(cmd_args const& args)
 {
@@ -207,6 +284,15 @@ void run_tasks(cmd_args const& args)
         ground_state(*ctx, task, args, 1);
     }
 
+    if (task == task_t::relaxation) {
+        auto ctx = create_sim_ctx(fname, args);
+        ctx->initialize();
+        if (ctx->full_potential()) {
+            TERMINATE("relaxation is implemented only for the pseudopotential methods");
+        }
+        relaxation(*ctx, args);
+    }
+
     if (task == task_t::k_point_path) {
         auto ctx = create_sim_ctx(fname, args);
         ctx->set_iterative_solver_tolerance(1e-12);
@@ -318,6 +404,8 @@ int main(int argn, char** argv)
     cmd_args args;
     args.register_key("--input=", "{string} input file name");
     args.register_key("--task=", "{int} task id");
+    args.register_key("--num_ionic_steps=", "{int} maximum number of ionic steps in relaxation");
+    args.register_key("--ionic_step=", "{double} scaling factor for the atomic displacement along the force");
     args.register_key("--mpi_grid=", "{vector int} MPI grid dimensions");
     args.register_key("--aiida_output", "write output for AiiDA");
     args.register_key("--test_against=", "{string} json file with reference values");
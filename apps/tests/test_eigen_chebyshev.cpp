@@ -0,0 +1,158 @@
+#include <sirius.h>
+
+using namespace sirius;
+
+/* Hermitian matrix with the spread spectrum */
+void random_hermitian(int N__, dmatrix<double_complex>& A__)
+{
+    for (int j = 0; j < N__; j++) {
+        for (int i = 0; i <= j; i++) {
+            A__(i, j) = (i == j) ? double_complex(0.1 * i + type_wrapper<double>::random(), 0)
+                                 : type_wrapper<double_complex>::random();
+            A__(j, i) = std::conj(A__(i, j));
+        }
+    }
+}
+
+/* well-conditioned positive definite matrix */
+void random_positive_definite(int N__, dmatrix<double_complex>& B__)
+{
+    matrix<double_complex> c(N__, N__);
+    for (int j = 0; j < N__; j++) {
+        for (int i = 0; i < N__; i++) {
+            c(i, j) = type_wrapper<double_complex>::random() / std::sqrt(double(N__));
+        }
+    }
+    linalg<CPU>::gemm(2, 0, N__, N__, N__, c.at<CPU>(), c.ld(), c.at<CPU>(), c.ld(), B__.at<CPU>(), B__.ld());
+    for (int i = 0; i < N__; i++) {
+        B__(i, i) += 1.0;
+    }
+}
+
+/* copy of the full matrix */
+void copy(int N__, dmatrix<double_complex> const& src__, dmatrix<double_complex>& dest__)
+{
+    for (int j = 0; j < N__; j++) {
+        for (int i = 0; i < N__; i++) {
+            dest__(i, j) = src__(i, j);
+        }
+    }
+}
+
+/* compare the Chebyshev solver with LAPACK zhegvx; Z contains the starting guess of the Chebyshev solver */
+int test_gen(Communicator const& comm__, int N__, int nev__, bool warm_start__)
+{
+    dmatrix<double_complex> A(N__, N__);
+    dmatrix<double_complex> B(N__, N__);
+    /* identical matrices on all ranks */
+    if (comm__.rank() == 0) {
+        random_hermitian(N__, A);
+        random_positive_definite(N__, B);
+    }
+    comm__.bcast(A.at<CPU>(), N__ * N__, 0);
+    comm__.bcast(B.at<CPU>(), N__ * N__, 0);
+
+    dmatrix<double_complex> A1(N__, N__);
+    dmatrix<double_complex> B1(N__, N__);
+
+    /* reference solution */
+    copy(N__, A, A1);
+    copy(N__, B, B1);
+    dmatrix<double_complex> Z_ref(N__, nev__);
+    std::vector<double> eval_ref(nev__);
+    if (Eigensolver_lapack<double_complex>().solve(N__, nev__, A1, B1, eval_ref.data(), Z_ref)) {
+        printf("zhegvx failed\n");
+        return 1;
+    }
+
+    dmatrix<double_complex> Z(N__, nev__);
+    if (warm_start__) {
+        /* eigen-vectors of the slightly different problem */
+        for (int j = 0; j < nev__; j++) {
+            for (int i = 0; i < N__; i++) {
+                Z(i, j) = Z_ref(i, j) + 1e-3 * std::abs(Z_ref(i, j)) * type_wrapper<double_complex>::random();
+            }
+        }
+        comm__.bcast(Z.at<CPU>(), N__ * nev__, 0);
+    } else {
+        Z.zero();
+    }
+
+    copy(N__, A, A1);
+    copy(N__, B, B1);
+    std::vector<double> eval(nev__);
+    if (Eigensolver_chebyshev<double_complex>(comm__).solve(N__, nev__, A1, B1, eval.data(), Z)) {
+        printf("Chebyshev solver failed\n");
+        return 1;
+    }
+
+    double diff_eval{0};
+    for (int i = 0; i < nev__; i++) {
+        diff_eval = std::max(diff_eval, std::abs(eval[i] - eval_ref[i]));
+    }
+
+    /* A Z - B Z lambda */
+    matrix<double_complex> az(N__, nev__);
+    matrix<double_complex> bz(N__, nev__);
+    linalg<CPU>::gemm(0, 0, N__, nev__, N__, A.at<CPU>(), A.ld(), Z.at<CPU>(), Z.ld(), az.at<CPU>(), az.ld());
+    linalg<CPU>::gemm(0, 0, N__, nev__, N__, B.at<CPU>(), B.ld(), Z.at<CPU>(), Z.ld(), bz.at<CPU>(), bz.ld());
+    double diff_res{0};
+    for (int j = 0; j < nev__; j++) {
+        for (int i = 0; i < N__; i++) {
+            diff_res = std::max(diff_res, std::abs(az(i, j) - eval[j] * bz(i, j)));
+        }
+    }
+
+    /* Z^{H} B Z = I */
+    matrix<double_complex> o(nev__, nev__);
+    linalg<CPU>::gemm(2, 0, nev__, nev__, N__, Z.at<CPU>(), Z.ld(), bz.at<CPU>(), bz.ld(), o.at<CPU>(), o.ld());
+    double diff_ovlp{0};
+    for (int j = 0; j < nev__; j++) {
+        for (int i = 0; i < nev__; i++) {
+            diff_ovlp = std::max(diff_ovlp, std::abs(o(i, j) - ((i == j) ? 1.0 : 0.0)));
+        }
+    }
+
+    if (comm__.rank() == 0) {
+        printf("N = %i, nev = %i, %s start\n", N__, nev__, warm_start__ ? "warm" : "cold");
+        printf("  maximum difference of eigen-values : %18.12e\n", diff_eval);
+        printf("  maximum residual                   : %18.12e\n", diff_res);
+        printf("  maximum error of B-orthonormality  : %18.12e\n", diff_ovlp);
+    }
+
+    return (diff_eval > 1e-10 || diff_res > 1e-6 || diff_ovlp > 1e-10) ? 1 : 0;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--N=", "{int} matrix size");
+    args.register_key("--nev=", "{int} number of eigen-vectors");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+    auto N   = args.value<int>("N", 400);
+    auto nev = args.value<int>("nev", 20);
+
+    sirius::initialize(1);
+    int err{0};
+    for (auto comm : {&mpi_comm_self(), &mpi_comm_world()}) {
+        for (bool warm_start : {false, true}) {
+            err += test_gen(*comm, N, nev, warm_start);
+        }
+    }
+    if (mpi_comm_world().rank() == 0) {
+        if (err) {
+            printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+        } else {
+            printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+        }
+    }
+    sirius::finalize();
+
+    return err;
+}
@@ -2,19 +2,93 @@
 
 using namespace sirius;
 
-void test1()
+/* two atoms of the same type in the diamond-like positions, shifted by the vector t */
+void setup(Simulation_context& ctx, vector3d<double> t)
 {
-    Simulation_context ctx(mpi_comm_world());
-    ctx.set_esm_type("full_potential_lapwlo");
+    ctx.set_processing_unit("cpu");
+    ctx.set_pw_cutoff(12);
+    ctx.set_gk_cutoff(4);
 
-    ctx.unit_cell().add_atom_type("A", "");
-    ctx.unit_cell().add_atom_type("B", "");
+    double a{5};
+    ctx.unit_cell().set_lattice_vectors({{a, 0, 0}, {0, a, 0}, {0, 0, a}});
 
-    ctx.unit_cell().atom_type(0).zn(10);
-    ctx.unit_cell().atom_type(1).zn(20);
-    
+    ctx.unit_cell().add_atom_type("A");
+
+    auto& atype = ctx.unit_cell().atom_type(0);
+
+    atype.zn(1);
+    atype.set_radial_grid(radial_grid_t::lin_exp_grid, 1000, 0, 2);
+
+    std::vector<double> beta(atype.num_mt_points());
+    std::vector<double> vloc(atype.num_mt_points());
+    for (int i = 0; i < atype.num_mt_points(); i++) {
+        double x = atype.radial_grid(i);
+        beta[i] = std::exp(-x) * (4 - x * x);
+        vloc[i] = -std::erf(x) / (x + 1e-12);
+    }
+    atype.add_beta_radial_function(0, beta);
+    atype.local_potential(vloc);
+
+    matrix<double> d_mtrx_ion(atype.num_beta_radial_functions(), atype.num_beta_radial_functions());
+    d_mtrx_ion.zero();
+    for (int i = 0; i < atype.num_beta_radial_functions(); i++) {
+        d_mtrx_ion(i, i) = 1;
+    }
+    atype.d_mtrx_ion(d_mtrx_ion);
+
+    Spline<double> ps_dens(atype.radial_grid());
+    for (int i = 0; i < atype.num_mt_points(); i++) {
+        double x = atype.radial_grid(i);
+        ps_dens(i) = std::exp(-x * x) * x * x;
+    }
+    double norm = ps_dens.interpolate().integrate(0);
+    ps_dens.scale(1 / norm);
+    atype.ps_total_charge_density(ps_dens.values());
+    atype.ps_core_charge_density(std::vector<double>(atype.num_mt_points(), 0));
+
+    ctx.unit_cell().add_atom("A", vector3d<double>({0, 0, 0}) + t);
+    ctx.unit_cell().add_atom("A", vector3d<double>({0.25, 0.25, 0.25}) + t);
+}
+
+/* atoms are moved in the initialized context and compared with the context set up at the new positions */
+int test1()
+{
+    vector3d<double> t({0.013, 0.021, 0.007});
+
+    Simulation_context ctx(mpi_comm_world(), "pseudopotential");
+    setup(ctx, {0, 0, 0});
     ctx.initialize();
+    Potential pot(ctx);
+
+    for (int ia = 0; ia < ctx.unit_cell().num_atoms(); ia++) {
+        ctx.unit_cell().atom(ia).set_position(ctx.unit_cell().atom(ia).position() + t);
+    }
+    ctx.update_atomic_positions();
+    pot.update();
+
+    Simulation_context ctx_ref(mpi_comm_world(), "pseudopotential");
+    setup(ctx_ref, t);
+    ctx_ref.initialize();
+    Potential pot_ref(ctx_ref);
+
+    if (ctx.unit_cell().symmetry().num_mag_sym() != ctx_ref.unit_cell().symmetry().num_mag_sym() ||
+        ctx.unit_cell().num_atom_symmetry_classes() != ctx_ref.unit_cell().num_atom_symmetry_classes()) {
+        printf("wrong symmetry of the moved atoms\n");
+        return 1;
+    }
 
+    double diff{0};
+    for (int igloc = 0; igloc < ctx.gvec().count(); igloc++) {
+        diff = std::max(diff, std::abs(pot.local_potential().f_pw_local(igloc) -
+                                       pot_ref.local_potential().f_pw_local(igloc)));
+    }
+    ctx.comm().allreduce<double, mpi_op_t::max>(&diff, 1);
+    if (diff > 1e-12) {
+        printf("wrong local potential of the moved atoms, difference : %18.12e\n", diff);
+        return 1;
+    }
+
+    return 0;
 }
 
 int main(int argn, char** argv)
@@ -30,7 +104,16 @@ int main(int argn, char** argv)
 
     sirius::initialize();
 
-    test1();
+    int err = test1();
+    if (mpi_comm_world().rank() == 0) {
+        if (err) {
+            printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+        } else {
+            printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+        }
+    }
 
     sirius::finalize();
+
+    return err;
 }
@@ -0,0 +1,93 @@
+#include <sirius.h>
+
+using namespace sirius;
+
+/* gives access to the batched forward integration */
+class Radial_solver_test: public Radial_solver
+{
+    public:
+
+        Radial_solver_test(int zn__, std::vector<double> const& v__, Radial_grid<double> const& radial_grid__)
+            : Radial_solver(zn__, v__, radial_grid__)
+        {
+        }
+
+        using Radial_solver::integrate_forward_batch;
+};
+
+/* compare Adams-Bashforth-Moulton and Runge-Kutta integration of the radial equation */
+int test_radial_integrator(int zn__, int n__, int l__, double R__)
+{
+    auto rgrid = Radial_grid_factory<double>(lin_exp_grid, 1500, 1e-7, R__);
+    std::vector<double> v(rgrid.num_points());
+    for (int ir = 0; ir < rgrid.num_points(); ir++) {
+        v[ir] = -double(zn__) / rgrid[ir];
+    }
+
+    int err{0};
+
+    Enu_finder e1(relativity_t::none, zn__, n__, l__, rgrid, v, -0.1, radial_integrator_t::rk4);
+    Enu_finder e2(relativity_t::none, zn__, n__, l__, rgrid, v, -0.1, radial_integrator_t::abm4);
+
+    /* both methods are of 4th order, but with different error constants */
+    double tol = 1e-5 * std::max(1.0, std::max(std::abs(e1.ebot()), std::abs(e1.etop())));
+    if (std::abs(e1.ebot() - e2.ebot()) > tol || std::abs(e1.etop() - e2.etop()) > tol ||
+        std::abs(e1.enu() - e2.enu()) > tol) {
+        printf("Z: %i n: %i l: %i\n", zn__, n__, l__);
+        printf("  rk4  (bottom, top, enu): %18.12f %18.12f %18.12f\n", e1.ebot(), e1.etop(), e1.enu());
+        printf("  abm4 (bottom, top, enu): %18.12f %18.12f %18.12f\n", e2.ebot(), e2.etop(), e2.enu());
+        err++;
+    }
+
+    /* p(R) of the deep states is exponentially small and is dominated by the integration error */
+    if (e1.etop() - e1.ebot() < 0.01) {
+        return err;
+    }
+
+    /* energies inside and around the band, away from the band edges; the normalization of the regular solution
+     * depends on the first steps of the integration, so the surface values are compared via the phase of
+     * (p(R), R p'(R)), which defines the band edges */
+    std::vector<double> enu;
+    for (int i = 0; i < 8; i++) {
+        enu.push_back(e1.ebot() + (e1.etop() - e1.ebot()) * (i - 1.5) / 5.0);
+    }
+
+    Radial_solver_test solver(zn__, v, rgrid);
+
+    std::vector<int> nn1, nn2;
+    std::vector<double> p1, p2, dpdr1, dpdr2;
+    solver.integrate_forward_batch<relativity_t::none, radial_integrator_t::rk4>(l__, enu, nn1, p1, dpdr1);
+    solver.integrate_forward_batch<relativity_t::none, radial_integrator_t::abm4>(l__, enu, nn2, p2, dpdr2);
+
+    for (size_t j = 0; j < enu.size(); j++) {
+        double phi1 = std::atan2(R__ * dpdr1[j], p1[j]);
+        double phi2 = std::atan2(R__ * dpdr2[j], p2[j]);
+        if (nn1[j] != nn2[j] || std::abs(phi1 - phi2) > 1e-4) {
+            printf("Z: %i n: %i l: %i enu: %18.12f\n", zn__, n__, l__, enu[j]);
+            printf("  rk4  nn: %i p(R): %18.12e p'(R): %18.12e\n", nn1[j], p1[j], dpdr1[j]);
+            printf("  abm4 nn: %i p(R): %18.12e p'(R): %18.12e\n", nn2[j], p2[j], dpdr2[j]);
+            err++;
+        }
+    }
+    return err;
+}
+
+int main(int argn, char** argv)
+{
+    sirius::initialize(1);
+    int err{0};
+    for (int zn: {1, 8, 26, 56, 92}) {
+        for (int n = 1; n < 7; n++) {
+            for (int l = 0; l < std::min(n, 4); l++) {
+                err += test_radial_integrator(zn, n, l, 1.5);
+            }
+        }
+    }
+    if (err) {
+        printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+    } else {
+        printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+    }
+    sirius::finalize();
+    return err;
+}
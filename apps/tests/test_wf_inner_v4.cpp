@@ -0,0 +1,101 @@
+#include <sirius.h>
+
+using namespace sirius;
+
+/* compare Hermitian and multi-pair version of inner() with the plain inner product */
+void test_wf_inner(std::vector<int> mpi_grid_dims__,
+                   double cutoff__,
+                   int N__,
+                   int n__,
+                   int bs__)
+{
+    int num_bands = N__ + n__;
+
+    BLACS_grid blacs_grid(mpi_comm_world(), mpi_grid_dims__[0], mpi_grid_dims__[1]);
+
+    matrix3d<double> M = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+
+    /* create G-vectors */
+    Gvec gvec(M, cutoff__, mpi_comm_world(), false);
+
+    Gvec_partition gvecp(gvec, mpi_comm_world(), mpi_comm_self());
+
+    if (mpi_comm_world().rank() == 0) {
+        printf("total number of G-vectors: %i\n", gvec.num_gvec());
+        printf("local number of G-vectors: %i\n", gvec.count());
+    }
+
+    Wave_functions phi(gvecp, num_bands, 1);
+    Wave_functions hphi(gvecp, num_bands, 1);
+
+    /* hphi is a diagonal Hermitian operator applied to phi */
+    for (int i = 0; i < num_bands; i++) {
+        for (int igloc = 0; igloc < gvec.count(); igloc++) {
+            phi.pw_coeffs(0).prime(igloc, i) = type_wrapper<double_complex>::random();
+            hphi.pw_coeffs(0).prime(igloc, i) = phi.pw_coeffs(0).prime(igloc, i) * (1.0 + (igloc + gvec.offset()) % 7);
+        }
+    }
+
+    dmatrix<double_complex> h_ref(num_bands, num_bands, blacs_grid, bs__, bs__);
+    dmatrix<double_complex> o_ref(num_bands, num_bands, blacs_grid, bs__, bs__);
+    dmatrix<double_complex> h(num_bands, num_bands, blacs_grid, bs__, bs__);
+    dmatrix<double_complex> o(num_bands, num_bands, blacs_grid, bs__, bs__);
+    h_ref.zero();
+    o_ref.zero();
+    h.zero();
+    o.zero();
+
+    inner(CPU, 0, phi, 0, num_bands, hphi, N__, n__, h_ref, 0, N__);
+    inner(CPU, 0, phi, 0, num_bands, phi, N__, n__, o_ref, 0, N__);
+
+    sddk::timer t1("inner");
+    inner<double_complex>(CPU, 0, {&phi, &phi}, 0, num_bands, {&hphi, &phi}, N__, n__, {&h, &o}, 0, N__, true);
+    t1.stop();
+
+    double diff{0};
+    for (int j = 0; j < h.num_cols_local(); j++) {
+        for (int i = 0; i < h.num_rows_local(); i++) {
+            diff = std::max(diff, std::abs(h(i, j) - h_ref(i, j)));
+            diff = std::max(diff, std::abs(o(i, j) - o_ref(i, j)));
+        }
+    }
+    mpi_comm_world().allreduce<double, mpi_op_t::max>(&diff, 1);
+    if (mpi_comm_world().rank() == 0) {
+        printf("maximum difference: %18.12e\n", diff);
+    }
+    if (diff > 1e-10) {
+        printf("\x1b[31m" "Failed\n" "\x1b[0m" "\n");
+    } else {
+        printf("\x1b[32m" "OK\n" "\x1b[0m" "\n");
+    }
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--mpi_grid_dims=", "{int int} dimensions of MPI grid");
+    args.register_key("--cutoff=", "{double} wave-functions cutoff");
+    args.register_key("--bs=", "{int} block size");
+    args.register_key("--N=", "{int} number of old bands");
+    args.register_key("--n=", "{int} number of new bands");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+    auto mpi_grid_dims = args.value<std::vector<int>>("mpi_grid_dims", {1, 1});
+    auto cutoff = args.value<double>("cutoff", 8.0);
+    auto bs = args.value<int>("bs", 32);
+    auto N = args.value<int>("N", 100);
+    auto n = args.value<int>("n", 50);
+
+    sirius::initialize(1);
+
+    test_wf_inner(mpi_grid_dims, cutoff, N, n, bs);
+
+    mpi_comm_world().barrier();
+    sddk::timer::print();
+    sirius::finalize();
+}
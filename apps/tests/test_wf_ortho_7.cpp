@@ -0,0 +1,92 @@
+#include <sirius.h>
+
+using namespace sirius;
+
+/* orthogonalize ill-conditioned blocks of wave-functions with different methods */
+void test_wf_ortho(double cutoff__,
+                   int N__,
+                   int n__,
+                   ortho_method_t method__)
+{
+    int num_bands = N__ + n__;
+
+    BLACS_grid blacs_grid(mpi_comm_self(), 1, 1);
+
+    matrix3d<double> M = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+
+    /* create G-vectors */
+    Gvec gvec(M, cutoff__, mpi_comm_world(), false);
+
+    Gvec_partition gvecp(gvec, mpi_comm_world(), mpi_comm_self());
+
+    Wave_functions phi(gvecp, num_bands, 1);
+    Wave_functions hphi(gvecp, num_bands, 1);
+    Wave_functions tmp(gvecp, num_bands, 1);
+
+    /* neighbouring wave-functions are almost linear dependent */
+    for (int i = 0; i < num_bands; i++) {
+        for (int igloc = 0; igloc < gvec.count(); igloc++) {
+            phi.pw_coeffs(0).prime(igloc, i) = type_wrapper<double_complex>::random();
+            if (i > 0) {
+                phi.pw_coeffs(0).prime(igloc, i) = phi.pw_coeffs(0).prime(igloc, i - 1) +
+                                                   1e-6 * phi.pw_coeffs(0).prime(igloc, i);
+            }
+            hphi.pw_coeffs(0).prime(igloc, i) = phi.pw_coeffs(0).prime(igloc, i) * (1.0 + (igloc + gvec.offset()) % 7);
+        }
+    }
+
+    dmatrix<double_complex> ovlp(num_bands, num_bands, blacs_grid, 16, 16);
+
+    sddk::timer t1("ortho");
+    orthogonalize<double_complex>(CPU, 0, phi, hphi, 0, N__, ovlp, tmp, method__);
+    orthogonalize<double_complex>(CPU, 0, phi, hphi, N__, n__, ovlp, tmp, method__);
+    t1.stop();
+
+    /* check the orthogonality of each block */
+    inner(CPU, 0, phi, 0, num_bands, phi, 0, num_bands, ovlp, 0, 0);
+
+    double diff{0};
+    for (int j = 0; j < num_bands; j++) {
+        for (int i = 0; i < num_bands; i++) {
+            if ((i < N__) == (j < N__)) {
+                double_complex z = (i == j) ? ovlp(i, j) - 1.0 : ovlp(i, j);
+                diff = std::max(diff, std::abs(z));
+            }
+        }
+    }
+    if (mpi_comm_world().rank() == 0) {
+        printf("method: %i, maximum deviation from identity: %18.12e\n", static_cast<int>(method__), diff);
+    }
+    if (diff > 1e-12) {
+        printf("\x1b[31m" "Failed\n" "\x1b[0m" "\n");
+    } else {
+        printf("\x1b[32m" "OK\n" "\x1b[0m" "\n");
+    }
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--cutoff=", "{double} wave-functions cutoff");
+    args.register_key("--N=", "{int} number of old bands");
+    args.register_key("--n=", "{int} number of new bands");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+    auto cutoff = args.value<double>("cutoff", 8.0);
+    auto N = args.value<int>("N", 100);
+    auto n = args.value<int>("n", 50);
+
+    sirius::initialize(1);
+
+    test_wf_ortho(cutoff, N, n, ortho_method_t::cholesky_qr2);
+    test_wf_ortho(cutoff, N, n, ortho_method_t::tsqr);
+
+    mpi_comm_world().barrier();
+    sddk::timer::print();
+    sirius::finalize();
+}
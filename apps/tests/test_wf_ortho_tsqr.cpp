@@ -0,0 +1,144 @@
+#include <sirius.h>
+
+using namespace sirius;
+
+/* sum of |a_j - z_j * b_j|^2 over the local coefficients of the j-th wave-function */
+double diff(Wave_functions& a__, Wave_functions& b__, int j__, double_complex z__)
+{
+    double d{0};
+    for (int i = 0; i < a__.pw_coeffs(0).num_rows_loc(); i++) {
+        d += std::pow(std::abs(a__.pw_coeffs(0).prime(i, j__) - z__ * b__.pw_coeffs(0).prime(i, j__)), 2);
+    }
+    for (int i = 0; i < a__.mt_coeffs(0).num_rows_loc(); i++) {
+        d += std::pow(std::abs(a__.mt_coeffs(0).prime(i, j__) - z__ * b__.mt_coeffs(0).prime(i, j__)), 2);
+    }
+    return d;
+}
+
+int test_wf_ortho_tsqr(double cutoff__, int num_bands__)
+{
+    matrix3d<double> M = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+
+    Gvec gvec(M, cutoff__, mpi_comm_world(), false);
+    Gvec_partition gvecp(gvec, mpi_comm_world(), mpi_comm_self());
+
+    int num_atoms = 10;
+    auto nmt = [](int i) {
+        return 20;
+    };
+
+    int nwf = 2 * num_bands__;
+
+    /* reference wave-functions, orthogonalized with Cholesky-QR2 */
+    Wave_functions phi(gvecp, num_atoms, nmt, nwf);
+    Wave_functions hphi(gvecp, num_atoms, nmt, nwf);
+    Wave_functions sphi(gvecp, num_atoms, nmt, nwf);
+    /* wave-functions, orthogonalized with TSQR */
+    Wave_functions phi1(gvecp, num_atoms, nmt, nwf);
+    Wave_functions hphi1(gvecp, num_atoms, nmt, nwf);
+    Wave_functions sphi1(gvecp, num_atoms, nmt, nwf);
+
+    Wave_functions tmp(gvecp, num_atoms, nmt, nwf);
+
+    phi.pw_coeffs(0).prime() = [](int64_t i0, int64_t i1){return type_wrapper<double_complex>::random();};
+    phi.mt_coeffs(0).prime() = [](int64_t i0, int64_t i1){return type_wrapper<double_complex>::random();};
+    hphi.pw_coeffs(0).prime() = [](int64_t i0, int64_t i1){return type_wrapper<double_complex>::random();};
+    hphi.mt_coeffs(0).prime() = [](int64_t i0, int64_t i1){return type_wrapper<double_complex>::random();};
+    /* no S operator */
+    sphi.copy_from(CPU, nwf, phi, 0, 0, 0, 0);
+
+    phi1.copy_from(CPU, nwf, phi, 0, 0, 0, 0);
+    hphi1.copy_from(CPU, nwf, hphi, 0, 0, 0, 0);
+    sphi1.copy_from(CPU, nwf, phi, 0, 0, 0, 0);
+
+    /* overlap matrix is replicated on all ranks */
+    dmatrix<double_complex> ovlp(nwf, nwf);
+
+    for (int N: {0, num_bands__}) {
+        orthogonalize<double_complex>(CPU, 0, phi, hphi, sphi, N, num_bands__, ovlp, tmp,
+                                      ortho_method_t::cholesky_qr2);
+        orthogonalize<double_complex>(CPU, 0, phi1, hphi1, sphi1, N, num_bands__, ovlp, tmp,
+                                      ortho_method_t::tsqr);
+    }
+
+    int err{0};
+
+    /* TSQR wave-functions must be orthonormal */
+    inner(CPU, 0, phi1, 0, nwf, phi1, 0, nwf, ovlp, 0, 0);
+    for (int j = 0; j < nwf; j++) {
+        for (int i = 0; i < nwf; i++) {
+            double_complex z = (i == j) ? ovlp(i, j) - 1.0 : ovlp(i, j);
+            if (std::abs(z) > 1e-12) {
+                err = 1;
+            }
+        }
+    }
+    if (err) {
+        printf("wrong overlap of TSQR wave-functions\n");
+        return err;
+    }
+
+    /* both methods do the triangular transformation of the same wave-functions, so the results differ only by
+     * the phase factors of the columns */
+    inner(CPU, 0, phi, 0, nwf, phi1, 0, nwf, ovlp, 0, 0);
+    for (int j = 0; j < nwf; j++) {
+        for (int i = 0; i < nwf; i++) {
+            double d = (i == j) ? std::abs(ovlp(i, j)) - 1.0 : std::abs(ovlp(i, j));
+            if (std::abs(d) > 1e-10) {
+                err = 1;
+            }
+        }
+    }
+    if (err) {
+        printf("TSQR and Cholesky-QR2 wave-functions span different subspaces\n");
+        return err;
+    }
+
+    /* the same transformation must be applied to hphi and sphi */
+    double dh{0};
+    double ds{0};
+    for (int j = 0; j < nwf; j++) {
+        dh += diff(hphi1, hphi, j, ovlp(j, j));
+        ds += diff(sphi1, phi1, j, 1.0);
+    }
+    mpi_comm_world().allreduce(&dh, 1);
+    mpi_comm_world().allreduce(&ds, 1);
+    if (std::sqrt(dh) > 1e-10 || std::sqrt(ds) > 1e-10) {
+        printf("wrong transformation of hphi or sphi: %18.12e %18.12e\n", std::sqrt(dh), std::sqrt(ds));
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--cutoff=", "{double} wave-functions cutoff");
+    args.register_key("--num_bands=", "{int} maximum number of bands");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+    auto cutoff = args.value<double>("cutoff", 8.0);
+    auto num_bands = args.value<int>("num_bands", 20);
+
+    sirius::initialize(1);
+    int err{0};
+    for (int n = 1; n <= num_bands; n++) {
+        err += test_wf_ortho_tsqr(cutoff, n);
+    }
+    if (mpi_comm_world().rank() == 0) {
+        if (err) {
+            printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+        } else {
+            printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+        }
+    }
+    sirius::finalize();
+
+    return err;
+}
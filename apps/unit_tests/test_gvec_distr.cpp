@@ -0,0 +1,90 @@
+#include <sirius.h>
+
+using namespace sirius;
+
+/* Check the distribution of z-columns and G-vectors between MPI ranks; run on 3, 5 and 7 ranks to test the
+ * case when the number of z-columns is not divisible by the number of ranks. */
+void test_gvec_distr(matrix3d<double> M__, double cutoff__, double cutoff_dense__)
+{
+    Gvec gvec(M__, cutoff__, mpi_comm_world(), false);
+    Gvec gvec_dense(cutoff_dense__, gvec);
+
+    for (auto gv : {&gvec, &gvec_dense}) {
+        auto& comm = gv->comm();
+        /* the same FFT grid as in Gvec::init() */
+        auto fft_grid = FFT3D_grid(find_translations(gv == &gvec ? cutoff__ : cutoff_dense__, M__) +
+                                   vector3d<int>({2, 2, 2}));
+        int zcol_length = fft_grid.size(2);
+
+        int ng{0};
+        int ng_max{0};
+        int ng_min{gv->num_gvec()};
+        int nzcol_max{0};
+        int nzcol_min{gv->num_zcol()};
+        double cost_max{0};
+        double cost_min{1e100};
+        for (int rank = 0; rank < comm.size(); rank++) {
+            ng += gv->gvec_count(rank);
+            ng_max = std::max(ng_max, gv->gvec_count(rank));
+            ng_min = std::min(ng_min, gv->gvec_count(rank));
+            nzcol_max = std::max(nzcol_max, gv->zcol_count(rank));
+            nzcol_min = std::min(nzcol_min, gv->zcol_count(rank));
+            double cost = gv->gvec_count(rank) + static_cast<double>(gv->zcol_count(rank)) * zcol_length;
+            cost_max = std::max(cost_max, cost);
+            cost_min = std::min(cost_min, cost);
+        }
+        /* the largest single z-column */
+        int zcol_size_max{0};
+        for (int i = 0; i < gv->num_zcol(); i++) {
+            zcol_size_max = std::max(zcol_size_max, static_cast<int>(gv->zcol(i).z.size()));
+        }
+
+        if (comm.rank() == 0) {
+            printf("num_gvec: %6i, num_zcol: %5i, zcol_length: %3i, ", gv->num_gvec(), gv->num_zcol(), zcol_length);
+            printf("gvec_count: [%5i, %5i], zcol_count: [%4i, %4i], cost: [%8.1f, %8.1f]\n", ng_min, ng_max,
+                   nzcol_min, nzcol_max, cost_min, cost_max);
+        }
+
+        if (ng != gv->num_gvec()) {
+            printf("test_gvec_distr: wrong total number of G-vectors\n");
+            exit(1);
+        }
+        /* greedy assignment of the sorted columns: the cost difference is bounded by the cost of a single column */
+        if (cost_max - cost_min > zcol_length + zcol_size_max) {
+            printf("test_gvec_distr: wrong balance of the FFT cost\n");
+            exit(1);
+        }
+        /* short columns are distributed last, so the number of G-vectors and columns is balanced as well */
+        if (ng_max - ng_min > zcol_size_max || nzcol_max - nzcol_min > 2) {
+            printf("test_gvec_distr: wrong spread of G-vectors or z-columns\n");
+            exit(1);
+        }
+    }
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(1);
+    matrix3d<double> M1 = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    matrix3d<double> M2 = {{1, 0.5, 0}, {0, 0.8, 0}, {0, 0, 2.5}};
+    for (auto M : {M1, M2}) {
+        for (double cutoff : {5.0, 8.0, 12.0}) {
+            test_gvec_distr(M, cutoff, 2 * cutoff);
+        }
+    }
+    if (mpi_comm_world().rank() == 0) {
+        printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+    }
+    sirius::finalize();
+
+    return 0;
+}
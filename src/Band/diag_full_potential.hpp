@@ -66,8 +66,10 @@ inline void Band::diag_fv_exact(K_point* kp, Hamiltonian& hamiltonian__) const
     std::vector<double> eval(ctx_.num_fv_states());
 
     sddk::timer t("sirius::Band::diag_fv_exact|genevp");
-    auto solver = ctx_.gen_evp_solver<double_complex>();
+    /* with the sequential solvers h and o are replicated over the ranks of the k-point communicator */
+    auto solver = ctx_.gen_evp_solver<double_complex>(kp->comm());
 
+    /* eigen-vectors of the previous iteration are the starting guess for the iterative partial-spectrum solver */
     if (solver->solve(kp->gklo_basis_size(), ctx_.num_fv_states(), h, o, eval.data(), kp->fv_eigen_vectors())) {
         TERMINATE("error in generalized eigen-value problem");
     }
@@ -390,7 +392,7 @@ inline void Band::get_singular_components(K_point* kp__, Hamiltonian& H__) const
     kp__->comm().barrier();
 }
 
-inline void Band::diag_fv_davidson(K_point* kp, Hamiltonian& H__) const
+inline int Band::diag_fv_davidson(K_point* kp, Hamiltonian& H__) const
 {
     PROFILE("sirius::Band::diag_fv_davidson");
 
@@ -398,14 +400,22 @@ inline void Band::diag_fv_davidson(K_point* kp, Hamiltonian& H__) const
 
     get_singular_components(kp, H__);
 
-    auto h_diag = H__.get_h_diag(kp, H__.local_op().v0(0), ctx_.step_function().theta_pw(0).real());
-    auto o_diag = H__.get_o_diag(kp, ctx_.step_function().theta_pw(0).real());
+    /* get diagonal elements for preconditioning */
+    mdarray<double, 2> h_diag;
+    mdarray<double, 1> o_diag;
+    H__.get_h_o_diag<true, true>(kp, H__.local_op().v0(0), ctx_.step_function().theta_pw(0).real(), h_diag, o_diag);
 
     /* short notation for number of target wave-functions */
     int num_bands = ctx_.num_fv_states();
 
     auto& itso = ctx_.iterative_solver_input();
 
+    auto ortho_method = get_ortho_method(itso.orthogonalization_);
+    /* TSQR factorizes the wave-functions in the Euclidean metric and not in the LAPW overlap metric */
+    if (ortho_method == ortho_method_t::tsqr) {
+        TERMINATE("TSQR orthogonalization is not available for the full-potential case");
+    }
+
     /* short notation for target wave-functions */
     auto& psi = kp->fv_eigen_vectors_slab();
 
@@ -492,9 +502,11 @@ inline void Band::diag_fv_davidson(K_point* kp, Hamiltonian& H__) const
     }
     #endif
 
-    std::vector<double> eval(num_bands);
-    for (int i = 0; i < num_bands; i++) {
-        eval[i] = kp->fv_eigen_value(i);
+    std::vector<double> eval(num_bands, 1e100);
+    if (itso.init_eval_old_) {
+        for (int i = 0; i < num_bands; i++) {
+            eval[i] = kp->fv_eigen_value(i);
+        }
     }
     std::vector<double> eval_old(num_bands);
 
@@ -526,12 +538,15 @@ inline void Band::diag_fv_davidson(K_point* kp, Hamiltonian& H__) const
 
     auto std_solver = ctx_.std_evp_solver<double_complex>();
 
+    int niter{0};
+
     /* start iterative diagonalization */
     for (int k = 0; k < itso.num_steps_; k++) {
+        niter++;
         /* apply Hamiltonian and overlap operators to the new basis functions */
         H__.apply_fv_h_o(kp, nlo, N, n, phi, hphi, ophi);
         
-        orthogonalize(ctx_.processing_unit(), 0, phi, hphi, ophi, N, n, ovlp, res);
+        orthogonalize(ctx_.processing_unit(), 0, phi, hphi, ophi, N, n, ovlp, res, ortho_method);
 
         /* setup eigen-value problem
          * N is the number of previous basis functions
@@ -604,22 +619,18 @@ inline void Band::diag_fv_davidson(K_point* kp, Hamiltonian& H__) const
 
     kp->set_fv_eigen_values(&eval[0]);
     kp->comm().barrier();
+
+    return niter;
 }
 
-inline void Band::diag_sv(K_point*     kp__,
-                          Hamiltonian& hamiltonian__) const
+inline void Band::set_sv_h(K_point*                              kp__,
+                           Hamiltonian&                          hamiltonian__,
+                           std::vector<dmatrix<double_complex>>& h__) const
 {
-    PROFILE("sirius::Band::diag_sv");
-
-    if (!ctx_.need_sv()) {
-        kp__->bypass_sv();
-        return;
-    }
+    PROFILE("sirius::Band::set_sv_h");
 
     hamiltonian__.local_op().prepare(kp__->gkvec_partition());
 
-    mdarray<double, 2> band_energies(ctx_.num_bands(), ctx_.num_spin_dims());
-
     /* product of the second-variational Hamiltonian and a first-variational wave-function */
     std::vector<Wave_functions> hpsi;
     for (int i = 0; i < ctx_.num_mag_comp(); i++) {
@@ -685,16 +696,16 @@ inline void Band::diag_sv(K_point*     kp__,
     //}
     //#endif
 
-    auto std_solver = ctx_.std_evp_solver<double_complex>();
+    h__.clear();
 
     if (ctx_.num_mag_dims() != 3) {
-        dmatrix<double_complex> h(nfv, nfv, ctx_.blacs_grid(), bs, bs);
-        if (kp__->num_ranks() == 1 && ctx_.processing_unit() == GPU) {
-            h.allocate(memory_t::device);
-        }
-        /* perform one or two consecutive diagonalizations */
+        /* one or two independent spin blocks */
         for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-
+            h__.push_back(std::move(dmatrix<double_complex>(nfv, nfv, ctx_.blacs_grid(), bs, bs)));
+            auto& h = h__.back();
+            if (kp__->num_ranks() == 1 && ctx_.processing_unit() == GPU) {
+                h.allocate(memory_t::device);
+            }
             /* compute <wf_i | h * wf_j> */
             inner(ctx_.processing_unit(), 0, kp__->fv_states(), 0, nfv, hpsi[ispn], 0, nfv, h, 0, 0);
             
@@ -705,12 +716,11 @@ inline void Band::diag_sv(K_point*     kp__,
             //auto z1 = h.checksum();
             //DUMP("checksum(h): %18.10f %18.10f", std::real(z1), std::imag(z1));
             //#endif
-            sddk::timer t1("sirius::Band::diag_sv|stdevp");
-            std_solver->solve(nfv, nfv, h, &band_energies(0, ispn), kp__->sv_eigen_vectors(ispn));
         }
     } else {
         int nb = ctx_.num_bands();
-        dmatrix<double_complex> h(nb, nb, ctx_.blacs_grid(), bs, bs);
+        h__.push_back(std::move(dmatrix<double_complex>(nb, nb, ctx_.blacs_grid(), bs, bs)));
+        auto& h = h__.back();
         if (kp__->num_ranks() == 1 && ctx_.processing_unit() == GPU) {
             h.allocate(memory_t::device);
         }
@@ -743,8 +753,6 @@ inline void Band::diag_sv(K_point*     kp__,
         //auto z1 = h.checksum();
         //DUMP("checksum(h): %18.10f %18.10f", std::real(z1), std::imag(z1));
         //#endif
-        sddk::timer t1("sirius::Band::diag_sv|stdevp");
-        std_solver->solve(nb, nb, h, &band_energies(0, 0), kp__->sv_eigen_vectors(0));
     }
 
 #ifdef __GPU
@@ -753,11 +761,117 @@ inline void Band::diag_sv(K_point*     kp__,
         for (int i = 0; i < ctx_.num_mag_comp(); i++) {
             hpsi[i].deallocate_on_device(0);
         }
+        for (auto& h: h__) {
+            h.deallocate(memory_t::device);
+        }
     }
 #endif
+}
+
+inline void Band::diag_sv(K_point*     kp__,
+                          Hamiltonian& hamiltonian__) const
+{
+    PROFILE("sirius::Band::diag_sv");
+
+    if (!ctx_.need_sv()) {
+        kp__->bypass_sv();
+        return;
+    }
+
+    std::vector<dmatrix<double_complex>> h;
+    set_sv_h(kp__, hamiltonian__, h);
+
+    mdarray<double, 2> band_energies(ctx_.num_bands(), ctx_.num_spin_dims());
+
+    auto std_solver = ctx_.std_evp_solver<double_complex>();
+
+    /* perform one or two consecutive diagonalizations */
+    for (int ispn = 0; ispn < static_cast<int>(h.size()); ispn++) {
+        int n = h[ispn].num_rows();
+        sddk::timer t1("sirius::Band::diag_sv|stdevp");
+        std_solver->solve(n, n, h[ispn], &band_energies(0, ispn), kp__->sv_eigen_vectors(ispn));
+    }
+
     for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) { 
         for (int j = 0; j < ctx_.num_bands(); j++) {
             kp__->band_energy(j, ispn) = band_energies(j, ispn);
         }
     }
 }
+
+inline void Band::diag_sv(K_point_set& kset__,
+                          Hamiltonian& hamiltonian__) const
+{
+    PROFILE("sirius::Band::diag_sv");
+
+    int nkloc = kset__.spl_num_kpoints().local_size();
+
+    /* small matrices can be diagonalized independently only if they are not distributed */
+    bool batch = ctx_.need_sv() && ctx_.blacs_grid().comm().size() == 1 &&
+                 ctx_.std_evp_solver_type() == ev_solver_t::lapack;
+
+    if (!batch) {
+        for (int ikloc = 0; ikloc < nkloc; ikloc++) {
+            diag_sv(kset__.acquire_local(ikloc), hamiltonian__);
+            kset__.release_local(ikloc);
+        }
+        return;
+    }
+
+    /* setup second-variational Hamiltonians of all local k-points */
+    std::vector<std::vector<dmatrix<double_complex>>> h(nkloc);
+    for (int ikloc = 0; ikloc < nkloc; ikloc++) {
+        set_sv_h(kset__.acquire_local(ikloc), hamiltonian__, h[ikloc]);
+        kset__.release_local(ikloc);
+    }
+
+    /* flat list of independent (k-point, spin block) problems */
+    std::vector<std::pair<int, int>> tasks;
+    for (int ikloc = 0; ikloc < nkloc; ikloc++) {
+        for (int ispn = 0; ispn < static_cast<int>(h[ikloc].size()); ispn++) {
+            tasks.push_back(std::make_pair(ikloc, ispn));
+        }
+    }
+
+    mdarray<double, 3> band_energies(ctx_.num_bands(), ctx_.num_spin_dims(), nkloc);
+
+    /* each thread calls a sequential LAPACK eigen-solver on its own matrix; sddk::timer is not thread-safe
+     * and can't be used inside the parallel region; the threaded BLAS must not spawn nested threads: nested
+     * OpenMP parallelism is off by default and MKL is explicitly limited to one thread in each OpenMP thread */
+    sddk::timer t1("sirius::Band::diag_sv|stdevp");
+    int num_failed{0};
+    #pragma omp parallel reduction(+:num_failed)
+    {
+        #ifdef __MKL
+        mkl_set_num_threads_local(1);
+        #endif
+        #pragma omp for schedule(dynamic, 1)
+        for (int it = 0; it < static_cast<int>(tasks.size()); it++) {
+            int ikloc = tasks[it].first;
+            int ispn  = tasks[it].second;
+            auto& A   = h[ikloc][ispn];
+            auto& Z   = kset__[kset__.spl_num_kpoints(ikloc)]->sv_eigen_vectors(ispn);
+
+            if (Eigensolver_lapack<double_complex>::heevd(A.num_rows(), A, &band_energies(0, ispn, ikloc), Z)) {
+                num_failed++;
+            }
+        }
+        #ifdef __MKL
+        /* back to the global setting */
+        mkl_set_num_threads_local(0);
+        #endif
+    }
+    t1.stop();
+    if (num_failed) {
+        TERMINATE("zheevd failed in the batched second-variational solver");
+    }
+
+    for (int ikloc = 0; ikloc < nkloc; ikloc++) {
+        auto kp = kset__[kset__.spl_num_kpoints(ikloc)];
+        for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) { 
+            for (int j = 0; j < ctx_.num_bands(); j++) {
+                kp->band_energy(j, ispn) = band_energies(j, ispn, ikloc);
+            }
+        }
+    }
+}
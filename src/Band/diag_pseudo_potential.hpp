@@ -155,6 +155,19 @@ inline int Band::diag_pseudo_potential_davidson(K_point*       kp__,
 
     auto& itso = ctx_.iterative_solver_input();
 
+    auto ortho_method = get_ortho_method(itso.orthogonalization_);
+    if (ortho_method == ortho_method_t::tsqr) {
+        /* TSQR factorizes the wave-functions in the Euclidean metric */
+        if (!std::is_same<T, double_complex>::value) {
+            TERMINATE("TSQR orthogonalization is not available for the Gamma-point case");
+        }
+        for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+            if (unit_cell_.atom_type(iat).augment()) {
+                TERMINATE("TSQR orthogonalization is not available for the generalized eigen-value problem");
+            }
+        }
+    }
+
     bool converge_by_energy = (itso.converge_by_energy_ == 1);
 
     if (ctx_.control().verbosity_ >= 2 && kp__->comm().rank() == 0) {
@@ -281,6 +294,17 @@ inline int Band::diag_pseudo_potential_davidson(K_point*       kp__,
     auto std_solver = ctx_.std_evp_solver<T>();
     auto gen_solver = ctx_.gen_evp_solver<T>();
 
+    /* far from the SCF convergence the subspace is expanded with single precision GEMMs;
+     * the update of the wave-functions is always done in double precision */
+    auto prec = linalg_precision_t::fp64;
+    if (std::is_same<T, double_complex>::value && ctx_.processing_unit() == CPU &&
+        itso.mixed_precision_tolerance_ > 0 && ctx_.iterative_solver_tolerance() > itso.mixed_precision_tolerance_) {
+        prec = linalg_precision_t::fp32;
+        if (ctx_.control().verbosity_ >= 2 && kp__->comm().rank() == 0) {
+            printf("subspace is expanded in single precision\n");
+        }
+    }
+
     int niter{0};
 
     sddk::timer t3("sirius::Band::diag_pseudo_potential_davidson|iter");
@@ -309,9 +333,7 @@ inline int Band::diag_pseudo_potential_davidson(K_point*       kp__,
         /* setup eigen-value problem
          * N is the number of previous basis functions
          * n is the number of new basis functions */
-        set_subspace_mtrx(0, num_bands, phi, hphi, hmlt, hmlt_old);
-        /* setup overlap matrix */
-        set_subspace_mtrx(0, num_bands, phi, sphi, ovlp, ovlp_old);
+        set_subspace_mtrx<T>(0, num_bands, phi, {&hphi, &sphi}, {&hmlt, &ovlp}, {&hmlt_old, &ovlp_old});
 
         if (ctx_.control().verification_ >= 1) {
             double max_diff = check_hermitian(hmlt, num_bands);
@@ -365,7 +387,7 @@ inline int Band::diag_pseudo_potential_davidson(K_point*       kp__,
             if (k != itso.num_steps_ - 1) {
                 /* get new preconditionined residuals, and also hpsi and opsi as a by-product */
                 n = residuals<T>(kp__, nc_mag ? 2 : ispin_step, N, num_bands, eval, eval_old, evec, hphi,
-                                 sphi, hpsi, spsi, res, h_diag, o_diag);
+                                 sphi, hpsi, spsi, res, h_diag, o_diag, prec);
             }
 
             /* check if we run out of variational space or eigen-vectors are converged or it's a last iteration */
@@ -431,14 +453,23 @@ inline int Band::diag_pseudo_potential_davidson(K_point*       kp__,
             /* apply Hamiltonian and S operators to the new basis functions */
             H__.apply_h_s<T>(kp__, nc_mag ? 2 : ispin_step, N, n, phi, hphi, sphi);
 
-            if (itso.orthogonalize_) {
-                orthogonalize<T>(ctx_.processing_unit(), nc_mag ? 2 : 0, phi, hphi, sphi, N, n, ovlp, res);
-            }
-
             /* setup eigen-value problem
              * N is the number of previous basis functions
              * n is the number of new basis functions */
-            set_subspace_mtrx(N, n, phi, hphi, hmlt, hmlt_old);
+            if (itso.orthogonalize_) {
+                /* try to orthogonalize and project in a single pass */
+                bool fused = itso.fused_expansion_ && ctx_.processing_unit() == CPU &&
+                             hmlt.blacs_grid().comm().size() == 1 &&
+                             expand_subspace<T>(nc_mag ? 2 : 0, N, n, phi, hphi, sphi, hmlt, hmlt_old, res);
+                if (!fused) {
+                    orthogonalize<T>(ctx_.processing_unit(), nc_mag ? 2 : 0, phi, hphi, sphi, N, n, ovlp, res,
+                                     ortho_method);
+                    set_subspace_mtrx(N, n, phi, hphi, hmlt, hmlt_old, prec);
+                }
+            } else {
+                /* setup Hamiltonian and overlap matrices */
+                set_subspace_mtrx<T>(N, n, phi, {&hphi, &sphi}, {&hmlt, &ovlp}, {&hmlt_old, &ovlp_old}, prec);
+            }
 
             if (ctx_.control().verification_ >= 1) {
                 double max_diff = check_hermitian(hmlt, N + n);
@@ -450,9 +481,6 @@ inline int Band::diag_pseudo_potential_davidson(K_point*       kp__,
             }
 
             if (!itso.orthogonalize_) {
-                /* setup overlap matrix */
-                set_subspace_mtrx(N, n, phi, sphi, ovlp, ovlp_old);
-
                 if (ctx_.control().verification_ >= 1) {
                     double max_diff = check_hermitian(ovlp, N + n);
                     if (max_diff > 1e-12) {
@@ -0,0 +1,123 @@
+template <typename T>
+inline bool Band::expand_subspace(int             ispn__,
+                                  int             N__,
+                                  int             n__,
+                                  Wave_functions& phi__,
+                                  Wave_functions& hphi__,
+                                  Wave_functions& sphi__,
+                                  dmatrix<T>&     hmlt__,
+                                  dmatrix<T>&     hmlt_old__,
+                                  Wave_functions& tmp__) const
+{
+    PROFILE("sirius::Band::expand_subspace");
+
+    assert(N__ > 0);
+    assert(hmlt__.blacs_grid().comm().size() == 1);
+
+    /* new size of the subspace */
+    int M = N__ + n__;
+
+    int bs = ctx_.cyclic_block_size();
+
+    /* single pass over the basis: <phi|S|phi_new> and <phi|H|phi_new> share the same reduction */
+    dmatrix<T> ms(M, n__, hmlt__.blacs_grid(), bs, bs);
+    dmatrix<T> mh(M, n__, hmlt__.blacs_grid(), bs, bs);
+    inner<T>(CPU, ispn__, {&phi__, &phi__}, 0, M, {&sphi__, &hphi__}, N__, n__, {&ms, &mh}, 0, 0, true);
+
+    /* projection coefficients C = <phi_old|S|phi_new> are stored in the first N rows of ms;
+     * overlap of the projected new functions is <phi_new|S|phi_new> - C^{+}C = R^{+}R */
+    matrix<T> r(n__, n__);
+    for (int j = 0; j < n__; j++) {
+        for (int i = 0; i < n__; i++) {
+            r(i, j) = ms(N__ + i, j);
+        }
+    }
+    linalg<CPU>::gemm(2, 0, n__, n__, N__, linalg_const<T>::m_one(), ms.template at<CPU>(), ms.ld(),
+                      ms.template at<CPU>(), ms.ld(), linalg_const<T>::one(), r.template at<CPU>(), r.ld());
+
+    /* new functions are almost linear dependent; let the caller orthogonalize them in the usual way */
+    if (linalg<CPU>::potrf(n__, r.template at<CPU>(), r.ld())) {
+        return false;
+    }
+    if (linalg<CPU>::trtri(n__, r.template at<CPU>(), r.ld())) {
+        return false;
+    }
+    /* r is upper triangular R^{-1} */
+    for (int j = 0; j < n__; j++) {
+        for (int i = j + 1; i < n__; i++) {
+            r(i, j) = 0;
+        }
+    }
+
+    /* Z = <phi_old|H|phi_new>^{+} C */
+    matrix<T> z(n__, n__);
+    linalg<CPU>::gemm(2, 0, n__, n__, N__, mh.template at<CPU>(), mh.ld(), ms.template at<CPU>(), ms.ld(),
+                      z.template at<CPU>(), z.ld());
+
+    /* B = <phi_old|H|phi_new> - H_old C = <phi_old|H|phi_new - phi_old C> */
+    linalg<CPU>::gemm(0, 0, N__, n__, N__, linalg_const<T>::m_one(), hmlt_old__.template at<CPU>(), hmlt_old__.ld(),
+                      ms.template at<CPU>(), ms.ld(), linalg_const<T>::one(), mh.template at<CPU>(), mh.ld());
+
+    /* <phi_new - phi_old C|H|phi_new - phi_old C> = <phi_new|H|phi_new> - Z - C^{+}B */
+    matrix<T> hyy(n__, n__);
+    for (int j = 0; j < n__; j++) {
+        for (int i = 0; i < n__; i++) {
+            hyy(i, j) = mh(N__ + i, j) - z(i, j);
+        }
+    }
+    linalg<CPU>::gemm(2, 0, n__, n__, N__, linalg_const<T>::m_one(), ms.template at<CPU>(), ms.ld(),
+                      mh.template at<CPU>(), mh.ld(), linalg_const<T>::one(), hyy.template at<CPU>(), hyy.ld());
+
+    /* old N x N block of the Hamiltonian */
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < N__; i++) {
+        std::copy(&hmlt_old__(0, i), &hmlt_old__(0, i) + N__, &hmlt__(0, i));
+    }
+    /* <phi_old|H|phi_new'> = B R^{-1} */
+    linalg<CPU>::gemm(0, 0, N__, n__, n__, mh.template at<CPU>(), mh.ld(), r.template at<CPU>(), r.ld(),
+                      hmlt__.template at<CPU>(0, N__), hmlt__.ld());
+    /* <phi_new'|H|phi_new'> = R^{-H} <phi_new - phi_old C|H|phi_new - phi_old C> R^{-1} */
+    linalg<CPU>::gemm(0, 0, n__, n__, n__, hyy.template at<CPU>(), hyy.ld(), r.template at<CPU>(), r.ld(),
+                      z.template at<CPU>(), z.ld());
+    linalg<CPU>::gemm(2, 0, n__, n__, n__, r.template at<CPU>(), r.ld(), z.template at<CPU>(), z.ld(),
+                      hmlt__.template at<CPU>(N__, N__), hmlt__.ld());
+    /* restore lower part */
+    #pragma omp parallel for
+    for (int i = 0; i < N__; i++) {
+        for (int j = N__; j < M; j++) {
+            hmlt__(j, i) = type_wrapper<T>::bypass(std::conj(hmlt__(i, j)));
+        }
+    }
+    /* kill any numerical noise */
+    hmlt__.make_real_diag(M);
+
+    /* save new matrix */
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < M; i++) {
+        std::copy(&hmlt__(0, i), &hmlt__(0, i) + M, &hmlt_old__(0, i));
+    }
+
+    /* phi_new' = (phi_new - phi_old C) R^{-1} is computed in one transformation with the matrix {-C R^{-1}, R^{-1}} */
+    dmatrix<T> q(M, n__, hmlt__.blacs_grid(), bs, bs);
+    linalg<CPU>::gemm(0, 0, N__, n__, n__, linalg_const<T>::m_one(), ms.template at<CPU>(), ms.ld(),
+                      r.template at<CPU>(), r.ld(), linalg_const<T>::zero(), q.template at<CPU>(), q.ld());
+    for (int j = 0; j < n__; j++) {
+        for (int i = 0; i < n__; i++) {
+            q(N__ + i, j) = r(i, j);
+        }
+    }
+
+    int s0{0};
+    int s1{1};
+    if (ispn__ != 2) {
+        s0 = s1 = ispn__;
+    }
+    for (auto e: {&phi__, &hphi__, &sphi__}) {
+        transform<T>(CPU, ispn__, *e, 0, M, q, 0, 0, tmp__, 0, n__);
+        for (int s = s0; s <= s1; s++) {
+            e->copy_from(CPU, n__, tmp__, s, 0, s, N__);
+        }
+    }
+
+    return true;
+}
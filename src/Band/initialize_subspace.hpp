@@ -30,13 +30,13 @@ inline void Band::initialize_subspace(K_point_set& kset__, Hamiltonian& H__) con
     }
 
     for (int ikloc = 0; ikloc < kset__.spl_num_kpoints().local_size(); ikloc++) {
-        int ik  = kset__.spl_num_kpoints(ikloc);
-        auto kp = kset__[ik];
+        auto kp = kset__.acquire_local(ikloc);
         if (ctx_.gamma_point() && (ctx_.so_correction() == false)) {
             initialize_subspace<double>(kp, H__, N);
         } else {
             initialize_subspace<double_complex>(kp, H__, N);
         }
+        kset__.release_local(ikloc);
     }
     H__.dismiss();
     H__.local_op().dismiss();
@@ -261,7 +261,8 @@ inline int Band::residuals(K_point*             kp__,
                            Wave_functions&      opsi__,
                            Wave_functions&      res__,
                            mdarray<double, 2>&  h_diag__,
-                           mdarray<double, 1>&  o_diag__) const
+                           mdarray<double, 1>&  o_diag__,
+                           linalg_precision_t   prec__) const
 {
     PROFILE("sirius::Band::residuals");
 
@@ -321,7 +322,8 @@ inline int Band::residuals(K_point*             kp__,
                 evec_tmp.allocate(memory_t::device);
             }
             /* compute H\Psi_{i} = \sum_{mu} H\phi_{mu} * Z_{mu, i} and O\Psi_{i} = \sum_{mu} O\phi_{mu} * Z_{mu, i} */
-            transform<T>(ctx_.processing_unit(), ispn__, {&hphi__, &ophi__}, 0, N__, evec_tmp, 0, 0, {&hpsi__, &opsi__}, 0, n);
+            transform<T>(ctx_.processing_unit(), ispn__, {&hphi__, &ophi__}, 0, N__, evec_tmp, 0, 0, {&hpsi__, &opsi__}, 0, n,
+                         prec__);
 
             auto res_norm = residuals_aux(kp__, ispn__, n, eval_tmp, hpsi__, opsi__, res__, h_diag__, o_diag__);
 
@@ -349,7 +351,8 @@ inline int Band::residuals(K_point*             kp__,
         }
     } else {
         /* compute H\Psi_{i} = \sum_{mu} H\phi_{mu} * Z_{mu, i} and O\Psi_{i} = \sum_{mu} O\phi_{mu} * Z_{mu, i} */
-        transform<T>(ctx_.processing_unit(), ispn__, {&hphi__, &ophi__}, 0, N__, evec__, 0, 0, {&hpsi__, &opsi__}, 0, num_bands__);
+        transform<T>(ctx_.processing_unit(), ispn__, {&hphi__, &ophi__}, 0, N__, evec__, 0, 0, {&hpsi__, &opsi__}, 0, num_bands__,
+                     prec__);
 
         auto res_norm = residuals_aux(kp__, ispn__, num_bands__, eval__, hpsi__, opsi__, res__, h_diag__, o_diag__);
 
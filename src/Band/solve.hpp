@@ -22,21 +22,39 @@
  *   \brief Contains interfaces to the sirius::Band solvers.
  */
 
-inline void Band::solve_with_second_variation(K_point& kp__, Hamiltonian& hamiltonian__) const
+inline int Band::solve_with_second_variation(K_point_set& kset__, Hamiltonian& hamiltonian__) const
 {
-    /* solve non-magnetic Hamiltonian (so-called first variation) */
+    int num_iter{0};
     auto& itso = ctx_.iterative_solver_input();
-    if (itso.type_ == "exact") {
-        diag_fv_exact(&kp__, hamiltonian__);
-    } else if (itso.type_ == "davidson") {
-        diag_fv_davidson(&kp__, hamiltonian__);
+    for (int ikloc = 0; ikloc < kset__.spl_num_kpoints().local_size(); ikloc++) {
+        int ik  = kset__.spl_num_kpoints(ikloc);
+        auto kp = kset__.acquire_local(ikloc);
+
+        int niter{0};
+        /* solve non-magnetic Hamiltonian (so-called first variation) */
+        if (itso.type_ == "exact") {
+            diag_fv_exact(kp, hamiltonian__);
+        } else if (itso.type_ == "davidson") {
+            niter = diag_fv_davidson(kp, hamiltonian__);
+        } else {
+            TERMINATE("unknown iterative solver type");
+        }
+        /* generate first-variational states */
+        kp->generate_fv_states();
+        kset__.release_local(ikloc);
+
+        kset__.num_solver_iter(ik) = niter;
+        num_iter += niter;
     }
-    /* generate first-variational states */
-    kp__.generate_fv_states();
-    /* solve magnetic Hamiltonian */
-    diag_sv(&kp__, hamiltonian__);
+    /* solve magnetic Hamiltonian for all local k-points at once */
+    diag_sv(kset__, hamiltonian__);
     /* generate spinor wave-functions */
-    kp__.generate_spinor_wave_functions();
+    for (int ikloc = 0; ikloc < kset__.spl_num_kpoints().local_size(); ikloc++) {
+        kset__.acquire_local(ikloc)->generate_spinor_wave_functions();
+        kset__.release_local(ikloc);
+    }
+
+    return num_iter;
 }
 
 inline int Band::solve_with_single_variation(K_point& kp__, Hamiltonian& hamiltonian__) const
@@ -137,20 +155,28 @@ inline void Band::solve_for_kset(K_point_set& kset__, Hamiltonian& Hamiltonian__
         MEMORY_USAGE_INFO();
     }
 
+    /* move k-points between k-groups according to the number of iterations in the previous band solution */
+    if (ctx_.control().kpoint_distribution_ == "dynamic") {
+        kset__.rebalance();
+    }
+
     int num_dav_iter{0};
     /* solve secular equation and generate wave functions */
-    for (int ikloc = 0; ikloc < kset__.spl_num_kpoints().local_size(); ikloc++) {
-        int ik  = kset__.spl_num_kpoints(ikloc);
-        auto kp = kset__[ik];
-
-        if (ctx_.full_potential() && use_second_variation) {
-            solve_with_second_variation(*kp, Hamiltonian__);
-        } else {
-            num_dav_iter += solve_with_single_variation(*kp, Hamiltonian__);
+    if (ctx_.full_potential() && use_second_variation) {
+        num_dav_iter = solve_with_second_variation(kset__, Hamiltonian__);
+    } else {
+        for (int ikloc = 0; ikloc < kset__.spl_num_kpoints().local_size(); ikloc++) {
+            int ik  = kset__.spl_num_kpoints(ikloc);
+            auto kp = kset__.acquire_local(ikloc);
+
+            int niter = solve_with_single_variation(*kp, Hamiltonian__);
+            kset__.release_local(ikloc);
+            kset__.num_solver_iter(ik) = niter;
+            num_dav_iter += niter;
         }
     }
     kset__.comm().allreduce(&num_dav_iter, 1);
-    if (ctx_.comm().rank() == 0 && !ctx_.full_potential()) {
+    if (ctx_.comm().rank() == 0 && ctx_.iterative_solver_input().type_ != "exact") {
         printf("Average number of iterations: %12.6f\n", static_cast<double>(num_dav_iter) / kset__.num_kpoints());
     }
 
@@ -217,6 +217,13 @@ class Beta_projectors_base
         beta_phi_shared(0, memory_t::none) = mdarray<double, 1>();
     }
 
+    /// Update atomic positions stored in the chunk descriptors after the atoms were moved.
+    /** Plane-wave coefficients of the atom type projectors don't depend on positions and are kept. */
+    void update()
+    {
+        split_in_chunks();
+    }
+
     inline int num_gkvec_loc() const
     {
         return static_cast<int>(igk_.size());
@@ -19,8 +19,63 @@ inline void Density::add_k_point_contribution_rg(K_point* kp__)
 
     fft.prepare(kp__->gkvec_partition());
 
-    /* non-magnetic or collinear case */
-    if (ctx_.num_mag_dims() != 3) {
+    /* non-magnetic or collinear case on CPU: bands are transformed in batches and the batch is added to the
+     * density in a single sweep over the grid; at Gamma point two real bands are packed in one complex FFT */
+    if (ctx_.num_mag_dims() != 3 && fft.pu() == CPU) {
+        /* number of real-space functions in a batch */
+        int const batch_size{8};
+
+        bool is_gamma = kp__->gkvec().reduced();
+
+        mdarray<double_complex, 2> psi_r(fft.local_size(), batch_size);
+        /* weights of the real and imaginary parts of each function in the batch */
+        mdarray<double, 2> w_ri(2, batch_size);
+
+        for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+            auto& pw = kp__->spinor_wave_functions().pw_coeffs(ispn);
+            int nloc = pw.spl_num_col().local_size();
+            /* trivial case */
+            if (!pw.spl_num_col().global_index_size()) {
+                continue;
+            }
+            /* number of bands per FFT */
+            int nbands_per_fft = is_gamma ? 2 : 1;
+
+            int i = 0;
+            while (i < nloc) {
+                /* fill the batch */
+                int nb{0};
+                for (; nb < batch_size && i < nloc; nb++) {
+                    int j1 = pw.spl_num_col()[i];
+                    double w1 = kp__->band_occupancy(j1, ispn) * kp__->weight() / omega;
+                    if (nbands_per_fft == 2 && i + 1 < nloc) {
+                        int j2 = pw.spl_num_col()[i + 1];
+                        double w2 = kp__->band_occupancy(j2, ispn) * kp__->weight() / omega;
+                        /* psi_1(r) + i psi_2(r) */
+                        fft.transform<1>(pw.extra().template at<CPU>(0, i), pw.extra().template at<CPU>(0, i + 1));
+                        w_ri(0, nb) = w1;
+                        w_ri(1, nb) = w2;
+                        i += 2;
+                    } else {
+                        fft.transform<1>(pw.extra().template at<CPU>(0, i));
+                        w_ri(0, nb) = w_ri(1, nb) = w1;
+                        i++;
+                    }
+                    fft.output(psi_r.at<CPU>(0, nb));
+                }
+                /* add to density */
+                #pragma omp parallel for schedule(static)
+                for (int ir = 0; ir < fft.local_size(); ir++) {
+                    double d{0};
+                    for (int ib = 0; ib < nb; ib++) {
+                        auto z = psi_r(ir, ib);
+                        d += w_ri(0, ib) * std::pow(z.real(), 2) + w_ri(1, ib) * std::pow(z.imag(), 2);
+                    }
+                    density_rg(ir, ispn) += d;
+                }
+            }
+        }
+    } else if (ctx_.num_mag_dims() != 3) { /* non-magnetic or collinear case on GPU */
         /* loop over pure spinor components */
         for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
             /* trivial case */
@@ -29,43 +84,17 @@ inline void Density::add_k_point_contribution_rg(K_point* kp__)
             }
 
             for (int i = 0; i < kp__->spinor_wave_functions().pw_coeffs(ispn).spl_num_col().local_size(); i++) {
-                int j = kp__->spinor_wave_functions().pw_coeffs(ispn).spl_num_col()[i];
-                double w = kp__->band_occupancy(j, ispn) * kp__->weight() / omega;
-
-                ///* transform to real space; in case of GPU wave-function stays in GPU memory */
+                /* transform to real space; wave-function stays in GPU memory */
                 fft.transform<1>(kp__->spinor_wave_functions().pw_coeffs(ispn).extra().template at<CPU>(0, i));
-                //switch (fft.pu()) {
-                //    case CPU: {
-                //        fft.transform<1>(kp__->gkvec().partition(),
-                //                         kp__->spinor_wave_functions(ispn).pw_coeffs().extra().template at<CPU>(0, i));
-                //        break;
-                //    }
-                //    case GPU: {
-                //        fft.transform<1, GPU>(kp__->gkvec().partition(),
-                //                              kp__->spinor_wave_functions(ispn).pw_coeffs().extra().template at<GPU>(0, i));
-                //        break;
-                //    }
-                //}
-                
+
                 /* add to density */
-                switch (fft.pu()) {
-                    case CPU: {
-                        #pragma omp parallel for schedule(static)
-                        for (int ir = 0; ir < fft.local_size(); ir++) {
-                            auto z = fft.buffer(ir);
-                            density_rg(ir, ispn) += w * (std::pow(z.real(), 2) + std::pow(z.imag(), 2));
-                        }
-                        break;
-                    }
-                    case GPU: {
-                        #ifdef __GPU
-                        update_density_rg_1_gpu(fft.local_size(), fft.buffer().at<GPU>(), w, density_rg.at<GPU>(0, ispn));
-                        #else
-                        TERMINATE_NO_GPU
-                        #endif
-                        break;
-                    }
-                }
+                #ifdef __GPU
+                int j = kp__->spinor_wave_functions().pw_coeffs(ispn).spl_num_col()[i];
+                double w = kp__->band_occupancy(j, ispn) * kp__->weight() / omega;
+                update_density_rg_1_gpu(fft.local_size(), fft.buffer().at<GPU>(), w, density_rg.at<GPU>(0, ispn));
+                #else
+                TERMINATE_NO_GPU
+                #endif
             }
         }
     } else { /* non-collinear case */
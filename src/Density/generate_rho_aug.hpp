@@ -29,57 +29,77 @@ inline void Density::generate_rho_aug(mdarray<double_complex, 2>& rho_aug__)
         auto dm = density_matrix_aux(iat);
         
         if (pu == CPU) {
-            sddk::timer t2("sirius::Density::generate_rho_aug|phase_fac");
+            int na = atom_type.num_atoms();
+            int nq = nbf * (nbf + 1) / 2;
+            /* G-vectors are processed in blocks to bound the size of the temporary arrays */
+            int gbs = std::max(1, std::min(ctx_.gvec().count(), ctx_.settings().gvec_block_size_));
+
+            mdarray<double_complex, 2> pf(gbs, na);
             /* treat phase factors as real array with x2 size */
-            mdarray<double, 2> phase_factors(atom_type.num_atoms(), ctx_.gvec().count() * 2);
-
-            #pragma omp parallel for schedule(static)
-            for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
-                int ig = ctx_.gvec().offset() + igloc;
-                for (int i = 0; i < atom_type.num_atoms(); i++) {
-                    int ia = atom_type.atom_id(i);
-                    double_complex z = std::conj(ctx_.gvec_phase_factor(ig, ia));
-                    phase_factors(i, 2 * igloc)     = z.real();
-                    phase_factors(i, 2 * igloc + 1) = z.imag();
-                }
-            }
-            t2.stop();
-            
+            mdarray<double, 2> phase_factors(na, gbs * 2);
             /* treat auxiliary array as double with x2 size */
-            mdarray<double, 2> dm_pw(nbf * (nbf + 1) / 2, ctx_.gvec().count() * 2);
-
-            for (int iv = 0; iv < ctx_.num_mag_dims() + 1; iv++) {
-                sddk::timer t3("sirius::Density::generate_rho_aug|gemm");
-                linalg<CPU>::gemm(0, 0, nbf * (nbf + 1) / 2, 2 * ctx_.gvec().count(), atom_type.num_atoms(), 
-                                  &dm(0, 0, iv), dm.ld(),
-                                  &phase_factors(0, 0), phase_factors.ld(), 
-                                  &dm_pw(0, 0), dm_pw.ld());
-                t3.stop();
-
-                #ifdef __PRINT_OBJECT_CHECKSUM
-                {
-                    auto cs = dm_pw.checksum();
-                    ctx_.comm().allreduce(&cs, 1);
-                    DUMP("checksum(dm_pw) : %18.10f", cs);
+            mdarray<double, 2> dm_pw(nq, gbs * 2);
+
+            #ifdef __PRINT_OBJECT_CHECKSUM
+            /* checksums of dm_pw are accumulated over the G-blocks */
+            std::vector<double> cs_dm_pw(ctx_.num_mag_dims() + 1, 0);
+            #endif
+
+            for (int igloc0 = 0; igloc0 < ctx_.gvec().count(); igloc0 += gbs) {
+                int ngv = std::min(gbs, ctx_.gvec().count() - igloc0);
+
+                /* phase factors of the G-block are shared by all magnetic components */
+                sddk::timer t2("sirius::Density::generate_rho_aug|phase_fac");
+                ctx_.generate_phase_factors(iat, igloc0, ngv, pf.at<CPU>(), pf.ld());
+                #pragma omp parallel for schedule(static)
+                for (int j = 0; j < ngv; j++) {
+                    for (int i = 0; i < na; i++) {
+                        double_complex z = std::conj(pf(j, i));
+                        phase_factors(i, 2 * j)     = z.real();
+                        phase_factors(i, 2 * j + 1) = z.imag();
+                    }
                 }
-                #endif
-
-                sddk::timer t4("sirius::Density::generate_rho_aug|sum");
-                #pragma omp parallel for
-                for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
-                    double_complex zsum(0, 0);
-                    /* get contribution from non-diagonal terms */
-                    for (int i = 0; i < nbf * (nbf + 1) / 2; i++) {
-                        double_complex z1 = double_complex(ctx_.augmentation_op(iat).q_pw(i, 2 * igloc),
-                                                           ctx_.augmentation_op(iat).q_pw(i, 2 * igloc + 1));
-                        double_complex z2(dm_pw(i, 2 * igloc), dm_pw(i, 2 * igloc + 1));
-
-                        zsum += z1 * z2 * ctx_.augmentation_op(iat).sym_weight(i);
+                t2.stop();
+
+                for (int iv = 0; iv < ctx_.num_mag_dims() + 1; iv++) {
+                    sddk::timer t3("sirius::Density::generate_rho_aug|gemm");
+                    linalg<CPU>::gemm(0, 0, nq, 2 * ngv, na,
+                                      &dm(0, 0, iv), dm.ld(),
+                                      &phase_factors(0, 0), phase_factors.ld(),
+                                      &dm_pw(0, 0), dm_pw.ld());
+                    t3.stop();
+
+                    #ifdef __PRINT_OBJECT_CHECKSUM
+                    cs_dm_pw[iv] += dm_pw.checksum(0, static_cast<size_t>(nq) * 2 * ngv);
+                    #endif
+
+                    /* contract with Q(G) while the block of dm_pw is still in cache */
+                    sddk::timer t4("sirius::Density::generate_rho_aug|sum");
+                    #pragma omp parallel for
+                    for (int j = 0; j < ngv; j++) {
+                        int igloc = igloc0 + j;
+                        double_complex zsum(0, 0);
+                        /* get contribution from non-diagonal terms */
+                        for (int i = 0; i < nq; i++) {
+                            double_complex z1 = double_complex(ctx_.augmentation_op(iat).q_pw(i, 2 * igloc),
+                                                               ctx_.augmentation_op(iat).q_pw(i, 2 * igloc + 1));
+                            double_complex z2(dm_pw(i, 2 * j), dm_pw(i, 2 * j + 1));
+
+                            zsum += z1 * z2 * ctx_.augmentation_op(iat).sym_weight(i);
+                        }
+                        rho_aug__(igloc, iv) += zsum;
                     }
-                    rho_aug__(igloc, iv) += zsum;
+                    t4.stop();
                 }
-                t4.stop();
             }
+
+            #ifdef __PRINT_OBJECT_CHECKSUM
+            for (int iv = 0; iv < ctx_.num_mag_dims() + 1; iv++) {
+                auto cs = cs_dm_pw[iv];
+                ctx_.comm().allreduce(&cs, 1);
+                DUMP("checksum(dm_pw) : %18.10f", cs);
+            }
+            #endif
         }
 
         #ifdef __GPU
@@ -39,8 +39,7 @@ inline void Density::generate_valence(K_point_set& ks__)
     
     /* start the main loop over k-points */
     for (int ikloc = 0; ikloc < ks__.spl_num_kpoints().local_size(); ikloc++) {
-        int ik = ks__.spl_num_kpoints(ikloc);
-        auto kp = ks__[ik];
+        auto kp = ks__.acquire_local(ikloc);
 
         for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
             int nbnd = kp->num_occupied_bands(ispn);
@@ -80,6 +79,7 @@ inline void Density::generate_valence(K_point_set& ks__)
             }
         }
         #endif
+        ks__.release_local(ikloc);
     }
 
     if (density_matrix_.size()) {
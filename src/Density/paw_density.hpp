@@ -181,7 +181,8 @@ inline void Density::generate_paw_loc_density()
         return;
     }
 
-    #pragma omp parallel for
+    /* local atoms can be of different types and cost */
+    #pragma omp parallel for schedule(dynamic, 1)
     for (int i = 0; i < unit_cell_.spl_num_paw_atoms().local_size(); i++) {
         generate_paw_atom_density(paw_density_data_[i]);
     }
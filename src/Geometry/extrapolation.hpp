@@ -0,0 +1,349 @@
+// Copyright (c) 2013-2018 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file extrapolation.hpp
+ *
+ *  \brief Contains defintion and implementation of sirius::Extrapolation class.
+ */
+
+#ifndef __EXTRAPOLATION_HPP__
+#define __EXTRAPOLATION_HPP__
+
+#include "../simulation_context.h"
+#include "../density.h"
+#include "../k_point_set.h"
+#include <deque>
+
+namespace sirius {
+
+/// Extrapolation of the density and wave-functions between ionic steps.
+/** The density is split into a superposition of atomic densities and a difference part
+ *  \f[
+ *    \rho({\bf r}, t) = \sum_{\alpha} \rho_{\alpha}^{at}({\bf r} - {\bf r}_{\alpha}(t)) + \Delta \rho({\bf r}, t)
+ *  \f]
+ *  The atomic part is recomputed exactly for the new positions and the difference part is extrapolated:
+ *  \f[
+ *    \Delta \rho(t + dt) = \Delta \rho(t) + \alpha \Big(\Delta \rho(t) - \Delta \rho(t - dt)\Big) +
+ *      \beta \Big(\Delta \rho(t - dt) - \Delta \rho(t - 2dt)\Big)
+ *  \f]
+ *  Coefficients \f$ \alpha \f$ and \f$ \beta \f$ are the least-square fit of the same expression for the atomic
+ *  positions. Order 0 keeps the difference part (\f$ \alpha = \beta = 0 \f$), order 1 is a linear extrapolation
+ *  (\f$ \alpha = 1, \beta = 0 \f$) and order 2 uses the fitted coefficients.
+ *
+ *  Wave-functions of the previous steps are aligned to the current subspace by the projections
+ *  \f$ \tilde \psi(t - n dt) = \psi(t - n dt) O_n \f$, where \f$ O_n = \langle \psi(t - n dt) | \psi(t) \rangle \f$,
+ *  and extrapolated with the same coefficients:
+ *  \f[
+ *    \psi(t) + \alpha \Big(\psi(t) - \tilde \psi(t - dt)\Big) + \beta \Big(\tilde \psi(t - dt) - \tilde \psi(t - 2dt)\Big)
+ *  \f]
+ *  The iterative solver restores the orthonormality. Wave-functions of the k-points which were moved to another
+ *  k-group by K_point_set::rebalance() are dropped from the history.
+ *
+ *  Only the pseudopotential case is extrapolated; in the full-potential case the initial density is regenerated.
+ *
+ *  Usage:
+ *  \code{.cpp}
+ *  dft.find(...);
+ *  extrapolation.save();
+ *  // move atoms
+ *  ctx.update_atomic_positions();
+ *  dft.update();
+ *  extrapolation.extrapolate();
+ *  potential.generate(density);
+ *  dft.find(...);
+ *  \endcode
+ */
+class Extrapolation
+{
+  private:
+    Simulation_context& ctx_;
+
+    Density& density_;
+
+    K_point_set& kset_;
+
+    /// Order of extrapolation.
+    int order_;
+
+    /// Radial integrals of the atomic densities.
+    std::unique_ptr<Radial_integrals_rho_pseudo> ri_;
+
+    /// Atomic positions of the last ionic steps, starting from the most recent one.
+    std::deque<std::vector<vector3d<double>>> positions_;
+
+    /// Difference between the converged density and the superposition of atomic densities for the last ionic steps.
+    std::deque<mdarray<double_complex, 2>> drho_;
+
+    /// Wave-functions of the last two ionic steps for the local k-points, starting from the most recent one.
+    std::vector<std::deque<std::unique_ptr<Wave_functions>>> psi_prev_;
+
+    /// K-point objects for which the wave-functions were saved.
+    std::vector<K_point const*> psi_prev_kp_;
+
+    /// Plane-wave coefficients of the superposition of atomic densities at the current positions.
+    std::vector<double_complex> atomic_density() const
+    {
+        auto& ri = *ri_;
+        return ctx_.make_periodic_function<index_domain_t::local>([&ri](int iat, double g)
+                                                                  {
+                                                                      return ri.value<int>(iat, g);
+                                                                  });
+    }
+
+    /// Cartesian displacement between two sets of positions using the nearest periodic image.
+    std::vector<vector3d<double>> displacement(std::vector<vector3d<double>> const& p1__,
+                                               std::vector<vector3d<double>> const& p2__) const
+    {
+        std::vector<vector3d<double>> d(p1__.size());
+        for (size_t ia = 0; ia < p1__.size(); ia++) {
+            auto v = p1__[ia] - p2__[ia];
+            for (int x: {0, 1, 2}) {
+                v[x] -= std::floor(v[x] + 0.5);
+            }
+            d[ia] = ctx_.unit_cell().get_cartesian_coordinates(v);
+        }
+        return std::move(d);
+    }
+
+    /// Find the extrapolation coefficients from the history of atomic positions.
+    std::pair<double, double> find_alpha_beta() const
+    {
+        int nh = static_cast<int>(positions_.size());
+
+        if (order_ == 0 || nh < 2) {
+            return std::make_pair(0.0, 0.0);
+        }
+        if (order_ == 1 || nh < 3) {
+            return std::make_pair(1.0, 0.0);
+        }
+
+        std::vector<vector3d<double>> pos(ctx_.unit_cell().num_atoms());
+        for (int ia = 0; ia < ctx_.unit_cell().num_atoms(); ia++) {
+            pos[ia] = ctx_.unit_cell().atom(ia).position();
+        }
+        auto c = displacement(pos, positions_[0]);
+        auto a = displacement(positions_[0], positions_[1]);
+        auto b = displacement(positions_[1], positions_[2]);
+
+        double aa{0}, ab{0}, bb{0}, ac{0}, bc{0};
+        for (size_t ia = 0; ia < c.size(); ia++) {
+            aa += dot(a[ia], a[ia]);
+            ab += dot(a[ia], b[ia]);
+            bb += dot(b[ia], b[ia]);
+            ac += dot(a[ia], c[ia]);
+            bc += dot(b[ia], c[ia]);
+        }
+
+        double det = aa * bb - ab * ab;
+        if (std::abs(det) > 1e-12 * std::max(aa * bb, 1e-24)) {
+            return std::make_pair((ac * bb - bc * ab) / det, (aa * bc - ab * ac) / det);
+        }
+        if (aa > 1e-24) {
+            return std::make_pair(ac / aa, 0.0);
+        }
+        return std::make_pair(0.0, 0.0);
+    }
+
+    /// Extrapolate wave-functions of a single k-point.
+    template <typename T>
+    void extrapolate_wave_functions(K_point&                                           kp__,
+                                    std::deque<std::unique_ptr<Wave_functions>> const& psi_prev__,
+                                    double                                             alpha__,
+                                    double                                             beta__) const
+    {
+        int nb = ctx_.num_bands();
+
+        int ispn0{0};
+        int ispn1{ctx_.num_spins() - 1};
+        if (ctx_.num_mag_dims() == 3) {
+            ispn0 = ispn1 = 2;
+        }
+
+        /* second-order term needs psi(t-2dt) */
+        if (psi_prev__.size() < 2) {
+            beta__ = 0;
+        }
+
+        auto& psi = kp__.spinor_wave_functions();
+
+        dmatrix<T> o1(nb, nb);
+        dmatrix<T> o2(nb, nb);
+        for (int ispn = ispn0; ispn <= ispn1; ispn++) {
+            /* O_1 = <psi(t-dt)|psi(t)> */
+            inner<T>(CPU, ispn, *psi_prev__[0], 0, nb, psi, 0, nb, o1, 0, 0);
+            if (beta__ != 0) {
+                /* O_2 = <psi(t-2dt)|psi(t)> */
+                inner<T>(CPU, ispn, *psi_prev__[1], 0, nb, psi, 0, nb, o2, 0, 0);
+            }
+
+            int s0 = (ispn == 2) ? 0 : ispn;
+            int s1 = (ispn == 2) ? 1 : ispn;
+            for (int s = s0; s <= s1; s++) {
+                auto& pw = psi.pw_coeffs(s).prime();
+                #pragma omp parallel for schedule(static)
+                for (int i = 0; i < nb; i++) {
+                    for (int igloc = 0; igloc < psi.pw_coeffs(s).num_rows_loc(); igloc++) {
+                        pw(igloc, i) *= (1 + alpha__);
+                    }
+                }
+            }
+            /* (1 + alpha) psi(t) - (alpha - beta) psi(t-dt) O_1 - beta psi(t-2dt) O_2 */
+            transform<T>(CPU, ispn, beta__ - alpha__, *psi_prev__[0], 0, nb, o1, 0, 0, 1.0, psi, 0, nb);
+            if (beta__ != 0) {
+                transform<T>(CPU, ispn, -beta__, *psi_prev__[1], 0, nb, o2, 0, 0, 1.0, psi, 0, nb);
+            }
+        }
+    }
+
+  public:
+    Extrapolation(Simulation_context& ctx__,
+                  Density&            density__,
+                  K_point_set&        kset__,
+                  int                 order__)
+        : ctx_(ctx__)
+        , density_(density__)
+        , kset_(kset__)
+        , order_(order__)
+    {
+        if (order_ < 0 || order_ > 2) {
+            std::stringstream s;
+            s << "wrong order of extrapolation: " << order_;
+            TERMINATE(s);
+        }
+        if (!ctx_.full_potential()) {
+            ri_ = std::unique_ptr<Radial_integrals_rho_pseudo>(
+                new Radial_integrals_rho_pseudo(ctx_.unit_cell(), ctx_.pw_cutoff(), 20));
+        }
+    }
+
+    /// Save the converged state of the current ionic step.
+    /** Must be called before the atoms are moved. */
+    void save()
+    {
+        PROFILE("sirius::Extrapolation::save");
+
+        if (ctx_.full_potential()) {
+            return;
+        }
+
+        std::vector<vector3d<double>> pos(ctx_.unit_cell().num_atoms());
+        for (int ia = 0; ia < ctx_.unit_cell().num_atoms(); ia++) {
+            pos[ia] = ctx_.unit_cell().atom(ia).position();
+        }
+
+        auto rho_at = atomic_density();
+
+        mdarray<double_complex, 2> drho(ctx_.gvec().count(), ctx_.num_mag_dims() + 1);
+        for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
+            drho(igloc, 0) = density_.rho().f_pw_local(igloc) - rho_at[igloc];
+        }
+        for (int j = 0; j < ctx_.num_mag_dims(); j++) {
+            for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
+                drho(igloc, j + 1) = density_.magnetization(j).f_pw_local(igloc);
+            }
+        }
+
+        positions_.push_front(pos);
+        drho_.push_front(std::move(drho));
+        if (positions_.size() > 3) {
+            positions_.pop_back();
+            drho_.pop_back();
+        }
+    }
+
+    /// Generate the starting density and wave-functions for the new atomic positions.
+    /** Must be called after the simulation context and the k-point set were updated for the new positions. */
+    void extrapolate()
+    {
+        PROFILE("sirius::Extrapolation::extrapolate");
+
+        if (ctx_.full_potential() || positions_.empty()) {
+            density_.initial_density();
+            return;
+        }
+
+        auto ab = find_alpha_beta();
+        double alpha = ab.first;
+        double beta  = ab.second;
+
+        if (ctx_.comm().rank() == 0 && ctx_.control().verbosity_ >= 1) {
+            printf("extrapolation coefficients: alpha = %f, beta = %f\n", alpha, beta);
+        }
+
+        auto rho_at = atomic_density();
+
+        auto drho = [&](int ig, int j, int istep)
+        {
+            return (istep < static_cast<int>(drho_.size())) ? drho_[istep](ig, j) : drho_.back()(ig, j);
+        };
+
+        for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
+            auto& f = (j == 0) ? density_.rho() : density_.magnetization(j - 1);
+            for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
+                double_complex z = drho(igloc, j, 0) + alpha * (drho(igloc, j, 0) - drho(igloc, j, 1)) +
+                                   beta * (drho(igloc, j, 1) - drho(igloc, j, 2));
+                f.f_pw_local(igloc) = (j == 0) ? z + rho_at[igloc] : z;
+            }
+            f.fft_transform(1);
+        }
+
+        /* wave-functions */
+        if (psi_prev_.size() != static_cast<size_t>(kset_.num_kpoints())) {
+            psi_prev_ = std::vector<std::deque<std::unique_ptr<Wave_functions>>>(kset_.num_kpoints());
+            psi_prev_kp_ = std::vector<K_point const*>(kset_.num_kpoints(), nullptr);
+        }
+        /* history of k-points which were moved to another k-group (and possibly back) is not valid any more */
+        for (int ik = 0; ik < kset_.num_kpoints(); ik++) {
+            if (kset_.spl_num_kpoints().local_rank(ik) != kset_.comm().rank() || kset_[ik] != psi_prev_kp_[ik]) {
+                psi_prev_[ik].clear();
+                psi_prev_kp_[ik] = nullptr;
+            }
+        }
+        for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
+            int ik  = kset_.spl_num_kpoints(ikloc);
+            auto kp = kset_.acquire_local(ikloc);
+
+            int nb = ctx_.num_bands();
+            /* copy of psi(t) becomes psi(t-dt) of the next step */
+            std::unique_ptr<Wave_functions> psi(new Wave_functions(kp->gkvec_partition(), nb, ctx_.num_spins()));
+            for (int s = 0; s < ctx_.num_spins(); s++) {
+                psi->copy_from(CPU, nb, kp->spinor_wave_functions(), s, 0, s, 0);
+            }
+
+            if (order_ > 0 && !psi_prev_[ik].empty()) {
+                if (kp->gkvec().reduced()) {
+                    extrapolate_wave_functions<double>(*kp, psi_prev_[ik], alpha, beta);
+                } else {
+                    extrapolate_wave_functions<double_complex>(*kp, psi_prev_[ik], alpha, beta);
+                }
+            }
+            psi_prev_[ik].push_front(std::move(psi));
+            psi_prev_kp_[ik] = kp;
+
+            kset_.release_local(ikloc);
+            if (psi_prev_[ik].size() > 2) {
+                psi_prev_[ik].pop_back();
+            }
+        }
+    }
+};
+
+} // namespace sirius
+
+#endif // __EXTRAPOLATION_HPP__
@@ -370,7 +370,7 @@ class Force
 
         auto& valence_rho = density_.rho();
 
-        Radial_integrals_vloc<false> ri(ctx_.unit_cell(), ctx_.pw_cutoff(), ctx_.settings().nprii_vloc_);
+        auto& ri = ctx_.vloc_ri();
 
         Unit_cell& unit_cell = ctx_.unit_cell();
 
@@ -424,13 +424,14 @@ class Force
         auto& spl_num_kp = kset_.spl_num_kpoints();
 
         for (int ikploc = 0; ikploc < spl_num_kp.local_size(); ikploc++) {
-            K_point* kp = kset_[spl_num_kp[ikploc]];
+            K_point* kp = kset_.acquire_local(ikploc);
 
             if (ctx_.gamma_point()) {
                 add_k_point_contribution<double>(*kp, forces_nonloc_);
             } else {
                 add_k_point_contribution<double_complex>(*kp, forces_nonloc_);
             }
+            kset_.release_local(ikploc);
         }
 
         ctx_.comm().allreduce(&forces_nonloc_(0, 0), 3 * ctx_.unit_cell().num_atoms());
@@ -465,7 +466,7 @@ class Force
 
         double fact = gvecs.reduced() ? 2.0 : 1.0;
 
-        Radial_integrals_rho_core_pseudo<false> ri(ctx_.unit_cell(), ctx_.pw_cutoff(), ctx_.settings().nprii_rho_core_);
+        auto& ri = ctx_.ps_core_ri();
 
         /* here the calculations are in lattice vectors space */
         #pragma omp parallel for
@@ -662,15 +663,7 @@ class Force
         rho_tmp.zero();
         #pragma omp parallel for schedule(static)
         for (int igloc = ig0; igloc < ctx_.gvec().count(); igloc++) {
-            int ig = ctx_.gvec().offset() + igloc;
-
-            double_complex rho(0, 0);
-
-            for (int ja = 0; ja < unit_cell.num_atoms(); ja++) {
-                rho += ctx_.gvec_phase_factor(ig, ja) * static_cast<double>(unit_cell.atom(ja).zn());
-            }
-
-            rho_tmp[igloc] = std::conj(rho);
+            rho_tmp[igloc] = std::conj(ctx_.ion_charge_structure_factor(igloc));
         }
 
         #pragma omp parallel for
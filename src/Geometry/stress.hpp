@@ -208,8 +208,7 @@ class Stress {
         stress_nonloc_.zero();
 
         for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
-            int ik = kset_.spl_num_kpoints(ikloc);
-            auto kp = kset_[ik];
+            auto kp = kset_.acquire_local(ikloc);
             if (kp->gkvec().reduced()) {
                 TERMINATE("reduced G+k vectors are not implemented for non-local stress: fix this");
             }
@@ -239,6 +238,8 @@ class Stress {
                 }
             }
 #endif
+
+            kset_.release_local(ikloc);
         }
 
         #pragma omp parallel
@@ -343,19 +344,21 @@ class Stress {
 
         stress_vloc_.zero();
 
-        Radial_integrals_vloc<false> ri_vloc(ctx_.unit_cell(), ctx_.pw_cutoff(), ctx_.settings().nprii_vloc_);
+        auto& ri_vloc = ctx_.vloc_ri();
         Radial_integrals_vloc<true> ri_vloc_dg(ctx_.unit_cell(), ctx_.pw_cutoff(), ctx_.settings().nprii_vloc_);
 
-        auto v = ctx_.make_periodic_function<index_domain_t::local>([&ri_vloc](int iat, double g)
-                                                                    {
-                                                                        return ri_vloc.value(iat, g);
-                                                                    });
+        /* potential and its derivative are generated in one pass over G-shells */
+        auto f_pw = ctx_.make_periodic_function<index_domain_t::local>({[&ri_vloc](int iat, double g)
+                                                                        {
+                                                                            return ri_vloc.value(iat, g);
+                                                                        },
+                                                                        [&ri_vloc_dg](int iat, double g)
+                                                                        {
+                                                                            return ri_vloc_dg.value(iat, g);
+                                                                        }});
+        auto& v  = f_pw[0];
+        auto& dv = f_pw[1];
 
-        auto dv = ctx_.make_periodic_function<index_domain_t::local>([&ri_vloc_dg](int iat, double g)
-                                                                     {
-                                                                         return ri_vloc_dg.value(iat, g);
-                                                                     });
-        
         double sdiag{0};
 
         int ig0 = (ctx_.comm().rank() == 0) ? 1 : 0;
@@ -519,11 +522,7 @@ class Stress {
             double g2 = std::pow(G.length(), 2);
             double g2lambda = g2 / 4.0 / lambda;
 
-            double_complex rho(0, 0);
-
-            for (int ia = 0; ia < uc.num_atoms(); ia++) {
-                rho += ctx_.gvec_phase_factor(ig, ia) * static_cast<double>(uc.atom(ia).zn());
-            }
+            double_complex rho = ctx_.ion_charge_structure_factor(igloc);
 
             double a1 = twopi * std::pow(std::abs(rho) / uc.omega(), 2) * std::exp(-g2lambda) / g2;
             
@@ -599,8 +598,7 @@ class Stress {
         stress_kin_.zero();
 
         for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
-            int ik = kset_.spl_num_kpoints(ikloc);
-            auto kp = kset_[ik];
+            auto kp = kset_.acquire_local(ikloc);
             if (kp->gkvec().reduced()) {
                 TERMINATE("fix this");
             }
@@ -624,6 +622,7 @@ class Stress {
                     }
                 }
             } // igloc
+            kset_.release_local(ikloc);
         } // ikloc
 
         ctx_.comm().allreduce(&stress_kin_(0, 0), 9);
@@ -720,12 +719,14 @@ class Stress {
             mdarray<double_complex, 2> phase_factors(atom_type.num_atoms(), ctx_.gvec().count());
 
             sddk::timer t0("sirius::Stress|us|phase_fac");
-            #pragma omp parallel for schedule(static)
-            for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
-                int ig = ctx_.gvec().offset() + igloc;
-                for (int i = 0; i < atom_type.num_atoms(); i++) {
-                    int ia = atom_type.atom_id(i);
-                    phase_factors(i, igloc) = ctx_.gvec_phase_factor(ig, ia);
+            {
+                mdarray<double_complex, 2> pf(ctx_.gvec().count(), atom_type.num_atoms());
+                ctx_.generate_phase_factors(iat, 0, ctx_.gvec().count(), pf.at<CPU>(), pf.ld());
+                #pragma omp parallel for schedule(static)
+                for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
+                    for (int i = 0; i < atom_type.num_atoms(); i++) {
+                        phase_factors(i, igloc) = pf(igloc, i);
+                    }
                 }
             }
             t0.stop();
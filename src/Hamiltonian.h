@@ -470,6 +470,16 @@ class Hamiltonian
                              Wave_functions& hphi__,
                              Wave_functions& ophi__) const;
 
+    /// Get diagonal elements of LAPW Hamiltonian and overlap matrices.
+    /** Matching coefficients of each atom are generated only once and are used for both diagonals. The diagonal
+     *  elements are used to precondition the residuals of the iterative (matrix-free) LAPW solver. */
+    template <bool need_h, bool need_o>
+    inline void get_h_o_diag(K_point*            kp__,
+                             double              v0__,
+                             double              theta0__,
+                             mdarray<double, 2>& h_diag__,
+                             mdarray<double, 1>& o_diag__) const;
+
     /// Get diagonal elements of LAPW Hamiltonian.
     inline mdarray<double, 2> get_h_diag(K_point* kp__, double v0__, double theta0__) const;
 
@@ -439,15 +439,26 @@ inline void Hamiltonian::apply_fv_h_o(K_point* kp__,
     //    }
     //}
 
-    matrix<double_complex> alm(kp__->num_gkvec_loc(), unit_cell_.max_mt_aw_basis_size(), ctx_.dual_memory_t());
-    matrix<double_complex> halm(kp__->num_gkvec_loc(),
-                                std::max(unit_cell_.max_mt_aw_basis_size(), unit_cell_.max_mt_lo_basis_size()),
-                                ctx_.dual_memory_t());
+    /* size of the block of bands */
+    int nb = ctx_.iterative_solver_input().apply_block_size_;
+    if (nb <= 0 || nb > n__) {
+        nb = std::max(n__, 1);
+    }
+    int num_blocks = (n__ + nb - 1) / nb;
 
-    matrix<double_complex> tmp1(unit_cell_.max_mt_aw_basis_size(), n__, ctx_.dual_memory_t());
-    matrix<double_complex> tmp2(unit_cell_.max_mt_aw_basis_size(), n__, ctx_.dual_memory_t());
+    matrix<double_complex> alm(kp__->num_gkvec_loc(), unit_cell_.max_mt_aw_basis_size(), ctx_.dual_memory_t());
+    matrix<double_complex> halm(kp__->num_gkvec_loc(), unit_cell_.max_mt_aw_basis_size(), ctx_.dual_memory_t());
+    /* APW-lo blocks of Hamiltonian and overlap for a single atom */
+    matrix<double_complex> halo;
+    matrix<double_complex> oalo;
+    if (unit_cell_.max_mt_lo_basis_size()) {
+        halo = matrix<double_complex>(kp__->num_gkvec_loc(), unit_cell_.max_mt_lo_basis_size(), ctx_.dual_memory_t());
+        oalo = matrix<double_complex>(kp__->num_gkvec_loc(), unit_cell_.max_mt_lo_basis_size(), ctx_.dual_memory_t());
+    }
 
-// matrix<double_complex> hmt(unit_cell_.max_mt_aw_basis_size(), unit_cell_.max_mt_lo_basis_size());
+    matrix<double_complex> tmp1(unit_cell_.max_mt_aw_basis_size(), nb, ctx_.dual_memory_t());
+    matrix<double_complex> tmp2(unit_cell_.max_mt_aw_basis_size(), nb, ctx_.dual_memory_t());
+    matrix<double_complex> tmp3(std::max(1, unit_cell_.max_mt_lo_basis_size()), nb, ctx_.dual_memory_t());
 
 #ifdef __GPU
     if (ctx_.processing_unit() == GPU) {
@@ -465,206 +476,231 @@ inline void Hamiltonian::apply_fv_h_o(K_point* kp__,
         kp__->alm_coeffs_loc().generate(ia, alm);
         apply_hmt_to_apw<spin_block_t::nm>(atom, kp__->num_gkvec_loc(), alm, halm);
 
-        if (ctx_.processing_unit() == GPU) {
-            alm.copy<memory_t::host, memory_t::device>();
-            halm.copy<memory_t::host, memory_t::device>();
+        /* conjugate matching coefficients once; they are used with the 'C' operation in the first GEMM */
+        #pragma omp parallel for schedule(static)
+        for (int xi = 0; xi < naw; xi++) {
+            for (int ig = 0; ig < kp__->num_gkvec_loc(); ig++) {
+                alm(ig, xi) = std::conj(alm(ig, xi));
+            }
         }
 
-        /* create arrays with proper dimensions from the already allocated chunk of memory */
-        matrix<double_complex> alm_phi;
-        matrix<double_complex> halm_phi;
-
-        switch (ctx_.processing_unit()) {
-            case CPU: {
-                alm_phi  = matrix<double_complex>(tmp1.at<CPU>(), naw, n__);
-                halm_phi = matrix<double_complex>(tmp2.at<CPU>(), naw, n__);
-                break;
+        if (nlo) {
+            sddk::timer t2("sirius::Hamiltonian::apply_fv_h_o|apw-lo");
+            matrix<double_complex> hmt(naw, nlo);
+            oalo.zero();
+            #pragma omp parallel for
+            for (int ilo = 0; ilo < nlo; ilo++) {
+                int xi_lo = type.mt_aw_basis_size() + ilo;
+                /* local orbital indices */
+                int l_lo     = type.indexb(xi_lo).l;
+                int lm_lo    = type.indexb(xi_lo).lm;
+                int idxrf_lo = type.indexb(xi_lo).idxrf;
+                int order_lo = type.indexb(xi_lo).order;
+                /* APW-lo block of overlap */
+                for (int order_aw = 0; order_aw < (int)type.aw_descriptor(l_lo).size(); order_aw++) {
+                    for (int igloc = 0; igloc < kp__->num_gkvec_loc(); igloc++) {
+                        oalo(igloc, ilo) += alm(igloc, type.indexb_by_lm_order(lm_lo, order_aw)) *
+                                            atom.symmetry_class().o_radial_integral(l_lo, order_aw, order_lo);
+                    }
+                }
+                for (int xi = 0; xi < naw; xi++) {
+                    int lm_aw    = type.indexb(xi).lm;
+                    int idxrf_aw = type.indexb(xi).idxrf;
+                    auto& gc     = gaunt_coefs_->gaunt_vector(lm_aw, lm_lo);
+                    hmt(xi, ilo) = atom.radial_integrals_sum_L3<spin_block_t::nm>(idxrf_aw, idxrf_lo, gc);
+                }
             }
-            case GPU: {
-                alm_phi  = matrix<double_complex>(tmp1.at<CPU>(), tmp1.at<GPU>(), naw, n__);
-                halm_phi = matrix<double_complex>(tmp2.at<CPU>(), tmp2.at<GPU>(), naw, n__);
-                break;
+            /* APW-lo block of Hamiltonian */
+            linalg<CPU>::gemm(0, 0, kp__->num_gkvec_loc(), nlo, naw, alm.at<CPU>(), alm.ld(), hmt.at<CPU>(), hmt.ld(),
+                              halo.at<CPU>(), halo.ld());
+            if (ctx_.processing_unit() == GPU) {
+                halo.copy<memory_t::host, memory_t::device>();
+                oalo.copy<memory_t::host, memory_t::device>();
             }
         }
 
-        sddk::timer t1("sirius::Hamiltonian::apply_fv_h_o|apw-apw");
-
-        if (ctx_.processing_unit() == CPU) {
-            /* tmp(lm, i) = A(G, lm)^{T} * C(G, i) */
-            linalg<CPU>::gemm(1, 0, naw, n__, kp__->num_gkvec_loc(), alm.at<CPU>(), alm.ld(),
-                              phi__.pw_coeffs(0).prime().at<CPU>(0, N__), phi__.pw_coeffs(0).prime().ld(),
-                              alm_phi.at<CPU>(), alm_phi.ld());
-            /* htmp(lm, i) = H_{mt}A(G, lm)^{T} * C(G, i) */
-            linalg<CPU>::gemm(1, 0, naw, n__, kp__->num_gkvec_loc(), halm.at<CPU>(), halm.ld(),
-                              phi__.pw_coeffs(0).prime().at<CPU>(0, N__), phi__.pw_coeffs(0).prime().ld(),
-                              halm_phi.at<CPU>(), halm_phi.ld());
-        }
-#ifdef __GPU
         if (ctx_.processing_unit() == GPU) {
-            /* tmp(lm, i) = A(G, lm)^{T} * C(G, i) */
-            linalg<GPU>::gemm(1, 0, naw, n__, kp__->num_gkvec_loc(), alm.at<GPU>(), alm.ld(),
-                              phi__.pw_coeffs(0).prime().at<GPU>(0, N__), phi__.pw_coeffs(0).prime().ld(),
-                              alm_phi.at<GPU>(), alm_phi.ld());
-            /* htmp(lm, i) = H_{mt}A(G, lm)^{T} * C(G, i) */
-            linalg<GPU>::gemm(1, 0, naw, n__, kp__->num_gkvec_loc(), halm.at<GPU>(), halm.ld(),
-                              phi__.pw_coeffs(0).prime().at<GPU>(0, N__), phi__.pw_coeffs(0).prime().ld(),
-                              halm_phi.at<GPU>(), halm_phi.ld());
-            alm_phi.copy<memory_t::device, memory_t::host>();
-            halm_phi.copy<memory_t::device, memory_t::host>();
+            alm.copy<memory_t::host, memory_t::device>();
+            halm.copy<memory_t::host, memory_t::device>();
         }
-#endif
-
-        kp__->comm().allreduce(alm_phi.at<CPU>(), static_cast<int>(alm_phi.size()));
-        kp__->comm().allreduce(halm_phi.at<CPU>(), static_cast<int>(halm_phi.size()));
 
-        if (ctx_.processing_unit() == GPU) {
-            alm_phi.copy<memory_t::host, memory_t::device>();
-            halm_phi.copy<memory_t::host, memory_t::device>();
-        }
+        auto ia_location = phi__.spl_num_atoms().location(ia);
 
-        for (int xi = 0; xi < naw; xi++) {
-            for (int ig = 0; ig < kp__->num_gkvec_loc(); ig++) {
-                alm(ig, xi) = std::conj(alm(ig, xi));
+        for (int ib = 0; ib < num_blocks; ib++) {
+            /* index of the first band in the block */
+            int i0 = N__ + ib * nb;
+            /* number of bands in the block */
+            int nbnd = std::min(nb, n__ - ib * nb);
+
+            /* create arrays with proper dimensions from the already allocated chunk of memory */
+            matrix<double_complex> alm_phi;
+            matrix<double_complex> halm_phi;
+
+            switch (ctx_.processing_unit()) {
+                case CPU: {
+                    alm_phi  = matrix<double_complex>(tmp1.at<CPU>(), naw, nbnd);
+                    halm_phi = matrix<double_complex>(tmp2.at<CPU>(), naw, nbnd);
+                    break;
+                }
+                case GPU: {
+                    alm_phi  = matrix<double_complex>(tmp1.at<CPU>(), tmp1.at<GPU>(), naw, nbnd);
+                    halm_phi = matrix<double_complex>(tmp2.at<CPU>(), tmp2.at<GPU>(), naw, nbnd);
+                    break;
+                }
             }
-        }
-        if (ctx_.processing_unit() == GPU) {
-            alm.copy<memory_t::host, memory_t::device>();
-        }
 
-        if (ctx_.processing_unit() == CPU) {
-            /* APW-APW contribution to overlap */
-            linalg<CPU>::gemm(0, 0, kp__->num_gkvec_loc(), n__, naw, linalg_const<double_complex>::one(), alm.at<CPU>(),
-                              alm.ld(), alm_phi.at<CPU>(), alm_phi.ld(), linalg_const<double_complex>::one(),
-                              ophi__.pw_coeffs(0).prime().at<CPU>(0, N__), ophi__.pw_coeffs(0).prime().ld());
-            /* APW-APW contribution to Hamiltonian */
-            linalg<CPU>::gemm(0, 0, kp__->num_gkvec_loc(), n__, naw, linalg_const<double_complex>::one(), alm.at<CPU>(),
-                              alm.ld(), halm_phi.at<CPU>(), halm_phi.ld(), linalg_const<double_complex>::one(),
-                              hphi__.pw_coeffs(0).prime().at<CPU>(0, N__), hphi__.pw_coeffs(0).prime().ld());
-        }
+            sddk::timer t1("sirius::Hamiltonian::apply_fv_h_o|apw-apw");
+
+            if (ctx_.processing_unit() == CPU) {
+                /* tmp(lm, i) = A(G, lm)^{T} * C(G, i) */
+                linalg<CPU>::gemm(2, 0, naw, nbnd, kp__->num_gkvec_loc(), alm.at<CPU>(), alm.ld(),
+                                  phi__.pw_coeffs(0).prime().at<CPU>(0, i0), phi__.pw_coeffs(0).prime().ld(),
+                                  alm_phi.at<CPU>(), alm_phi.ld());
+                /* htmp(lm, i) = H_{mt}A(G, lm)^{T} * C(G, i) */
+                linalg<CPU>::gemm(1, 0, naw, nbnd, kp__->num_gkvec_loc(), halm.at<CPU>(), halm.ld(),
+                                  phi__.pw_coeffs(0).prime().at<CPU>(0, i0), phi__.pw_coeffs(0).prime().ld(),
+                                  halm_phi.at<CPU>(), halm_phi.ld());
+            }
 #ifdef __GPU
-        if (ctx_.processing_unit() == GPU) {
-            /* APW-APW contribution to overlap */
-            linalg<GPU>::gemm(0, 0, kp__->num_gkvec_loc(), n__, naw, &linalg_const<double_complex>::one(),
-                              alm.at<GPU>(), alm.ld(), alm_phi.at<GPU>(), alm_phi.ld(),
-                              &linalg_const<double_complex>::one(), ophi__.pw_coeffs(0).prime().at<GPU>(0, N__),
-                              ophi__.pw_coeffs(0).prime().ld());
-            /* APW-APW contribution to Hamiltonian */
-            linalg<GPU>::gemm(0, 0, kp__->num_gkvec_loc(), n__, naw, &linalg_const<double_complex>::one(),
-                              alm.at<GPU>(), alm.ld(), halm_phi.at<GPU>(), halm_phi.ld(),
-                              &linalg_const<double_complex>::one(), hphi__.pw_coeffs(0).prime().at<GPU>(0, N__),
-                              hphi__.pw_coeffs(0).prime().ld());
-        }
+            if (ctx_.processing_unit() == GPU) {
+                /* tmp(lm, i) = A(G, lm)^{T} * C(G, i) */
+                linalg<GPU>::gemm(2, 0, naw, nbnd, kp__->num_gkvec_loc(), alm.at<GPU>(), alm.ld(),
+                                  phi__.pw_coeffs(0).prime().at<GPU>(0, i0), phi__.pw_coeffs(0).prime().ld(),
+                                  alm_phi.at<GPU>(), alm_phi.ld());
+                /* htmp(lm, i) = H_{mt}A(G, lm)^{T} * C(G, i) */
+                linalg<GPU>::gemm(1, 0, naw, nbnd, kp__->num_gkvec_loc(), halm.at<GPU>(), halm.ld(),
+                                  phi__.pw_coeffs(0).prime().at<GPU>(0, i0), phi__.pw_coeffs(0).prime().ld(),
+                                  halm_phi.at<GPU>(), halm_phi.ld());
+                alm_phi.copy<memory_t::device, memory_t::host>();
+                halm_phi.copy<memory_t::device, memory_t::host>();
+            }
 #endif
-        t1.stop();
 
-        if (!nlo) {
-            continue;
-        }
+            kp__->comm().allreduce(alm_phi.at<CPU>(), static_cast<int>(alm_phi.size()));
+            kp__->comm().allreduce(halm_phi.at<CPU>(), static_cast<int>(halm_phi.size()));
 
-        /* local orbital coefficients of atom ia for all states */
-        matrix<double_complex> phi_lo_ia(nlo, n__, ctx_.dual_memory_t());
-        auto ia_location = phi__.spl_num_atoms().location(ia);
-        if (ia_location.rank == kp__->comm().rank()) {
-            for (int i = 0; i < n__; i++) {
-                std::memcpy(&phi_lo_ia(0, i),
-                            phi__.mt_coeffs(0).prime().at<CPU>(phi__.offset_mt_coeffs(ia_location.local_index), N__ + i),
-                            nlo * sizeof(double_complex));
+            if (ctx_.processing_unit() == GPU) {
+                alm_phi.copy<memory_t::host, memory_t::device>();
+                halm_phi.copy<memory_t::host, memory_t::device>();
             }
-        }
-        kp__->comm().bcast(phi_lo_ia.at<CPU>(), static_cast<int>(phi_lo_ia.size()), ia_location.rank);
-        if (ctx_.processing_unit() == GPU) {
-            phi_lo_ia.copy<memory_t::host, memory_t::device>();
-        }
 
-        matrix<double_complex> hmt(naw, nlo, ctx_.dual_memory_t());
+            if (ctx_.processing_unit() == CPU) {
+                /* APW-APW contribution to overlap */
+                linalg<CPU>::gemm(0, 0, kp__->num_gkvec_loc(), nbnd, naw, linalg_const<double_complex>::one(),
+                                  alm.at<CPU>(), alm.ld(), alm_phi.at<CPU>(), alm_phi.ld(),
+                                  linalg_const<double_complex>::one(), ophi__.pw_coeffs(0).prime().at<CPU>(0, i0),
+                                  ophi__.pw_coeffs(0).prime().ld());
+                /* APW-APW contribution to Hamiltonian */
+                linalg<CPU>::gemm(0, 0, kp__->num_gkvec_loc(), nbnd, naw, linalg_const<double_complex>::one(),
+                                  alm.at<CPU>(), alm.ld(), halm_phi.at<CPU>(), halm_phi.ld(),
+                                  linalg_const<double_complex>::one(), hphi__.pw_coeffs(0).prime().at<CPU>(0, i0),
+                                  hphi__.pw_coeffs(0).prime().ld());
+            }
+#ifdef __GPU
+            if (ctx_.processing_unit() == GPU) {
+                /* APW-APW contribution to overlap */
+                linalg<GPU>::gemm(0, 0, kp__->num_gkvec_loc(), nbnd, naw, &linalg_const<double_complex>::one(),
+                                  alm.at<GPU>(), alm.ld(), alm_phi.at<GPU>(), alm_phi.ld(),
+                                  &linalg_const<double_complex>::one(), ophi__.pw_coeffs(0).prime().at<GPU>(0, i0),
+                                  ophi__.pw_coeffs(0).prime().ld());
+                /* APW-APW contribution to Hamiltonian */
+                linalg<GPU>::gemm(0, 0, kp__->num_gkvec_loc(), nbnd, naw, &linalg_const<double_complex>::one(),
+                                  alm.at<GPU>(), alm.ld(), halm_phi.at<GPU>(), halm_phi.ld(),
+                                  &linalg_const<double_complex>::one(), hphi__.pw_coeffs(0).prime().at<GPU>(0, i0),
+                                  hphi__.pw_coeffs(0).prime().ld());
+            }
+#endif
+            t1.stop();
 
-        sddk::timer t2("sirius::Hamiltonian::apply_fv_h_o|apw-lo");
-        halm.zero();
-        #pragma omp parallel for
-        for (int ilo = 0; ilo < nlo; ilo++) {
-            int xi_lo = type.mt_aw_basis_size() + ilo;
-            /* local orbital indices */
-            int l_lo     = type.indexb(xi_lo).l;
-            int lm_lo    = type.indexb(xi_lo).lm;
-            int idxrf_lo = type.indexb(xi_lo).idxrf;
-            int order_lo = type.indexb(xi_lo).order;
-            /* use halm as temporary buffer to compute alm*o */
-            for (int order_aw = 0; order_aw < (int)type.aw_descriptor(l_lo).size(); order_aw++) {
-                for (int igloc = 0; igloc < kp__->num_gkvec_loc(); igloc++) {
-                    halm(igloc, ilo) += alm(igloc, type.indexb_by_lm_order(lm_lo, order_aw)) *
-                                        atom.symmetry_class().o_radial_integral(l_lo, order_aw, order_lo);
+            if (!nlo) {
+                continue;
+            }
+
+            /* local orbital coefficients of atom ia for the block of states */
+            matrix<double_complex> phi_lo_ia;
+            switch (ctx_.processing_unit()) {
+                case CPU: {
+                    phi_lo_ia = matrix<double_complex>(tmp3.at<CPU>(), nlo, nbnd);
+                    break;
+                }
+                case GPU: {
+                    phi_lo_ia = matrix<double_complex>(tmp3.at<CPU>(), tmp3.at<GPU>(), nlo, nbnd);
+                    break;
                 }
             }
-            for (int xi = 0; xi < naw; xi++) {
-                int lm_aw    = type.indexb(xi).lm;
-                int idxrf_aw = type.indexb(xi).idxrf;
-                auto& gc     = gaunt_coefs_->gaunt_vector(lm_aw, lm_lo);
-                hmt(xi, ilo) = atom.radial_integrals_sum_L3<spin_block_t::nm>(idxrf_aw, idxrf_lo, gc);
+            if (ia_location.rank == kp__->comm().rank()) {
+                for (int i = 0; i < nbnd; i++) {
+                    std::memcpy(&phi_lo_ia(0, i),
+                                phi__.mt_coeffs(0).prime().at<CPU>(phi__.offset_mt_coeffs(ia_location.local_index), i0 + i),
+                                nlo * sizeof(double_complex));
+                }
+            }
+            kp__->comm().bcast(phi_lo_ia.at<CPU>(), static_cast<int>(phi_lo_ia.size()), ia_location.rank);
+            if (ctx_.processing_unit() == GPU) {
+                phi_lo_ia.copy<memory_t::host, memory_t::device>();
             }
-        }
-        if (ctx_.processing_unit() == CPU) {
-            linalg<CPU>::gemm(0, 0, kp__->num_gkvec_loc(), n__, nlo, linalg_const<double_complex>::one(),
-                              halm.at<CPU>(), halm.ld(), phi_lo_ia.at<CPU>(), phi_lo_ia.ld(),
-                              linalg_const<double_complex>::one(), ophi__.pw_coeffs(0).prime().at<CPU>(0, N__),
-                              ophi__.pw_coeffs(0).prime().ld());
-
-            linalg<CPU>::gemm(0, 0, kp__->num_gkvec_loc(), nlo, naw, alm.at<CPU>(), alm.ld(), hmt.at<CPU>(), hmt.ld(),
-                              halm.at<CPU>(), halm.ld());
 
-            linalg<CPU>::gemm(0, 0, kp__->num_gkvec_loc(), n__, nlo, linalg_const<double_complex>::one(),
-                              halm.at<CPU>(), halm.ld(), phi_lo_ia.at<CPU>(), phi_lo_ia.ld(),
-                              linalg_const<double_complex>::one(), hphi__.pw_coeffs(0).prime().at<CPU>(0, N__),
-                              hphi__.pw_coeffs(0).prime().ld());
-        }
+            sddk::timer t2("sirius::Hamiltonian::apply_fv_h_o|apw-lo");
+            if (ctx_.processing_unit() == CPU) {
+                linalg<CPU>::gemm(0, 0, kp__->num_gkvec_loc(), nbnd, nlo, linalg_const<double_complex>::one(),
+                                  oalo.at<CPU>(), oalo.ld(), phi_lo_ia.at<CPU>(), phi_lo_ia.ld(),
+                                  linalg_const<double_complex>::one(), ophi__.pw_coeffs(0).prime().at<CPU>(0, i0),
+                                  ophi__.pw_coeffs(0).prime().ld());
+
+                linalg<CPU>::gemm(0, 0, kp__->num_gkvec_loc(), nbnd, nlo, linalg_const<double_complex>::one(),
+                                  halo.at<CPU>(), halo.ld(), phi_lo_ia.at<CPU>(), phi_lo_ia.ld(),
+                                  linalg_const<double_complex>::one(), hphi__.pw_coeffs(0).prime().at<CPU>(0, i0),
+                                  hphi__.pw_coeffs(0).prime().ld());
+            }
 #ifdef __GPU
-        if (ctx_.processing_unit() == GPU) {
-            halm.copy<memory_t::host, memory_t::device>();
-            hmt.copy<memory_t::host, memory_t::device>();
-            linalg<GPU>::gemm(0, 0, kp__->num_gkvec_loc(), n__, nlo, &linalg_const<double_complex>::one(),
-                              halm.at<GPU>(), halm.ld(), phi_lo_ia.at<GPU>(), phi_lo_ia.ld(),
-                              &linalg_const<double_complex>::one(), ophi__.pw_coeffs(0).prime().at<GPU>(0, N__),
-                              ophi__.pw_coeffs(0).prime().ld());
-
-            linalg<GPU>::gemm(0, 0, kp__->num_gkvec_loc(), nlo, naw, alm.at<GPU>(), alm.ld(), hmt.at<GPU>(), hmt.ld(),
-                              halm.at<GPU>(), halm.ld());
-            linalg<GPU>::gemm(0, 0, kp__->num_gkvec_loc(), n__, nlo, &linalg_const<double_complex>::one(),
-                              halm.at<GPU>(), halm.ld(), phi_lo_ia.at<GPU>(), phi_lo_ia.ld(),
-                              &linalg_const<double_complex>::one(), hphi__.pw_coeffs(0).prime().at<GPU>(0, N__),
-                              hphi__.pw_coeffs(0).prime().ld());
-        }
+            if (ctx_.processing_unit() == GPU) {
+                linalg<GPU>::gemm(0, 0, kp__->num_gkvec_loc(), nbnd, nlo, &linalg_const<double_complex>::one(),
+                                  oalo.at<GPU>(), oalo.ld(), phi_lo_ia.at<GPU>(), phi_lo_ia.ld(),
+                                  &linalg_const<double_complex>::one(), ophi__.pw_coeffs(0).prime().at<GPU>(0, i0),
+                                  ophi__.pw_coeffs(0).prime().ld());
+
+                linalg<GPU>::gemm(0, 0, kp__->num_gkvec_loc(), nbnd, nlo, &linalg_const<double_complex>::one(),
+                                  halo.at<GPU>(), halo.ld(), phi_lo_ia.at<GPU>(), phi_lo_ia.ld(),
+                                  &linalg_const<double_complex>::one(), hphi__.pw_coeffs(0).prime().at<GPU>(0, i0),
+                                  hphi__.pw_coeffs(0).prime().ld());
+            }
 #endif
-        t2.stop();
+            t2.stop();
 
-        sddk::timer t3("sirius::Band::apply_fv_h_o|lo-apw");
-        /* lo-APW contribution */
-        for (int i = 0; i < n__; i++) {
-            for (int ilo = 0; ilo < type.mt_lo_basis_size(); ilo++) {
-                int xi_lo = type.mt_aw_basis_size() + ilo;
-                /* local orbital indices */
-                int l_lo     = type.indexb(xi_lo).l;
-                int lm_lo    = type.indexb(xi_lo).lm;
-                int order_lo = type.indexb(xi_lo).order;
-                int idxrf_lo = type.indexb(xi_lo).idxrf;
+            if (ia_location.rank != kp__->comm().rank()) {
+                continue;
+            }
+
+            sddk::timer t3("sirius::Hamiltonian::apply_fv_h_o|lo-apw");
+            int offs = ophi__.offset_mt_coeffs(ia_location.local_index);
+            /* lo-APW contribution */
+            for (int i = 0; i < nbnd; i++) {
+                for (int ilo = 0; ilo < nlo; ilo++) {
+                    int xi_lo = type.mt_aw_basis_size() + ilo;
+                    /* local orbital indices */
+                    int l_lo     = type.indexb(xi_lo).l;
+                    int lm_lo    = type.indexb(xi_lo).lm;
+                    int order_lo = type.indexb(xi_lo).order;
+                    int idxrf_lo = type.indexb(xi_lo).idxrf;
 
-                if (ia_location.rank == kp__->comm().rank()) {
                     /* lo-lo contribution */
-                    for (int jlo = 0; jlo < type.mt_lo_basis_size(); jlo++) {
+                    for (int jlo = 0; jlo < nlo; jlo++) {
                         int xi_lo1 = type.mt_aw_basis_size() + jlo;
                         int lm1    = type.indexb(xi_lo1).lm;
                         int order1 = type.indexb(xi_lo1).order;
                         int idxrf1 = type.indexb(xi_lo1).idxrf;
                         auto& gc   = gaunt_coefs_->gaunt_vector(lm_lo, lm1);
                         if (lm_lo == lm1) {
-                            ophi__.mt_coeffs(0).prime(ophi__.offset_mt_coeffs(ia_location.local_index) + ilo, N__ + i) +=
+                            ophi__.mt_coeffs(0).prime(offs + ilo, i0 + i) +=
                                 phi_lo_ia(jlo, i) * atom.symmetry_class().o_radial_integral(l_lo, order_lo, order1);
                         }
-                        hphi__.mt_coeffs(0).prime(hphi__.offset_mt_coeffs(ia_location.local_index) + ilo, N__ + i) +=
+                        hphi__.mt_coeffs(0).prime(offs + ilo, i0 + i) +=
                             phi_lo_ia(jlo, i) * atom.radial_integrals_sum_L3<spin_block_t::nm>(idxrf_lo, idxrf1, gc);
                     }
 
                     for (int order_aw = 0; order_aw < (int)type.aw_descriptor(l_lo).size(); order_aw++) {
                         /* lo-APW contribution */
-                        ophi__.mt_coeffs(0).prime(ophi__.offset_mt_coeffs(ia_location.local_index) + ilo, N__ + i) +=
+                        ophi__.mt_coeffs(0).prime(offs + ilo, i0 + i) +=
                             atom.symmetry_class().o_radial_integral(l_lo, order_lo, order_aw) *
                             alm_phi(type.indexb_by_lm_order(lm_lo, order_aw), i);
                     }
@@ -677,11 +713,11 @@ inline void Hamiltonian::apply_fv_h_o(K_point* kp__,
                         z += atom.radial_integrals_sum_L3<spin_block_t::nm>(idxrf_lo, idxrf_aw, gc) * alm_phi(xi, i);
                     }
                     /* lo-APW contribution */
-                    hphi__.mt_coeffs(0).prime(hphi__.offset_mt_coeffs(ia_location.local_index) + ilo, N__ + i) += z;
+                    hphi__.mt_coeffs(0).prime(offs + ilo, i0 + i) += z;
                 }
             }
+            t3.stop();
         }
-        t3.stop();
     }
 
 #ifdef __GPU
@@ -1,9 +1,13 @@
-inline mdarray<double, 2>
-Hamiltonian::get_h_diag(K_point* kp__,
-                        double   v0__,
-                        double   theta0__) const
+template <bool need_h, bool need_o>
+inline void
+Hamiltonian::get_h_o_diag(K_point*            kp__,
+                          double              v0__,
+                          double              theta0__,
+                          mdarray<double, 2>& h_diag__,
+                          mdarray<double, 1>& o_diag__) const
 {
-    // TODO: code is replicated in o_diag
+    PROFILE("sirius::Hamiltonian::get_h_o_diag");
+
     splindex<block> spl_num_atoms(unit_cell_.num_atoms(), kp__->comm().size(), kp__->comm().rank());
     int nlo{0};
     for (int ialoc = 0; ialoc < spl_num_atoms.local_size(); ialoc++) {
@@ -11,27 +15,47 @@ Hamiltonian::get_h_diag(K_point* kp__,
         nlo += unit_cell_.atom(ia).mt_lo_basis_size();
     }
 
-    mdarray<double, 2> h_diag(kp__->num_gkvec_loc() + nlo, 1);
-    for (int igloc = 0; igloc < kp__->num_gkvec_loc(); igloc++) {
-        int ig = kp__->gkvec().gvec_offset(kp__->comm().rank()) + igloc;
+    if (need_h) {
+        h_diag__ = mdarray<double, 2>(kp__->num_gkvec_loc() + nlo, 1);
+        for (int igloc = 0; igloc < kp__->num_gkvec_loc(); igloc++) {
+            int ig = kp__->gkvec().gvec_offset(kp__->comm().rank()) + igloc;
 
-        double ekin = 0.5 * dot(kp__->gkvec().gkvec_cart(ig), kp__->gkvec().gkvec_cart(ig));
-        h_diag[igloc] = v0__ + ekin * theta0__;
+            double ekin = 0.5 * dot(kp__->gkvec().gkvec_cart(ig), kp__->gkvec().gkvec_cart(ig));
+            h_diag__[igloc] = v0__ + ekin * theta0__;
+        }
+    }
+    if (need_o) {
+        o_diag__ = mdarray<double, 1>(kp__->num_gkvec_loc() + nlo);
+        for (int igloc = 0; igloc < kp__->num_gkvec_loc(); igloc++) {
+            o_diag__[igloc] = theta0__;
+        }
     }
 
     matrix<double_complex> alm(kp__->num_gkvec_loc(), unit_cell_.max_mt_aw_basis_size());
-    matrix<double_complex> halm(kp__->num_gkvec_loc(), unit_cell_.max_mt_aw_basis_size());
+    matrix<double_complex> halm;
+    if (need_h) {
+        halm = matrix<double_complex>(kp__->num_gkvec_loc(), unit_cell_.max_mt_aw_basis_size());
+    }
 
+    /* matching coefficients are generated once and used for both diagonals */
     for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
         auto& atom = unit_cell_.atom(ia);
         int nmt = atom.mt_aw_basis_size();
 
         kp__->alm_coeffs_loc().generate(ia, alm);
-        apply_hmt_to_apw<spin_block_t::nm>(atom, kp__->num_gkvec_loc(), alm, halm);
+        if (need_h) {
+            apply_hmt_to_apw<spin_block_t::nm>(atom, kp__->num_gkvec_loc(), alm, halm);
+        }
 
-        for (int xi = 0; xi < nmt; xi++) {
-            for (int igloc = 0; igloc < kp__->num_gkvec_loc(); igloc++) {
-                h_diag[igloc] += std::real(std::conj(alm(igloc, xi)) * halm(igloc, xi));
+        #pragma omp parallel for schedule(static)
+        for (int igloc = 0; igloc < kp__->num_gkvec_loc(); igloc++) {
+            for (int xi = 0; xi < nmt; xi++) {
+                if (need_h) {
+                    h_diag__[igloc] += std::real(std::conj(alm(igloc, xi)) * halm(igloc, xi));
+                }
+                if (need_o) {
+                    o_diag__[igloc] += std::real(std::conj(alm(igloc, xi)) * alm(igloc, xi));
+                }
             }
         }
     }
@@ -44,17 +68,42 @@ Hamiltonian::get_h_diag(K_point* kp__,
         for (int ilo = 0; ilo < type.mt_lo_basis_size(); ilo++) {
             int xi_lo = type.mt_aw_basis_size() + ilo;
             /* local orbital indices */
+            int l_lo     = type.indexb(xi_lo).l;
             int lm_lo    = type.indexb(xi_lo).lm;
+            int order_lo = type.indexb(xi_lo).order;
             int idxrf_lo = type.indexb(xi_lo).idxrf;
 
-            h_diag[kp__->num_gkvec_loc() + nlo] = atom.radial_integrals_sum_L3<spin_block_t::nm>(idxrf_lo, idxrf_lo, gaunt_coefs_->gaunt_vector(lm_lo, lm_lo)).real();
+            if (need_h) {
+                h_diag__[kp__->num_gkvec_loc() + nlo] = atom.radial_integrals_sum_L3<spin_block_t::nm>(idxrf_lo, idxrf_lo,
+                    gaunt_coefs_->gaunt_vector(lm_lo, lm_lo)).real();
+            }
+            if (need_o) {
+                o_diag__[kp__->num_gkvec_loc() + nlo] = atom.symmetry_class().o_radial_integral(l_lo, order_lo, order_lo);
+            }
             nlo++;
         }
     }
+
     if (ctx_.processing_unit() == GPU) {
-        h_diag.allocate(memory_t::device);
-        h_diag.copy<memory_t::host, memory_t::device>();
+        if (need_h) {
+            h_diag__.allocate(memory_t::device);
+            h_diag__.copy<memory_t::host, memory_t::device>();
+        }
+        if (need_o) {
+            o_diag__.allocate(memory_t::device);
+            o_diag__.copy<memory_t::host, memory_t::device>();
+        }
     }
+}
+
+inline mdarray<double, 2>
+Hamiltonian::get_h_diag(K_point* kp__,
+                        double   v0__,
+                        double   theta0__) const
+{
+    mdarray<double, 2> h_diag;
+    mdarray<double, 1> o_diag;
+    get_h_o_diag<true, false>(kp__, v0__, theta0__, h_diag, o_diag);
     return std::move(h_diag);
 }
 
@@ -62,39 +111,9 @@ inline mdarray<double, 1>
 Hamiltonian::get_o_diag(K_point* kp__,
                         double   theta0__) const
 {
-    splindex<block> spl_num_atoms(unit_cell_.num_atoms(), kp__->comm().size(), kp__->comm().rank());
-    int nlo{0};
-    for (int ialoc = 0; ialoc < spl_num_atoms.local_size(); ialoc++) {
-        int ia = spl_num_atoms[ialoc];
-        nlo += unit_cell_.atom(ia).mt_lo_basis_size();
-    }
-
-    mdarray<double, 1> o_diag(kp__->num_gkvec_loc() + nlo);
-    for (int igloc = 0; igloc < kp__->num_gkvec_loc(); igloc++) {
-        o_diag[igloc] = theta0__;
-    }
-    for (size_t i = kp__->num_gkvec_loc(); i < o_diag.size(); i++) {
-        o_diag[i] = 1;
-    }
-
-    matrix<double_complex> alm(kp__->num_gkvec_loc(), unit_cell_.max_mt_aw_basis_size());
-
-    for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
-        auto& atom = unit_cell_.atom(ia);
-        int nmt = atom.mt_aw_basis_size();
-
-        kp__->alm_coeffs_loc().generate(ia, alm);
-
-        for (int xi = 0; xi < nmt; xi++) {
-            for (int igloc = 0; igloc < kp__->num_gkvec_loc(); igloc++) {
-                o_diag[igloc] += std::real(std::conj(alm(igloc, xi)) * alm(igloc, xi));
-            }
-        }
-    }
-    if (ctx_.processing_unit() == GPU) {
-        o_diag.allocate(memory_t::device);
-        o_diag.copy<memory_t::host, memory_t::device>();
-    }
+    mdarray<double, 2> h_diag;
+    mdarray<double, 1> o_diag;
+    get_h_o_diag<false, true>(kp__, 0, theta0__, h_diag, o_diag);
     return std::move(o_diag);
 }
 
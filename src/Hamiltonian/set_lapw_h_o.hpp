@@ -377,29 +377,73 @@ inline void Hamiltonian::set_fv_h_o_it(K_point* kp,
 
     double sq_alpha_half = 0.5 * std::pow(speed_of_light, -2);
 
-    #pragma omp parallel for default(shared)
-    for (int igk_col = 0; igk_col < kp->num_gkvec_col(); igk_col++) {
-        int ig_col          = kp->igk_col(igk_col);
-        auto gvec_col       = kp->gkvec().gvec(ig_col);
-        auto gkvec_col_cart = kp->gkvec().gkvec_cart(ig_col);
-        for (int igk_row = 0; igk_row < kp->num_gkvec_row(); igk_row++) {
-            int ig_row          = kp->igk_row(igk_row);
-            auto gvec_row       = kp->gkvec().gvec(ig_row);
-            auto gkvec_row_cart = kp->gkvec().gkvec_cart(ig_row);
-            int ig12 = ctx_.gvec().index_g12(gvec_row, gvec_col);
-            /* pw kinetic energy */
-            double t1 = 0.5 * dot(gkvec_row_cart, gkvec_col_cart);
-
-            h(igk_row, igk_col) += this->potential().veff_pw(ig12);
-            o(igk_row, igk_col) += ctx_.step_function().theta_pw(ig12);
+    int nrow = kp->num_gkvec_row();
+    int ncol = kp->num_gkvec_col();
+
+    /* G-vectors and Cartesian G+k vectors of the rows are computed once */
+    std::vector<vector3d<int>> gvec_row(nrow);
+    std::vector<vector3d<double>> gkvec_row_cart(nrow);
+    for (int igk_row = 0; igk_row < nrow; igk_row++) {
+        gvec_row[igk_row]       = kp->gkvec().gvec(kp->igk_row(igk_row));
+        gkvec_row_cart[igk_row] = kp->gkvec().gkvec_cart(kp->igk_row(igk_row));
+    }
 
-            if (ctx_.valence_relativity() == relativity_t::none) {
-                h(igk_row, igk_col) += t1 * ctx_.step_function().theta_pw(ig12);
-            } else {
-                h(igk_row, igk_col) += t1 * this->potential().rm_inv_pw(ig12);
-            }
-            if (ctx_.valence_relativity() == relativity_t::iora) {
-                o(igk_row, igk_col) += t1 * sq_alpha_half * this->potential().rm2_inv_pw(ig12);
+    /* G-G' indices are taken from the table of the k-point or computed on the fly for each tile of rows */
+    auto& g12 = kp->gvec_index_g12();
+
+    auto rel = ctx_.valence_relativity();
+    auto veff_pw  = &this->potential().veff_pw(0);
+    auto theta_pw = &ctx_.step_function().theta_pw(0);
+    /* kinetic energy is multiplied by the step function or by the inverse relativistic mass */
+    auto t_pw     = (rel == relativity_t::none) ? theta_pw : &this->potential().rm_inv_pw(0);
+    auto rm2_pw   = (rel == relativity_t::iora) ? &this->potential().rm2_inv_pw(0) : nullptr;
+
+    /* size of the tile of rows */
+    int const bs{64};
+
+    #pragma omp parallel
+    {
+        std::array<int, bs> idx_buf;
+        std::array<double, bs> t1;
+        std::array<double_complex, bs> v;
+        std::array<double_complex, bs> theta;
+        std::array<double_complex, bs> tv;
+
+        #pragma omp for schedule(static)
+        for (int igk_col = 0; igk_col < ncol; igk_col++) {
+            auto gvec_col       = kp->gkvec().gvec(kp->igk_col(igk_col));
+            auto gkvec_col_cart = kp->gkvec().gkvec_cart(kp->igk_col(igk_col));
+            for (int r0 = 0; r0 < nrow; r0 += bs) {
+                int nr = std::min(bs, nrow - r0);
+                int const* idx = &idx_buf[0];
+                if (g12.size()) {
+                    idx = &g12(r0, igk_col);
+                } else {
+                    for (int i = 0; i < nr; i++) {
+                        idx_buf[i] = ctx_.gvec().index_g12(gvec_row[r0 + i], gvec_col);
+                    }
+                }
+                /* gather plane-wave coefficients of the tile in one pass */
+                for (int i = 0; i < nr; i++) {
+                    int ig12 = idx[i];
+                    v[i]     = veff_pw[ig12];
+                    theta[i] = theta_pw[ig12];
+                    tv[i]    = t_pw[ig12];
+                    /* pw kinetic energy */
+                    t1[i] = 0.5 * dot(gkvec_row_cart[r0 + i], gkvec_col_cart);
+                }
+                auto hcol = &h(r0, igk_col);
+                auto ocol = &o(r0, igk_col);
+                #pragma omp simd
+                for (int i = 0; i < nr; i++) {
+                    hcol[i] += v[i] + t1[i] * tv[i];
+                    ocol[i] += theta[i];
+                }
+                if (rm2_pw) {
+                    for (int i = 0; i < nr; i++) {
+                        ocol[i] += t1[i] * sq_alpha_half * rm2_pw[idx[i]];
+                    }
+                }
             }
         }
     }
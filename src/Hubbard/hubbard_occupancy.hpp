@@ -17,8 +17,7 @@ void hubbard_compute_occupation_numbers(K_point_set& kset_)
 
     for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
 
-        int ik  = kset_.spl_num_kpoints(ikloc);
-        auto kp = kset_[ik];
+        auto kp = kset_.acquire_local(ikloc);
 
         // if we are doing calculations for non colinear magnetism or
         // simple LDA then do not change the number of bands. the factor
@@ -100,48 +99,64 @@ void hubbard_compute_occupation_numbers(K_point_set& kset_)
             }
         }
 #endif
+        /* wave-functions are not needed any more */
+        kset_.release_local(ikloc);
+
         // now compute O_{ij}^{sigma,sigma'} = \sum_{nk} <psi_nk|phi_{i,sigma}><phi_{j,sigma^'}|psi_nk> f_{nk}
+        // as O^{T} = (dm F) dm^{H} on the row block of each atom, where F is the diagonal matrix of weighted
+        // band occupancies
 
-        if (ctx_.num_mag_dims() == 3) {
-            // there must be a way to do that with matrix multiplication
+        /* occupancy-weighted copy of dm */
+        matrix<double_complex> dm_f(this->number_of_hubbard_orbitals(), HowManyBands);
+        for (int ispn = 0; ispn < ((ctx_.num_mag_dims() == 3) ? 1 : ctx_.num_spins()); ispn++) {
+            const int nb = (ispn == 1) * kp->num_occupied_bands(0);
             #pragma omp parallel for schedule(static)
+            for (int nband = 0; nband < kp->num_occupied_bands(ispn); nband++) {
+                double f = kp->band_occupancy(nband, ispn) * kp->weight();
+                for (int i = 0; i < this->number_of_hubbard_orbitals(); i++) {
+                    dm_f(i, nband + nb) = dm(i, nband + nb) * f;
+                }
+            }
+        }
+
+        #pragma omp parallel
+        {
+            /* maximum size of the atomic block: two spin channels of the largest l */
+            int nm = 2 * static_cast<int>(this->occupancy_number_.size(0));
+            matrix<double_complex> om(nm, nm);
+            #pragma omp for schedule(dynamic, 1)
             for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
                 const auto& atom = unit_cell_.atom(ia);
+                if (!atom.type().hubbard_correction()) {
+                    continue;
+                }
                 const int lmax_at = 2 * atom.type().hubbard_l() + 1;
-                if (atom.type().hubbard_correction()) {
+                if (ctx_.num_mag_dims() == 3) {
+                    /* both spin channels of the atom at once */
+                    linalg<CPU>::gemm(0, 2, 2 * lmax_at, 2 * lmax_at, kp->num_occupied_bands(0),
+                                      dm_f.at<CPU>(this->offset[ia], 0), dm_f.ld(),
+                                      dm.at<CPU>(this->offset[ia], 0), dm.ld(),
+                                      om.at<CPU>(), om.ld());
                     for (int s1 = 0; s1 < ctx_.num_spins(); s1++) {
                         for (int s2 = 0; s2 < ctx_.num_spins(); s2++) {
                             int s = (s1 == s2) * s1 + (s1 != s2) * (1 + 2 * s2 + s1);
-                            for (int nband = 0; nband < kp->num_occupied_bands(0); nband++) {
-                                for (int m = 0; m < lmax_at; m++) {
-                                    for (int mp = 0; mp < lmax_at; mp++) {
-                                        this->occupancy_number_(m, mp, s, ia, 0) +=
-                                            std::conj(dm(this->offset[ia] + m + s1 * lmax_at, nband)) *
-                                            dm(this->offset[ia] + mp + s2 * lmax_at, nband) *
-                                            kp->band_occupancy(nband, 0) * kp->weight();
-                                    }
+                            for (int m = 0; m < lmax_at; m++) {
+                                for (int mp = 0; mp < lmax_at; mp++) {
+                                    this->occupancy_number_(m, mp, s, ia, 0) += om(mp + s2 * lmax_at, m + s1 * lmax_at);
                                 }
                             }
                         }
                     }
-                }
-            }
-        } else {
-            for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-                const int nb = (ispn == 1) * kp->num_occupied_bands(0);
-                #pragma omp parallel for schedule(static)
-                for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
-                    const auto& atom = unit_cell_.atom(ia);
-                    const int lmax_at = 2 * atom.type().hubbard_l() + 1;
-                    if (atom.type().hubbard_correction()) {
-                        for (int nband = 0; nband < kp->num_occupied_bands(ispn); nband++) {
-                            for (int m = 0; m < lmax_at; m++) {
-                                for (int mp = 0; mp < lmax_at; mp++) {
-                                    this->occupancy_number_(m, mp, ispn, ia, 0) +=
-                                        std::conj(dm(this->offset[ia] + m, nband + nb)) *
-                                        dm(this->offset[ia] + mp, nband + nb) *
-                                        kp->band_occupancy(nband, ispn) * kp->weight();
-                                }
+                } else {
+                    for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+                        const int nb = (ispn == 1) * kp->num_occupied_bands(0);
+                        linalg<CPU>::gemm(0, 2, lmax_at, lmax_at, kp->num_occupied_bands(ispn),
+                                          dm_f.at<CPU>(this->offset[ia], nb), dm_f.ld(),
+                                          dm.at<CPU>(this->offset[ia], nb), dm.ld(),
+                                          om.at<CPU>(), om.ld());
+                        for (int m = 0; m < lmax_at; m++) {
+                            for (int mp = 0; mp < lmax_at; mp++) {
+                                this->occupancy_number_(m, mp, ispn, ia, 0) += om(mp, m);
                             }
                         }
                     }
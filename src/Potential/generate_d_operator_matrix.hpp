@@ -85,27 +85,52 @@ inline void Potential::generate_D_operator_matrix()
             }
             continue;
         }
-        matrix<double> d_tmp(nbf * (nbf + 1) / 2, atom_type.num_atoms());
-        for (int iv = 0; iv < ctx_.num_mag_dims() + 1; iv++) {
-            switch (ctx_.processing_unit()) {
-                case CPU: {
-                    matrix<double> veff_a(2 * ctx_.gvec().count(), atom_type.num_atoms());
-
-                    #pragma omp parallel for schedule(static)
-                    for (int i = 0; i < atom_type.num_atoms(); i++) {
-                        int ia = atom_type.atom_id(i);
-
-                        for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
-                            int ig = ctx_.gvec().offset() + igloc;
-                            /* V(G) * exp(i * G * r_{alpha}) */
-                            auto z = veff_vec[iv]->f_pw_local(igloc) * ctx_.gvec_phase_factor(ig, ia);
-                            veff_a(2 * igloc, i)     = z.real();
-                            veff_a(2 * igloc + 1, i) = z.imag();
-                        }
+        int na = atom_type.num_atoms();
+        int nq = nbf * (nbf + 1) / 2;
+        int nv = ctx_.num_mag_dims() + 1;
+
+        /* On CPU the integrals with all components of the potential are computed at once. For each block of
+         * G-vectors the phase factors are generated once and the products V_{iv}(G) exp(i G r_{alpha}) for all
+         * atoms and all components enter a single GEMM with the packed (xi1 <= xi2) real-valued Q(G). */
+        matrix<double> d_all;
+        if (ctx_.processing_unit() == CPU) {
+            d_all = matrix<double>(nq, na * nv);
+            d_all.zero();
+
+            int gbs = std::max(1, std::min(ctx_.gvec().count(), ctx_.settings().gvec_block_size_));
+
+            mdarray<double_complex, 2> pf(gbs, na);
+            /* treat auxiliary array as real with x2 size */
+            matrix<double> veff_a(2 * gbs, na * nv);
+            auto veff_a_z = reinterpret_cast<double_complex*>(veff_a.at<CPU>());
+
+            for (int igloc0 = 0; igloc0 < ctx_.gvec().count(); igloc0 += gbs) {
+                int ngv = std::min(gbs, ctx_.gvec().count() - igloc0);
+                /* exp(i * G * r_{alpha}) */
+                ctx_.generate_phase_factors(iat, igloc0, ngv, pf.at<CPU>(), pf.ld());
+
+                #pragma omp parallel for schedule(static)
+                for (int k = 0; k < na * nv; k++) {
+                    int iv = k / na;
+                    int i  = k % na;
+                    for (int j = 0; j < ngv; j++) {
+                        /* V(G) * exp(i * G * r_{alpha}) */
+                        veff_a_z[j + k * gbs] = veff_vec[iv]->f_pw_local(igloc0 + j) * pf(j, i);
                     }
+                }
 
-                    linalg<CPU>::gemm(0, 0, nbf * (nbf + 1) / 2, atom_type.num_atoms(), 2 * ctx_.gvec().count(),
-                                      ctx_.augmentation_op(iat).q_pw(), veff_a, d_tmp);
+                linalg<CPU>::gemm(0, 0, nq, na * nv, 2 * ngv, linalg_const<double>::one(),
+                                  ctx_.augmentation_op(iat).q_pw().at<CPU>(0, 2 * igloc0),
+                                  ctx_.augmentation_op(iat).q_pw().ld(), veff_a.at<CPU>(), veff_a.ld(),
+                                  linalg_const<double>::one(), d_all.at<CPU>(), d_all.ld());
+            }
+        }
+
+        matrix<double> d_tmp(nq, na);
+        for (int iv = 0; iv < nv; iv++) {
+            switch (ctx_.processing_unit()) {
+                case CPU: {
+                    std::copy(&d_all(0, iv * na), &d_all(0, iv * na) + nq * na, &d_tmp(0, 0));
                     break;
                 }
                 case GPU: {
@@ -40,6 +40,56 @@ inline void Potential::init_PAW()
         paw_potential_data_.push_back(std::move(ppd));
     }
 
+    /* local atoms are given by the cost-based split of PAW atoms; group them by type for the one-centre XC */
+    paw_xc_batch_.clear();
+    for (int i = 0; i < unit_cell_.spl_num_paw_atoms().local_size(); i++) {
+        auto& atom_type = paw_potential_data_[i].atom_->type();
+        auto it = std::find_if(paw_xc_batch_.begin(), paw_xc_batch_.end(),
+                               [&atom_type](paw_xc_batch_t const& b) { return b.type_ == &atom_type; });
+        if (it == paw_xc_batch_.end()) {
+            paw_xc_batch_.push_back(paw_xc_batch_t());
+            paw_xc_batch_.back().type_ = &atom_type;
+            it = paw_xc_batch_.end() - 1;
+        }
+        it->atoms_.push_back(i);
+    }
+
+    for (auto& batch: paw_xc_batch_) {
+        /* all-electron and pseudo functions of each atom */
+        int N = batch.type_->num_mt_points() * 2 * static_cast<int>(batch.atoms_.size());
+        int ntp = sht_->num_points();
+        int lmmax = std::max(Utils::lmmax(2 * batch.type_->indexr().lmax_lo()), sht_->lmmax());
+        int num_spins = (ctx_.num_mag_dims() == 0) ? 1 : 2;
+
+        for (int ispn = 0; ispn < num_spins; ispn++) {
+            batch.rho_lm_.push_back(mdarray<double, 1>(lmmax * N, memory_t::host, "paw_xc_batch.rho_lm_"));
+            batch.rho_tp_.push_back(mdarray<double, 2>(ntp, N, memory_t::host, "paw_xc_batch.rho_tp_"));
+            batch.vxc_tp_.push_back(mdarray<double, 2>(ntp, N, memory_t::host, "paw_xc_batch.vxc_tp_"));
+        }
+        if (ctx_.num_mag_dims() == 3) {
+            for (int j = 0; j < 4; j++) {
+                batch.rho_nc_tp_.push_back(mdarray<double, 2>(ntp, N, memory_t::host, "paw_xc_batch.rho_nc_tp_"));
+            }
+        }
+        batch.exc_tp_ = mdarray<double, 2>(ntp, N, memory_t::host, "paw_xc_batch.exc_tp_");
+        if (is_gradient_correction()) {
+            for (int i = 0; i < 3 * num_spins; i++) {
+                batch.grad_rho_tp_.push_back(mdarray<double, 2>(ntp, N, memory_t::host, "paw_xc_batch.grad_rho_tp_"));
+            }
+            for (int ispn = 0; ispn < num_spins; ispn++) {
+                batch.lapl_rho_tp_.push_back(mdarray<double, 2>(ntp, N, memory_t::host, "paw_xc_batch.lapl_rho_tp_"));
+            }
+            for (int i = 0; i < 2 * num_spins - 1; i++) {
+                batch.sigma_tp_.push_back(mdarray<double, 2>(ntp, N, memory_t::host, "paw_xc_batch.sigma_tp_"));
+                batch.vsigma_tp_.push_back(mdarray<double, 2>(ntp, N, memory_t::host, "paw_xc_batch.vsigma_tp_"));
+            }
+            for (int i = 0; i < 3; i++) {
+                batch.grad_vsigma_tp_.push_back(mdarray<double, 2>(ntp, N, memory_t::host, "paw_xc_batch.grad_vsigma_tp_"));
+            }
+        }
+        batch.f_lm_ = mdarray<double, 2>(lmmax * N, 3, memory_t::host, "paw_xc_batch.f_lm_");
+    }
+
     for (int i = 0; i < unit_cell_.num_paw_atoms(); i++) {
         int ia = unit_cell_.paw_atom_index(i);
         int bs = unit_cell_.atom(ia).mt_basis_size();
@@ -73,16 +123,21 @@ inline void Potential::generate_PAW_effective_potential(Density const& density)
     /* zero Dij */
     paw_dij_.zero();
 
-    /* calculate xc and hartree for atoms */
+    /* calculate hartree for atoms */
     for(int i = 0; i < unit_cell_.spl_num_paw_atoms().local_size(); i++) {
         calc_PAW_local_potential(paw_potential_data_[i],
                                  density.ae_paw_atom_density(i),
                                  density.ps_paw_atom_density(i));
     }
 
+    /* calculate xc for all local atoms of the same type at once */
+    for (auto& batch: paw_xc_batch_) {
+        calc_PAW_xc_potential(batch, density);
+    }
+
 
     /* calculate PAW Dij matrix */
-    #pragma omp parallel for
+    #pragma omp parallel for schedule(dynamic, 1)
     for(int i = 0; i < unit_cell_.spl_num_paw_atoms().local_size(); i++) {
         calc_PAW_local_Dij(paw_potential_data_[i], paw_dij_);
 
@@ -118,195 +173,363 @@ inline void Potential::generate_PAW_effective_potential(Density const& density)
     paw_total_core_energy_ = energies[3];
 }
 
-inline double Potential::xc_mt_PAW_nonmagnetic(Spheric_function<spectral, double>& full_potential,
-                                               Spheric_function<spectral, double> const& full_density,
-                                               std::vector<double> const& rho_core)
+inline void Potential::xc_mt_PAW(paw_xc_batch_t& batch__,
+                                 std::vector<std::vector<Spheric_function<spectral, double>> const*> const& density__,
+                                 std::vector<std::vector<double> const*> const& rho_core__,
+                                 std::vector<std::vector<Spheric_function<spectral, double>>*> const& potential__,
+                                 std::vector<double>& energy__)
 {
-    int lmmax = static_cast<int>(full_density.size(0));
-
-    Radial_grid<double> const& rgrid = full_density.radial_grid();
-
-    /* new array to store core and valence densities */
-    Spheric_function<spectral, double> full_rho_lm_sf_new(lmmax, rgrid);
-
-    full_rho_lm_sf_new.zero();
-    full_rho_lm_sf_new += full_density;
-
-    double invY00 = 1.0 / y00 ;
+    PROFILE("sirius::Potential::xc_mt_PAW");
+
+    auto& rgrid = batch__.type_->radial_grid();
+
+    /* number of stacked functions */
+    int nf  = static_cast<int>(density__.size());
+    int nr  = rgrid.num_points();
+    /* total number of stacked radial points */
+    int N   = nr * nf;
+    int ntp = sht_->num_points();
+
+    int lmmax_sht = sht_->lmmax();
+    int lmmax_rho = static_cast<int>((*density__[0])[0].size(0));
+    /* the non-collinear spin densities are obtained in (theta, phi) and transformed to Rlm with the full SHT */
+    int lmmax_dens = (ctx_.num_mag_dims() == 3) ? lmmax_sht : lmmax_rho;
+    int num_spins = (ctx_.num_mag_dims() == 0) ? 1 : 2;
+
+    bool is_gga = is_gradient_correction();
+
+    /* backward transform of all stacked functions from Rlm to (theta, phi) */
+    auto backward = [&](int lmmax__, double const* flm__, mdarray<double, 2>& ftp__)
+    {
+        sht_->backward_transform(lmmax__, flm__, N, std::min(lmmax_sht, lmmax__), &ftp__(0, 0));
+    };
+
+    /* forward transform of all stacked functions from (theta, phi) to Rlm */
+    auto forward = [&](mdarray<double, 2> const& ftp__, double* flm__)
+    {
+        sht_->forward_transform(&ftp__(0, 0), N, lmmax_sht, lmmax_sht, flm__);
+    };
+
+    /* add the stacked potential in Rlm to the potential component of each function */
+    auto add_potential = [&](int j__)
+    {
+        #pragma omp parallel for
+        for (int k = 0; k < nf; k++) {
+            auto& pot = (*potential__[k])[j__];
+            int lmmax = std::min(static_cast<int>(pot.size(0)), lmmax_sht);
+            for (int ir = 0; ir < nr; ir++) {
+                for (int lm = 0; lm < lmmax; lm++) {
+                    pot(lm, ir) += batch__.f_lm_(lm + lmmax_sht * (k * nr + ir), 0);
+                }
+            }
+        }
+    };
 
-    /* adding core part */
-    for (int ir = 0; ir < rgrid.num_points(); ir++) {
-        full_rho_lm_sf_new(0,ir) += invY00 * rho_core[ir];
+    /* stacked densities with the core part in Rlm and in (theta, phi) */
+    switch (ctx_.num_mag_dims()) {
+        case 0:
+        case 1: {
+            #pragma omp parallel for
+            for (int k = 0; k < nf; k++) {
+                auto& dens = *density__[k];
+                for (int ir = 0; ir < nr; ir++) {
+                    double* rho_u = &batch__.rho_lm_[0][lmmax_rho * (k * nr + ir)];
+                    for (int lm = 0; lm < lmmax_rho; lm++) {
+                        rho_u[lm] = dens[0](lm, ir);
+                    }
+                    rho_u[0] += (*rho_core__[k])[ir] * (1 / y00);
+                    if (num_spins == 2) {
+                        /* up = 1/2 ( rho + magn );  down = 1/2 ( rho - magn ) */
+                        double* rho_d = &batch__.rho_lm_[1][lmmax_rho * (k * nr + ir)];
+                        for (int lm = 0; lm < lmmax_rho; lm++) {
+                            double rho = rho_u[lm];
+                            rho_u[lm] = 0.5 * (rho + dens[1](lm, ir));
+                            rho_d[lm] = 0.5 * (rho - dens[1](lm, ir));
+                        }
+                    }
+                }
+            }
+            for (int ispn = 0; ispn < num_spins; ispn++) {
+                backward(lmmax_rho, &batch__.rho_lm_[ispn][0], batch__.rho_tp_[ispn]);
+            }
+            break;
+        }
+        case 3: {
+            for (int j = 0; j < 4; j++) {
+                #pragma omp parallel for
+                for (int k = 0; k < nf; k++) {
+                    auto& f = (*density__[k])[j];
+                    std::copy(&f(0, 0), &f(0, 0) + lmmax_rho * nr, &batch__.f_lm_(lmmax_rho * k * nr, 0));
+                }
+                backward(lmmax_rho, &batch__.f_lm_(0, 0), batch__.rho_nc_tp_[j]);
+            }
+            /* transform 4D magnetization to spin-up, spin-down form (correct for LSDA)  rho ± |magn| */
+            #pragma omp parallel for
+            for (int k = 0; k < nf; k++) {
+                for (int ir = 0; ir < nr; ir++) {
+                    int i = k * nr + ir;
+                    for (int itp = 0; itp < ntp; itp++) {
+                        vector3d<double> magn({batch__.rho_nc_tp_[1](itp, i), batch__.rho_nc_tp_[2](itp, i),
+                                               batch__.rho_nc_tp_[3](itp, i)});
+                        double norm = magn.length();
+                        double rho  = batch__.rho_nc_tp_[0](itp, i) + (*rho_core__[k])[ir];
+
+                        batch__.rho_tp_[0](itp, i) = 0.5 * (rho + norm);
+                        batch__.rho_tp_[1](itp, i) = 0.5 * (rho - norm);
+                    }
+                }
+            }
+            for (int ispn = 0; ispn < 2; ispn++) {
+                forward(batch__.rho_tp_[ispn], &batch__.rho_lm_[ispn][0]);
+            }
+            break;
+        }
+        default: {
+            TERMINATE("PAW local potential error! Wrong number of spins!")
+        }
     }
 
-    Spheric_function<spatial,double> full_rho_tp_sf = transform(sht_.get(), full_rho_lm_sf_new);
-
-    /* create potential in theta phi */
-    Spheric_function<spatial,double> vxc_tp_sf(sht_->num_points(), rgrid);
-
-    /* create energy in theta phi */
-    Spheric_function<spatial,double> exc_tp_sf(sht_->num_points(), rgrid);
-
-    xc_mt_nonmagnetic(rgrid, xc_func_, full_rho_lm_sf_new, full_rho_tp_sf, vxc_tp_sf, exc_tp_sf);
-
-    full_potential += transform(sht_.get(), vxc_tp_sf);
-
-    /* calculate energy */
-    Spheric_function<spectral,double> exc_lm_sf = transform(sht_.get(), exc_tp_sf );
-
-    return inner(exc_lm_sf, full_rho_lm_sf_new);
-}
-
-inline double Potential::xc_mt_PAW_collinear(std::vector<Spheric_function<spectral, double>>& potential,
-                                             std::vector<Spheric_function<spectral, double>> const& density,
-                                             std::vector<double> const& rho_core)
-{
-    int lmsize_rho = static_cast<int>(density[0].size(0));
-
-    Radial_grid<double> const& rgrid = density[0].radial_grid();
-
-    /* new array to store core and valence densities */
-    Spheric_function<spectral, double> full_rho_lm_sf_new(lmsize_rho, rgrid);
-
-    full_rho_lm_sf_new.zero();
-    full_rho_lm_sf_new += density[0];
-
-    double invY00 = 1 / y00;
+    /* gradient of each stacked function in Rlm is computed separately and transformed to (theta, phi) in one go */
+    auto gradient_tp = [&](int lmmax__, double* flm__, mdarray<double, 2>* grad_tp__, mdarray<double, 2>* lapl_tp__)
+    {
+        for (int k = 0; k < nf; k++) {
+            Spheric_function<spectral, double> f(flm__ + lmmax__ * k * nr, lmmax__, rgrid);
+            auto g = gradient(f);
+            for (int x: {0, 1, 2}) {
+                std::copy(&g[x](0, 0), &g[x](0, 0) + lmmax__ * nr, &batch__.f_lm_(lmmax__ * k * nr, x));
+            }
+        }
+        for (int x: {0, 1, 2}) {
+            backward(lmmax__, &batch__.f_lm_(0, x), grad_tp__[x]);
+        }
+        if (lapl_tp__) {
+            for (int k = 0; k < nf; k++) {
+                Spheric_function<spectral, double> f(flm__ + lmmax__ * k * nr, lmmax__, rgrid);
+                auto l = laplacian(f);
+                std::copy(&l(0, 0), &l(0, 0) + lmmax__ * nr, &batch__.f_lm_(lmmax__ * k * nr, 0));
+            }
+            backward(lmmax__, &batch__.f_lm_(0, 0), *lapl_tp__);
+        }
+    };
 
-    /* adding core part */
-    for (int ir = 0; ir < rgrid.num_points(); ir++ ) {
-        full_rho_lm_sf_new(0,ir) += invY00 * rho_core[ir];
+    batch__.exc_tp_.zero();
+    for (int ispn = 0; ispn < num_spins; ispn++) {
+        batch__.vxc_tp_[ispn].zero();
     }
 
-    // calculate spin up spin down density components in lm components
-    // up = 1/2 ( rho + magn );  down = 1/2 ( rho - magn )
-    Spheric_function<spectral, double> rho_u_lm_sf = 0.5 * (full_rho_lm_sf_new + density[1]);
-    Spheric_function<spectral, double> rho_d_lm_sf = 0.5 * (full_rho_lm_sf_new - density[1]);
-
-    // transform density to theta phi components
-    Spheric_function<spatial, double> rho_u_tp_sf = transform(sht_.get(), rho_u_lm_sf );
-    Spheric_function<spatial, double> rho_d_tp_sf = transform(sht_.get(), rho_d_lm_sf );
-
-    // create potential in theta phi
-    Spheric_function<spatial, double> vxc_u_tp_sf(sht_->num_points(), rgrid);
-    Spheric_function<spatial, double> vxc_d_tp_sf(sht_->num_points(), rgrid);
-
-    // create energy in theta phi
-    Spheric_function<spatial, double> exc_tp_sf(sht_->num_points(), rgrid);
-
-    // calculate XC
-    xc_mt_magnetic(rgrid, xc_func_,
-                   rho_u_lm_sf, rho_u_tp_sf,
-                   rho_d_lm_sf, rho_d_tp_sf,
-                   vxc_u_tp_sf, vxc_d_tp_sf,
-                   exc_tp_sf);
-
-    // transform back in lm
-    potential[0] += transform(sht_.get(), 0.5 * (vxc_u_tp_sf + vxc_d_tp_sf) );
-    potential[1] += transform(sht_.get(), 0.5 * (vxc_u_tp_sf - vxc_d_tp_sf));
-
-    //------------------------
-    //--- calculate energy ---
-    //------------------------
-    Spheric_function<spectral,double> exc_lm_sf = transform(sht_.get(), exc_tp_sf );
-
-    return inner(exc_lm_sf, full_rho_lm_sf_new);
-}
-
-
-inline double Potential::xc_mt_PAW_noncollinear(std::vector<Spheric_function<spectral, double>>& potential,
-                            std::vector<Spheric_function<spectral, double>> const& density,
-                            std::vector<double> const& rho_core)
-{
-    if (density.size() != 4 || potential.size() != 4){
-       TERMINATE("xc_mt_PAW_noncollinear FATAL ERROR!")
+    if (is_gga) {
+        for (int ispn = 0; ispn < num_spins; ispn++) {
+            gradient_tp(lmmax_dens, &batch__.rho_lm_[ispn][0], &batch__.grad_rho_tp_[3 * ispn],
+                        &batch__.lapl_rho_tp_[ispn]);
+        }
+        /* contracted gradients: total or uu, ud, dd */
+        for (int i = 0; i < static_cast<int>(batch__.sigma_tp_.size()); i++) {
+            int s1 = (i == 2) ? 1 : 0;
+            int s2 = (i == 0) ? 0 : 1;
+            #pragma omp parallel for
+            for (int ir = 0; ir < N; ir++) {
+                for (int itp = 0; itp < ntp; itp++) {
+                    double d{0};
+                    for (int x: {0, 1, 2}) {
+                        d += batch__.grad_rho_tp_[3 * s1 + x](itp, ir) * batch__.grad_rho_tp_[3 * s2 + x](itp, ir);
+                    }
+                    batch__.sigma_tp_[i](itp, ir) = d;
+                }
+            }
+            batch__.vsigma_tp_[i].zero();
+        }
     }
 
-    Radial_grid<double> const& rgrid = density[0].radial_grid();
-
-    /* transform density to theta phi components */
-    std::vector<Spheric_function<spatial, double>> rho_tp(density.size());
-
-    for (size_t i = 0; i < density.size(); i++){
-        rho_tp[i] = transform(sht_.get(), density[i]);
+    /* loop over XC functionals; each thread calls libxc once for its part of the stacked points */
+    for (auto& ixc: xc_func_) {
+        #pragma omp parallel
+        {
+            splindex<block> spl(ntp * N, omp_get_num_threads(), omp_get_thread_num());
+            int i0 = spl.global_offset();
+            int n  = spl.local_size();
+
+            std::vector<double> exc_t(n);
+            std::vector<std::vector<double>> vrho_t(num_spins, std::vector<double>(n));
+            std::vector<std::vector<double>> vsigma_t(batch__.vsigma_tp_.size(), std::vector<double>(n));
+
+            auto rho_u = &batch__.rho_tp_[0][i0];
+            auto rho_d = &batch__.rho_tp_[num_spins - 1][i0];
+            auto vxc_u = &batch__.vxc_tp_[0][i0];
+            auto vxc_d = &batch__.vxc_tp_[num_spins - 1][i0];
+            auto exc   = &batch__.exc_tp_[i0];
+
+            if (n && ixc.is_lda()) {
+                if (num_spins == 1) {
+                    ixc.get_lda(n, rho_u, &vrho_t[0][0], &exc_t[0]);
+                } else {
+                    ixc.get_lda(n, rho_u, rho_d, &vrho_t[0][0], &vrho_t[1][0], &exc_t[0]);
+                }
+                for (int i = 0; i < n; i++) {
+                    exc[i] += exc_t[i];
+                    vxc_u[i] += vrho_t[0][i];
+                    if (num_spins == 2) {
+                        vxc_d[i] += vrho_t[1][i];
+                    }
+                }
+            }
+            if (n && ixc.is_gga()) {
+                if (num_spins == 1) {
+                    auto lapl = &batch__.lapl_rho_tp_[0][i0];
+                    ixc.get_gga(n, rho_u, &batch__.sigma_tp_[0][i0], &vrho_t[0][0], &vsigma_t[0][0], &exc_t[0]);
+                    for (int i = 0; i < n; i++) {
+                        exc[i] += exc_t[i];
+                        vxc_u[i] += (vrho_t[0][i] - 2 * vsigma_t[0][i] * lapl[i]);
+                        batch__.vsigma_tp_[0][i0 + i] += vsigma_t[0][i];
+                    }
+                } else {
+                    auto lapl_u = &batch__.lapl_rho_tp_[0][i0];
+                    auto lapl_d = &batch__.lapl_rho_tp_[1][i0];
+                    ixc.get_gga(n, rho_u, rho_d, &batch__.sigma_tp_[0][i0], &batch__.sigma_tp_[1][i0],
+                                &batch__.sigma_tp_[2][i0], &vrho_t[0][0], &vrho_t[1][0], &vsigma_t[0][0],
+                                &vsigma_t[1][0], &vsigma_t[2][0], &exc_t[0]);
+                    for (int i = 0; i < n; i++) {
+                        exc[i] += exc_t[i];
+                        vxc_u[i] += (vrho_t[0][i] - 2 * vsigma_t[0][i] * lapl_u[i] - vsigma_t[1][i] * lapl_d[i]);
+                        vxc_d[i] += (vrho_t[1][i] - 2 * vsigma_t[2][i] * lapl_d[i] - vsigma_t[1][i] * lapl_u[i]);
+                        for (int j = 0; j < 3; j++) {
+                            batch__.vsigma_tp_[j][i0 + i] += vsigma_t[j][i];
+                        }
+                    }
+                }
+            }
+        }
     }
 
-    /* transform 4D magnetization to spin-up, spin-down form (correct for LSDA)  rho ± |magn| */
-    Spheric_function<spatial, double> rho_u_tp(sht_->num_points(), rgrid);
-    Spheric_function<spatial, double> rho_d_tp(sht_->num_points(), rgrid);
-
-    //#pragma omp parallel for
-    for (int ir = 0; ir < rgrid.num_points(); ir++ ) {
-        for (int itp = 0; itp < sht_->num_points(); itp++ ) {
-            vector3d<double> magn({rho_tp[1](itp, ir), rho_tp[2](itp, ir), rho_tp[3](itp, ir)});
-            double norm = magn.length();
-
-            rho_u_tp(itp, ir) = 0.5 * (rho_tp[0](itp, ir) + rho_core[ir] + norm);
-            rho_d_tp(itp, ir) = 0.5 * (rho_tp[0](itp, ir) + rho_core[ir] - norm);
+    if (is_gga) {
+        /* remaining terms with the gradients of vsigma */
+        for (int i = 0; i < static_cast<int>(batch__.vsigma_tp_.size()); i++) {
+            forward(batch__.vsigma_tp_[i], &batch__.f_lm_(0, 0));
+            /* gradient is computed in place of the scratch space */
+            auto vsigma_lm = &batch__.f_lm_(0, 0);
+            gradient_tp(lmmax_sht, vsigma_lm, &batch__.grad_vsigma_tp_[0], nullptr);
+
+            /* the gradient of vsigma_uu (vsigma_dd) is multiplied by the up (down) gradient with the factor 2,
+             * the gradient of vsigma_ud is multiplied by the gradient of the opposite spin */
+            #pragma omp parallel for
+            for (int ir = 0; ir < N; ir++) {
+                for (int itp = 0; itp < ntp; itp++) {
+                    double d[] = {0, 0};
+                    for (int x: {0, 1, 2}) {
+                        for (int ispn = 0; ispn < num_spins; ispn++) {
+                            d[ispn] += batch__.grad_vsigma_tp_[x](itp, ir) * batch__.grad_rho_tp_[3 * ispn + x](itp, ir);
+                        }
+                    }
+                    switch (i) {
+                        case 0: {
+                            batch__.vxc_tp_[0](itp, ir) -= 2 * d[0];
+                            break;
+                        }
+                        case 1: {
+                            batch__.vxc_tp_[0](itp, ir) -= d[1];
+                            batch__.vxc_tp_[1](itp, ir) -= d[0];
+                            break;
+                        }
+                        case 2: {
+                            batch__.vxc_tp_[1](itp, ir) -= 2 * d[1];
+                            break;
+                        }
+                    }
+                }
+            }
         }
     }
 
-    /* in lm representation */
-    Spheric_function<spectral, double> rho_u_lm = transform(sht_.get(), rho_u_tp);
-    Spheric_function<spectral, double> rho_d_lm = transform(sht_.get(), rho_d_tp);
-
-    // allocate potential in theta phi
-    Spheric_function<spatial, double> vxc_u_tp(sht_->num_points(), rgrid);
-    Spheric_function<spatial, double> vxc_d_tp(sht_->num_points(), rgrid);
-
-    // allocate energy in theta phi
-    Spheric_function<spatial, double> exc_tp(sht_->num_points(), rgrid);
-
-    // calculate XC
-    xc_mt_magnetic(rgrid, xc_func_,
-                   rho_u_lm, rho_u_tp,
-                   rho_d_lm, rho_d_tp,
-                   vxc_u_tp, vxc_d_tp,
-                   exc_tp);
-
-    /* allocate 4D potential in theta phi components */
-    std::vector<Spheric_function<spatial, double>> vxc_tp;
-
-    /* allocate the rest */
-    for (size_t i = 0; i < potential.size(); i++){
-        vxc_tp.push_back(Spheric_function<spatial, double>(sht_->num_points(), rgrid));
+    /* transform the potential back to Rlm */
+    switch (ctx_.num_mag_dims()) {
+        case 0: {
+            forward(batch__.vxc_tp_[0], &batch__.f_lm_(0, 0));
+            add_potential(0);
+            break;
+        }
+        case 1: {
+            #pragma omp parallel for
+            for (int ir = 0; ir < N; ir++) {
+                for (int itp = 0; itp < ntp; itp++) {
+                    double vu = batch__.vxc_tp_[0](itp, ir);
+                    double vd = batch__.vxc_tp_[1](itp, ir);
+                    batch__.vxc_tp_[0](itp, ir) = 0.5 * (vu + vd);
+                    batch__.vxc_tp_[1](itp, ir) = 0.5 * (vu - vd);
+                }
+            }
+            for (int j = 0; j < 2; j++) {
+                forward(batch__.vxc_tp_[j], &batch__.f_lm_(0, 0));
+                add_potential(j);
+            }
+            break;
+        }
+        case 3: {
+            /* transform back potential from up/down to 4D form; magnetization is replaced by the effective field */
+            #pragma omp parallel for
+            for (int ir = 0; ir < N; ir++) {
+                for (int itp = 0; itp < ntp; itp++) {
+                    /* get total potential and field abs value*/
+                    double pot   = 0.5 * (batch__.vxc_tp_[0](itp, ir) + batch__.vxc_tp_[1](itp, ir));
+                    double field = 0.5 * (batch__.vxc_tp_[0](itp, ir) - batch__.vxc_tp_[1](itp, ir));
+
+                    /* get unit magnetization vector*/
+                    vector3d<double> magn({batch__.rho_nc_tp_[1](itp, ir), batch__.rho_nc_tp_[2](itp, ir),
+                                           batch__.rho_nc_tp_[3](itp, ir)});
+                    double norm = magn.length();
+                    magn = magn * (norm > 0.0 ? field / norm : 0.0);
+
+                    batch__.rho_nc_tp_[0](itp, ir) = pot;
+                    for (int x: {0, 1, 2}) {
+                        batch__.rho_nc_tp_[x + 1](itp, ir) = magn[x];
+                    }
+                }
+            }
+            for (int j = 0; j < 4; j++) {
+                forward(batch__.rho_nc_tp_[j], &batch__.f_lm_(0, 0));
+                add_potential(j);
+            }
+            break;
+        }
     }
 
-    /* transform back potential from up/down to 4D form*/
-    //#pragma omp parallel for
-    for (int ir = 0; ir < rgrid.num_points(); ir++ ) {
-        for (int itp = 0; itp < sht_->num_points(); itp++ ) {
-            /* get total potential and field abs value*/
-            double pot   = 0.5 * (vxc_u_tp(itp, ir) + vxc_d_tp(itp, ir));
-            double field = 0.5 * (vxc_u_tp(itp, ir) - vxc_d_tp(itp, ir));
-
-            /* get unit magnetization vector*/
-            vector3d<double> magn({rho_tp[1](itp, ir), rho_tp[2](itp, ir), rho_tp[3](itp, ir)});
-            double norm = magn.length();
-            magn = magn * (norm > 0.0 ? field / norm : 0.0) ;
-
-            /* add total potential and effective field values at current point */
-            vxc_tp[0](itp, ir) = pot;
-            for (int i: {0,1,2}) {
-                vxc_tp[i+1](itp, ir) = magn[i];
-            }
+    /* XC energy: the energy density in Rlm is integrated with the total density */
+    forward(batch__.exc_tp_, &batch__.f_lm_(0, 0));
+    #pragma omp parallel for
+    for (int k = 0; k < nf; k++) {
+        Spheric_function<spectral, double> exc_lm(&batch__.f_lm_(lmmax_sht * k * nr, 0), lmmax_sht, rgrid);
+        Spheric_function<spectral, double> rho_lm(&batch__.rho_lm_[0][lmmax_dens * k * nr], lmmax_dens, rgrid);
+        if (num_spins == 2) {
+            Spheric_function<spectral, double> rho_d_lm(&batch__.rho_lm_[1][lmmax_dens * k * nr], lmmax_dens, rgrid);
+            energy__[k] = inner(exc_lm, rho_lm + rho_d_lm);
+        } else {
+            energy__[k] = inner(exc_lm, rho_lm);
         }
     }
+}
 
-    // transform back in lm
-    for(size_t i = 0; i < density.size(); i++){
-        potential[i] += transform(sht_.get(), vxc_tp[i]);
+inline void Potential::calc_PAW_xc_potential(paw_xc_batch_t& batch__, Density const& density__)
+{
+    /* all-electron and pseudo functions of each atom are stacked one after the other */
+    std::vector<std::vector<Spheric_function<spectral, double>> const*> density;
+    std::vector<std::vector<double> const*> rho_core;
+    std::vector<std::vector<Spheric_function<spectral, double>>*> potential;
+    for (int i: batch__.atoms_) {
+        density.push_back(&density__.ae_paw_atom_density(i));
+        rho_core.push_back(&batch__.type_->paw_ae_core_charge_density());
+        potential.push_back(&paw_potential_data_[i].ae_potential_);
+
+        density.push_back(&density__.ps_paw_atom_density(i));
+        rho_core.push_back(&batch__.type_->ps_core_charge_density());
+        potential.push_back(&paw_potential_data_[i].ps_potential_);
     }
 
-    //------------------------
-    //--- calculate energy ---
-    //------------------------
-    Spheric_function<spectral,double> exc_lm = transform(sht_.get(), exc_tp );
+    std::vector<double> energy(density.size());
+    xc_mt_PAW(batch__, density, rho_core, potential, energy);
 
-    return inner(exc_lm, rho_u_lm + rho_d_lm);
+    for (size_t j = 0; j < batch__.atoms_.size(); j++) {
+        paw_potential_data_[batch__.atoms_[j]].xc_energy_ = energy[2 * j] - energy[2 * j + 1];
+    }
 }
 
-
 inline double Potential::calc_PAW_hartree_potential(Atom& atom,
                                                     Spheric_function<spectral, double> const& full_density,
                                                     Spheric_function<spectral, double>& full_potential)
@@ -370,42 +593,6 @@ inline void Potential::calc_PAW_local_potential(paw_potential_data_t &ppd,
                                                           ppd.ps_potential_[0]);
 
     ppd.hartree_energy_ = ae_hartree_energy - ps_hartree_energy;
-
-    //-----------------------------------------
-    //---- Calculation of XC potential ---
-    //-----------------------------------------
-    auto& ps_core = ppd.atom_->type().ps_core_charge_density();
-    auto& ae_core = ppd.atom_->type().paw_ae_core_charge_density();
-
-    double ae_xc_energy = 0.0;
-    double ps_xc_energy = 0.0;
-
-    switch (ctx_.num_mag_dims()) {
-        case 0: {
-            ae_xc_energy = xc_mt_PAW_nonmagnetic(ppd.ae_potential_[0], ae_density[0], ae_core);
-            ps_xc_energy = xc_mt_PAW_nonmagnetic(ppd.ps_potential_[0], ps_density[0], ps_core);
-            break;
-        }
-
-        case 1: {
-            ae_xc_energy = xc_mt_PAW_collinear(ppd.ae_potential_, ae_density, ae_core);
-            ps_xc_energy = xc_mt_PAW_collinear(ppd.ps_potential_, ps_density, ps_core);
-            break;
-        }
-
-        case 3:{
-            ae_xc_energy = xc_mt_PAW_noncollinear(ppd.ae_potential_, ae_density, ae_core);
-            ps_xc_energy = xc_mt_PAW_noncollinear(ppd.ps_potential_, ps_density, ps_core);
-            break;
-        }
-
-        default:{
-            TERMINATE("PAW local potential error! Wrong number of spins!")
-        }
-    }
-
-    /* save xc energy in pdd structure */
-    ppd.xc_energy_ = ae_xc_energy - ps_xc_energy;
 }
 
 inline void Potential::calc_PAW_local_Dij(paw_potential_data_t& pdd, mdarray<double, 4>& paw_dij)
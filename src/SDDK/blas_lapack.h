@@ -80,6 +80,32 @@ void FORTRAN(zgemm)(ftn_char            TRANSA,
                     ftn_len             TRANSA_len,
                     ftn_len             TRANSB_len);
 
+void FORTRAN(dsyrk)(ftn_char            UPLO,
+                    ftn_char            TRANS,
+                    ftn_int*            N,
+                    ftn_int*            K,
+                    ftn_double*         ALPHA,
+                    ftn_double*         A,
+                    ftn_int*            LDA,
+                    ftn_double*         BETA,
+                    ftn_double*         C,
+                    ftn_int*            LDC,
+                    ftn_len             UPLO_len,
+                    ftn_len             TRANS_len);
+
+void FORTRAN(zherk)(ftn_char            UPLO,
+                    ftn_char            TRANS,
+                    ftn_int*            N,
+                    ftn_int*            K,
+                    ftn_double*         ALPHA,
+                    ftn_double_complex* A,
+                    ftn_int*            LDA,
+                    ftn_double*         BETA,
+                    ftn_double_complex* C,
+                    ftn_int*            LDC,
+                    ftn_len             UPLO_len,
+                    ftn_len             TRANS_len);
+
 void FORTRAN(ssymm)(ftn_char            SIDE,
                     ftn_char            UPLO,
                     ftn_int*            M,
@@ -506,6 +506,18 @@ class Communicator
 #endif
     }
 
+    template <typename T>
+    void send(T const* buffer__, int count__, int dest__, int tag__) const
+    {
+#if defined(__GPU_NVTX_MPI)
+        acc::begin_range_marker("MPI_Send");
+#endif
+        CALL_MPI(MPI_Send, (buffer__, count__, mpi_type_wrapper<T>::kind(), dest__, tag__, mpi_comm_));
+#if defined(__GPU_NVTX_MPI)
+        acc::end_range_marker();
+#endif
+    }
+
     template <typename T>
     void recv(T* buffer__, int count__, int source__, int tag__) const
     {
@@ -160,6 +160,34 @@ class FFT3D
         /// Position of z-columns inside 2D FFT buffer.
         mdarray<int, 2> z_col_pos_;
 
+        /// True if the CPU xy-transforms are restricted to the x-lines populated by the z-columns.
+        bool is_xy_pruned_{false};
+
+        /// Contiguous ranges of populated x-lines stored as pairs of {first x index, number of x-lines}.
+        std::vector<std::pair<int, int>> x_ranges_;
+
+        /// Backward y-transforms of each range of populated x-lines.
+        std::vector<fftw_plan> plan_backward_y_;
+
+        /// Forward y-transforms of each range of populated x-lines.
+        std::vector<fftw_plan> plan_forward_y_;
+
+        /// Backward x-transforms of all y-lines of the xy-plane.
+        fftw_plan plan_backward_x_;
+
+        /// Forward x-transforms of all y-lines of the xy-plane.
+        fftw_plan plan_forward_x_;
+
+        /// Complex-to-real xy-transform of the half xy-plane.
+        fftw_plan plan_backward_xy_c2r_;
+
+        /// Real-to-complex xy-transform to the half xy-plane.
+        fftw_plan plan_forward_xy_r2c_;
+
+        /// Positions of z-columns and their {-x, -y} partners inside the half xy-plane of the real transform.
+        /** Negative value means that the position falls outside of the half plane {0 <= x <= size_x / 2}. */
+        mdarray<int, 2> z_col_pos_half_;
+
         memory_t host_memory_type_;
 
         /// Maximum number of z-columns ever transformed.
@@ -458,6 +486,39 @@ class FFT3D
             }
         }
 
+        /// Execute pruned 2D FFT of a single xy-plane of the main FFT buffer in place.
+        /** In the backward direction the 1D y-transforms are done only for the populated x-lines (all other x-lines
+         *  are zero) followed by the full set of x-transforms. In the forward direction the x-transforms are done first
+         *  and the y-transforms are only done for the populated x-lines, which are the only ones needed to get the
+         *  values of the z-columns. */
+        template <int direction>
+        inline void transform_xy_plane_pruned(double_complex* plane__)
+        {
+            switch (direction) {
+                case 1: {
+                    for (size_t r = 0; r < x_ranges_.size(); r++) {
+                        auto ptr = reinterpret_cast<fftw_complex*>(plane__ + x_ranges_[r].first);
+                        fftw_execute_dft(plan_backward_y_[r], ptr, ptr);
+                    }
+                    fftw_execute_dft(plan_backward_x_, reinterpret_cast<fftw_complex*>(plane__),
+                                     reinterpret_cast<fftw_complex*>(plane__));
+                    break;
+                }
+                case -1: {
+                    fftw_execute_dft(plan_forward_x_, reinterpret_cast<fftw_complex*>(plane__),
+                                     reinterpret_cast<fftw_complex*>(plane__));
+                    for (size_t r = 0; r < x_ranges_.size(); r++) {
+                        auto ptr = reinterpret_cast<fftw_complex*>(plane__ + x_ranges_[r].first);
+                        fftw_execute_dft(plan_forward_y_[r], ptr, ptr);
+                    }
+                    break;
+                }
+                default: {
+                    TERMINATE("wrong direction");
+                }
+            }
+        }
+
         /// Apply 2D FFT transformation to z-columns of one complex function.
         template <int direction>
         void transform_xy(mdarray<double_complex, 1>& fft_buffer_aux__)
@@ -506,7 +567,41 @@ class FFT3D
             }
             #endif
 
-            if (pu_ == CPU) {
+            if (pu_ == CPU && is_xy_pruned_) {
+                #pragma omp parallel for schedule(static)
+                for (int iz = 0; iz < local_size_z_; iz++) {
+                    /* xy-plane is transformed in place in the main FFT buffer */
+                    auto plane = &fft_buffer_[iz * size_xy];
+                    switch (direction) {
+                        case 1: {
+                            std::fill(plane, plane + size_xy, 0);
+                            /* load z-columns into proper location */
+                            for (int i = 0; i < gvec_partition_->gvec().num_zcol(); i++) {
+                                plane[z_col_pos_(i, 0)] = fft_buffer_aux__[iz + i * local_size_z_];
+
+                                if (is_reduced && i) {
+                                    plane[z_col_pos_(i, 1)] = std::conj(plane[z_col_pos_(i, 0)]);
+                                }
+                            }
+                            transform_xy_plane_pruned<1>(plane);
+                            break;
+                        }
+                        case -1: {
+                            transform_xy_plane_pruned<-1>(plane);
+                            /* get z-columns */
+                            for (int i = 0; i < gvec_partition_->gvec().num_zcol(); i++) {
+                                fft_buffer_aux__[iz  + i * local_size_z_] = plane[z_col_pos_(i, 0)];
+                            }
+                            break;
+                        }
+                        default: {
+                            TERMINATE("wrong direction");
+                        }
+                    }
+                }
+            }
+
+            if (pu_ == CPU && !is_xy_pruned_) {
                 #pragma omp parallel
                 {
                     int tid = omp_get_thread_num();
@@ -608,7 +703,52 @@ class FFT3D
             }
             #endif
 
-            if (pu_ == CPU) {
+            if (pu_ == CPU && is_xy_pruned_) {
+                #pragma omp parallel for schedule(static)
+                for (int iz = 0; iz < local_size_z_; iz++) {
+                    /* xy-plane is transformed in place in the main FFT buffer */
+                    auto plane = &fft_buffer_[iz * size_xy];
+                    switch (direction) {
+                        case 1: {
+                            std::fill(plane, plane + size_xy, 0);
+
+                            /* load first z-column into proper location */
+                            plane[z_col_pos_(0, 0)] = fft_buffer_aux1__[iz] + double_complex(0, 1) * fft_buffer_aux2__[iz];
+
+                            /* load remaining z-columns into proper location */
+                            for (int i = 1; i < gvec_partition_->gvec().num_zcol(); i++) {
+                                /* {x, y} part */
+                                plane[z_col_pos_(i, 0)] = fft_buffer_aux1__[iz + i * local_size_z_] +
+                                    double_complex(0, 1) * fft_buffer_aux2__[iz + i * local_size_z_];
+
+                                /* {-x, -y} part */
+                                plane[z_col_pos_(i, 1)] = std::conj(fft_buffer_aux1__[iz + i * local_size_z_]) +
+                                    double_complex(0, 1) * std::conj(fft_buffer_aux2__[iz + i * local_size_z_]);
+                            }
+                            transform_xy_plane_pruned<1>(plane);
+                            break;
+                        }
+                        case -1: {
+                            transform_xy_plane_pruned<-1>(plane);
+
+                            /* get z-columns */
+                            for (int i = 0; i < gvec_partition_->gvec().num_zcol(); i++) {
+                                fft_buffer_aux1__[iz  + i * local_size_z_] = 0.5 *
+                                    (plane[z_col_pos_(i, 0)] + std::conj(plane[z_col_pos_(i, 1)]));
+
+                                fft_buffer_aux2__[iz  + i * local_size_z_] = double_complex(0, -0.5) *
+                                    (plane[z_col_pos_(i, 0)] - std::conj(plane[z_col_pos_(i, 1)]));
+                            }
+                            break;
+                        }
+                        default: {
+                            TERMINATE("wrong direction");
+                        }
+                    }
+                }
+            }
+
+            if (pu_ == CPU && !is_xy_pruned_) {
                 #pragma omp parallel
                 {
                     int tid = omp_get_thread_num();
@@ -669,6 +809,95 @@ class FFT3D
             }
         }
 
+        /// Apply 2D real-to-complex or complex-to-real FFT transformation to z-columns of one real function.
+        /** Only the half xy-plane {0 <= x <= size_x / 2} is transformed and the real-space values are stored directly
+         *  in the output array. In the backward direction the z-columns are symmetrized as
+         *  \f$ \frac{1}{2}(f(G_x, G_y, z) + f^{*}(-G_x, -G_y, z)) \f$, so the result is equal to the real part
+         *  of the complex transform. */
+        template <int direction>
+        void transform_xy_real(mdarray<double_complex, 1>& fft_buffer_aux__, double* f_rg__)
+        {
+            PROFILE("sddk::FFT3D::transform_xy_real");
+
+            int size_xy = grid_.size(0) * grid_.size(1);
+            int size_xy_half = (grid_.size(0) / 2 + 1) * grid_.size(1);
+
+            int is_reduced = gvec_partition_->gvec().reduced();
+
+            #pragma omp parallel
+            {
+                int tid = omp_get_thread_num();
+                auto buf = reinterpret_cast<fftw_complex*>(fftw_buffer_xy_[tid]);
+                #pragma omp for schedule(static)
+                for (int iz = 0; iz < local_size_z_; iz++) {
+                    switch (direction) {
+                        case 1: {
+                            /* clear half xy-buffer */
+                            std::fill(fftw_buffer_xy_[tid], fftw_buffer_xy_[tid] + size_xy_half, 0);
+                            /* load z-columns into proper location */
+                            for (int i = 0; i < gvec_partition_->gvec().num_zcol(); i++) {
+                                auto z = fft_buffer_aux__[iz + i * local_size_z_];
+                                if (is_reduced) {
+                                    if (z_col_pos_half_(i, 0) >= 0) {
+                                        fftw_buffer_xy_[tid][z_col_pos_half_(i, 0)] = z;
+                                    }
+                                    if (i && z_col_pos_half_(i, 1) >= 0) {
+                                        fftw_buffer_xy_[tid][z_col_pos_half_(i, 1)] = std::conj(z);
+                                    }
+                                } else {
+                                    if (z_col_pos_half_(i, 0) >= 0) {
+                                        fftw_buffer_xy_[tid][z_col_pos_half_(i, 0)] += 0.5 * z;
+                                    }
+                                    if (z_col_pos_half_(i, 1) >= 0) {
+                                        fftw_buffer_xy_[tid][z_col_pos_half_(i, 1)] += 0.5 * std::conj(z);
+                                    }
+                                }
+                            }
+                            /* execute local FFT transform */
+                            fftw_execute_dft_c2r(plan_backward_xy_c2r_, buf, &f_rg__[iz * size_xy]);
+                            break;
+                        }
+                        case -1: {
+                            /* execute local FFT transform */
+                            fftw_execute_dft_r2c(plan_forward_xy_r2c_, &f_rg__[iz * size_xy], buf);
+                            /* get z-columns; the ones outside of the half plane are restored by symmetry */
+                            for (int i = 0; i < gvec_partition_->gvec().num_zcol(); i++) {
+                                if (z_col_pos_half_(i, 0) >= 0) {
+                                    fft_buffer_aux__[iz + i * local_size_z_] = fftw_buffer_xy_[tid][z_col_pos_half_(i, 0)];
+                                } else {
+                                    fft_buffer_aux__[iz + i * local_size_z_] = std::conj(fftw_buffer_xy_[tid][z_col_pos_half_(i, 1)]);
+                                }
+                            }
+                            break;
+                        }
+                        default: {
+                            TERMINATE("wrong direction");
+                        }
+                    }
+                }
+            }
+        }
+
+        /// Reallocate the auxiliary buffer for the z-columns if needed.
+        inline void reallocate_aux_buffer(mdarray<double_complex, 1>& fft_buffer_aux__, std::string label__)
+        {
+            size_t sz_max;
+            if (comm_.size() > 1) {
+                int rank = comm_.rank();
+                int num_zcol_local = gvec_partition_->zcol_count_fft(rank);
+                /* we need this buffer size for mpi_alltoall */
+                sz_max = std::max(grid_.size(2) * num_zcol_local, local_size());
+            } else {
+                sz_max = grid_.size(2) * gvec_partition_->gvec().num_zcol();
+            }
+            if (sz_max > fft_buffer_aux__.size()) {
+                fft_buffer_aux__ = mdarray<double_complex, 1>(sz_max, host_memory_type_, label__);
+                if (pu_ == GPU) {
+                    fft_buffer_aux__.allocate(memory_t::device);
+                }
+            }
+        }
+
     public:
 
         /// Constructor.
@@ -720,6 +949,18 @@ class FFT3D
                                                         (fftw_complex*)fftw_buffer_xy_[i], FFTW_BACKWARD, FFTW_ESTIMATE);
             }
 
+            /* real transforms are executed out of place between the thread buffers and the xy-planes of
+             * the real-space array, so the alignment of the output is not guaranteed */
+            {
+                int dims_xy[] = {grid_.size(1), grid_.size(0)};
+                auto rbuf = (double*)fftw_malloc(grid_.size(0) * grid_.size(1) * sizeof(double));
+                plan_backward_xy_c2r_ = fftw_plan_many_dft_c2r(2, dims_xy, 1, (fftw_complex*)fftw_buffer_xy_[0], NULL, 1, 0,
+                                                               rbuf, NULL, 1, 0, FFTW_ESTIMATE | FFTW_UNALIGNED);
+                plan_forward_xy_r2c_ = fftw_plan_many_dft_r2c(2, dims_xy, 1, rbuf, NULL, 1, 0, (fftw_complex*)fftw_buffer_xy_[0],
+                                                              NULL, 1, 0, FFTW_ESTIMATE | FFTW_UNALIGNED);
+                fftw_free(rbuf);
+            }
+
             #ifdef __GPU
             if (pu_ == GPU) {
 
@@ -773,6 +1014,8 @@ class FFT3D
                 fftw_destroy_plan(plan_backward_z_[i]);
                 fftw_destroy_plan(plan_backward_xy_[i]);
             }
+            fftw_destroy_plan(plan_backward_xy_c2r_);
+            fftw_destroy_plan(plan_forward_xy_r2c_);
             #ifdef __GPU
             if (pu_ == GPU) {
                 cufft::destroy_plan_handle(cufft_plan_xy_);
@@ -928,6 +1171,61 @@ class FFT3D
             }
             t1.stop();
 
+            /* positions of z-columns inside the half xy-plane of the real transform */
+            z_col_pos_half_ = mdarray<int, 2>(gvec__.gvec().num_zcol(), 2, memory_t::host, "FFT3D.z_col_pos_half_");
+            #pragma omp parallel for schedule(static)
+            for (int i = 0; i < gvec__.gvec().num_zcol(); i++) {
+                int x = z_col_pos_(i, 0) % grid_.size(0);
+                int y = z_col_pos_(i, 0) / grid_.size(0);
+                /* position of the {-x, -y} partner */
+                int x1 = (grid_.size(0) - x) % grid_.size(0);
+                int y1 = (grid_.size(1) - y) % grid_.size(1);
+                int nxh = grid_.size(0) / 2 + 1;
+                z_col_pos_half_(i, 0) = (x < nxh) ? x + y * nxh : -1;
+                z_col_pos_half_(i, 1) = (x1 < nxh) ? x1 + y1 * nxh : -1;
+            }
+
+            if (pu_ == CPU && local_size_z_ > 0) {
+                /* find the x-lines populated by z-columns */
+                std::vector<int> is_populated(grid_.size(0), 0);
+                for (int i = 0; i < gvec__.gvec().num_zcol(); i++) {
+                    for (int k = 0; k < nc; k++) {
+                        is_populated[z_col_pos_(i, k) % grid_.size(0)] = 1;
+                    }
+                }
+                x_ranges_.clear();
+                for (int x = 0; x < grid_.size(0); x++) {
+                    if (is_populated[x]) {
+                        if (x == 0 || !is_populated[x - 1]) {
+                            x_ranges_.push_back(std::make_pair(x, 0));
+                        }
+                        x_ranges_.back().second++;
+                    }
+                }
+                /* pruning pays off only if some of the x-lines are empty */
+                int num_x = std::accumulate(is_populated.begin(), is_populated.end(), 0);
+                is_xy_pruned_ = (num_x < grid_.size(0));
+
+                if (is_xy_pruned_) {
+                    int size_x = grid_.size(0);
+                    int size_y = grid_.size(1);
+                    /* plans are executed on different xy-planes of the FFT buffer, so the alignment is not guaranteed;
+                     * the buffer is not overwritten with the FFTW_ESTIMATE flag */
+                    auto buf = reinterpret_cast<fftw_complex*>(fft_buffer_.at<CPU>());
+                    unsigned int flags = FFTW_ESTIMATE | FFTW_UNALIGNED;
+                    for (auto& r: x_ranges_) {
+                        plan_backward_y_.push_back(fftw_plan_many_dft(1, &size_y, r.second, buf, NULL, size_x, 1, buf, NULL,
+                                                                      size_x, 1, FFTW_BACKWARD, flags));
+                        plan_forward_y_.push_back(fftw_plan_many_dft(1, &size_y, r.second, buf, NULL, size_x, 1, buf, NULL,
+                                                                     size_x, 1, FFTW_FORWARD, flags));
+                    }
+                    plan_backward_x_ = fftw_plan_many_dft(1, &size_x, size_y, buf, NULL, 1, size_x, buf, NULL, 1, size_x,
+                                                          FFTW_BACKWARD, flags);
+                    plan_forward_x_  = fftw_plan_many_dft(1, &size_x, size_y, buf, NULL, 1, size_x, buf, NULL, 1, size_x,
+                                                          FFTW_FORWARD, flags);
+                }
+            }
+
             #ifdef __GPU
             if (pu_ == GPU) {
                 sddk::timer t2("sddk::FFT3D::prepare|gpu");
@@ -1008,6 +1306,17 @@ class FFT3D
 
         void dismiss()
         {
+            if (is_xy_pruned_) {
+                for (size_t r = 0; r < x_ranges_.size(); r++) {
+                    fftw_destroy_plan(plan_backward_y_[r]);
+                    fftw_destroy_plan(plan_forward_y_[r]);
+                }
+                plan_backward_y_.clear();
+                plan_forward_y_.clear();
+                fftw_destroy_plan(plan_backward_x_);
+                fftw_destroy_plan(plan_forward_x_);
+                is_xy_pruned_ = false;
+            }
             if (pu_ == GPU) {
                 fft_buffer_aux1_.deallocate(memory_t::device);
                 fft_buffer_aux2_.deallocate(memory_t::device);
@@ -1033,21 +1342,7 @@ class FFT3D
             }
 
             /* reallocate auxiliary buffer if needed */
-            size_t sz_max;
-            if (comm_.size() > 1) {
-                int rank = comm_.rank();
-                int num_zcol_local = gvec_partition_->zcol_count_fft(rank);
-                /* we need this buffer size for mpi_alltoall */
-                sz_max = std::max(grid_.size(2) * num_zcol_local, local_size());
-            } else {
-                sz_max = grid_.size(2) * gvec_partition_->gvec().num_zcol();
-            }
-            if (sz_max > fft_buffer_aux1_.size()) {
-                fft_buffer_aux1_ = mdarray<double_complex, 1>(sz_max, host_memory_type_, "fft_buffer_aux1_");
-                if (pu_ == GPU) {
-                    fft_buffer_aux1_.allocate(memory_t::device);
-                }
-            }
+            reallocate_aux_buffer(fft_buffer_aux1_, "fft_buffer_aux1_");
 
             switch (direction) {
                 case 1: {
@@ -1066,6 +1361,44 @@ class FFT3D
             }
         }
 
+        /// Transform a single real function.
+        /** PW coefficients of a real function are transformed to the real-space values, which are stored in the
+         *  array \p f_rg__ of the size local_size() (and vice versa for the forward transform). Only half of each
+         *  xy-plane is transformed using the real-to-complex (complex-to-real) FFTs and the main FFT buffer is not
+         *  touched in the serial case. This is a CPU-only transform. */
+        template <int direction>
+        void transform(double_complex* data__, double* f_rg__)
+        {
+            PROFILE("sddk::FFT3D::transform_real");
+
+            if (!gvec_partition_) {
+                TERMINATE("FFT3D is not ready");
+            }
+
+            if (pu_ != CPU) {
+                TERMINATE("real transform is implemented only for CPU");
+            }
+
+            /* reallocate auxiliary buffer if needed */
+            reallocate_aux_buffer(fft_buffer_aux1_, "fft_buffer_aux1_");
+
+            switch (direction) {
+                case 1: {
+                    transform_z<direction, CPU>(data__, fft_buffer_aux1_);
+                    transform_xy_real<direction>(fft_buffer_aux1_, f_rg__);
+                    break;
+                }
+                case -1: {
+                    transform_xy_real<direction>(fft_buffer_aux1_, f_rg__);
+                    transform_z<direction, CPU>(data__, fft_buffer_aux1_);
+                    break;
+                }
+                default: {
+                    TERMINATE("wrong direction");
+                }
+            }
+        }
+
         /// Transform two real functions.
         template <int direction, device_t data_ptr_type = CPU>
         void transform(double_complex* data1__, double_complex* data2__)
@@ -1081,28 +1414,9 @@ class FFT3D
             }
 
             /* reallocate auxiliary buffers if needed */
-            size_t sz_max;
-            if (comm_.size() > 1) {
-                int rank = comm_.rank();
-                int num_zcol_local = gvec_partition_->zcol_count_fft(rank);
-                /* we need this buffer for mpi_alltoall */
-                sz_max = std::max(grid_.size(2) * num_zcol_local, local_size());
-            } else {
-                sz_max = grid_.size(2) * gvec_partition_->gvec().num_zcol();
-            }
+            reallocate_aux_buffer(fft_buffer_aux1_, "fft_buffer_aux1_");
+            reallocate_aux_buffer(fft_buffer_aux2_, "fft_buffer_aux2_");
 
-            if (sz_max > fft_buffer_aux1_.size()) {
-                fft_buffer_aux1_ = mdarray<double_complex, 1>(sz_max, host_memory_type_, "fft_buffer_aux1_");
-                if (pu_ == GPU) {
-                    fft_buffer_aux1_.allocate(memory_t::device);
-                }
-            }
-            if (sz_max > fft_buffer_aux2_.size()) {
-                fft_buffer_aux2_ = mdarray<double_complex, 1>(sz_max, host_memory_type_, "fft_buffer_aux2_");
-                if (pu_ == GPU) {
-                    fft_buffer_aux2_.allocate(memory_t::device);
-                }
-            }
             switch (direction) {
                 case 1: {
                     transform_z<direction, data_ptr_type>(data1__, fft_buffer_aux1_);
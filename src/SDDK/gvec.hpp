@@ -221,7 +221,19 @@ class Gvec
     }
 
     /// Distribute z-columns between MPI ranks.
-    inline void distribute_z_columns()
+    /** The FFT work of a rank is modelled as the number of local G-vectors (packing and unpacking of the
+     *  PW coefficients) plus the number of points in the local z-columns (z-transforms and the all-to-all
+     *  exchange of the full columns). Both are streaming passes over complex numbers, so one G-vector and one
+     *  point of a z-column are given the same unit weight: a z-column costs zcol_length points in the z-transform
+     *  and in the exchange no matter how many G-vectors it holds, which is why many short columns are not cheaper
+     *  than a few long ones with the same number of G-vectors. Columns are sorted by size and each is given to the
+     *  rank with the currently lowest cost; the cost difference between ranks is then bounded by the cost of a
+     *  single column (checked in apps/unit_tests/test_gvec_distr.cpp). Columns of the base G-vector set keep their
+     *  ranks, so coarse and dense G-vectors are remapped locally, and the remaining columns are used to balance the
+     *  total cost.
+     *
+     *  \param [in] zcol_length Size of the z-dimension of the FFT grid. */
+    inline void distribute_z_columns(int zcol_length__)
     {
         gvec_distr_ = block_data_descriptor(comm().size());
         zcol_distr_ = block_data_descriptor(comm().size());
@@ -243,28 +255,30 @@ class Gvec
             }
         }
 
+        /* estimated FFT cost of a rank */
+        auto cost = [this, zcol_length__](int rank)
+        {
+            return static_cast<double>(gvec_distr_.counts[rank]) +
+                   static_cast<double>(zcol_distr_.counts[rank]) * zcol_length__;
+        };
+
         int n = (gvec_base_) ? gvec_base_->num_zcol() : 0;
 
-        std::vector<int> ranks;
         for (int i = n; i < static_cast<int>(z_columns_.size()); i++) {
-            /* initialize the list of ranks to 0,1,2,... */
-            if (ranks.empty()) {
-                ranks.resize(comm().size());
-                std::iota(ranks.begin(), ranks.end(), 0);
+            /* find rank with minimum cost; first rank wins the ties and gets the {0, 0} column */
+            int rank_min_cost{0};
+            for (int rank = 1; rank < comm().size(); rank++) {
+                if (cost(rank) < cost(rank_min_cost)) {
+                    rank_min_cost = rank;
+                }
             }
-            /* find rank with minimum number of G-vectors */
-            auto rank_with_min_gvec = std::min_element(ranks.begin(), ranks.end(), [this](const int& a, const int& b) {
-                return gvec_distr_.counts[a] < gvec_distr_.counts[b];
-            });
 
             /* assign column to the found rank */
-            zcols_local[*rank_with_min_gvec].push_back(z_columns_[i]);
+            zcols_local[rank_min_cost].push_back(z_columns_[i]);
             /* count local number of z-columns */
-            zcol_distr_.counts[*rank_with_min_gvec] += 1;
+            zcol_distr_.counts[rank_min_cost] += 1;
             /* count local number of G-vectors */
-            gvec_distr_.counts[*rank_with_min_gvec] += static_cast<int>(z_columns_[i].z.size());
-            /* exclude this rank from the search */
-            ranks.erase(rank_with_min_gvec);
+            gvec_distr_.counts[rank_min_cost] += static_cast<int>(z_columns_[i].z.size());
         }
         gvec_distr_.calc_offsets();
         zcol_distr_.calc_offsets();
@@ -336,7 +350,7 @@ class Gvec
 
         find_z_columns(Gmax_, fft_grid);
 
-        distribute_z_columns();
+        distribute_z_columns(fft_grid.size(2));
 
         gvec_index_by_xy_ = mdarray<int, 3>(2, fft_grid.limits(0), fft_grid.limits(1), memory_t::host, "Gvec.gvec_index_by_xy_");
         std::fill(gvec_index_by_xy_.at<CPU>(), gvec_index_by_xy_.at<CPU>() + gvec_index_by_xy_.size(), -1);
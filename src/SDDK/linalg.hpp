@@ -109,6 +109,12 @@ class linalg<CPU>: public linalg_base
             gemm(transa, transb, m, n, k, A.template at<CPU>(), A.ld(), B.template at<CPU>(), B.ld(), C.template at<CPU>(), C.ld());
         }
                          
+        /// Rank-k update of the upper triangular part of Hermitian (or real symmetric) matrix.
+        /** Compute C = alpha * A^{+} * A + beta * C, where A is a k x n matrix (syrk in case of real matrices). */
+        template <typename T>
+        static void herk(ftn_int n, ftn_int k, ftn_double alpha, T const* A, ftn_int lda, ftn_double beta, T* C,
+                         ftn_int ldc);
+
         /// Compute C = alpha * op(A) * op(B) + beta * op(C), generic interface
         template <typename T>
         static void gemm(int transa, int transb, ftn_int m, ftn_int n, ftn_int k, T alpha, 
@@ -205,6 +211,10 @@ class linalg<CPU>: public linalg_base
 
         template <typename T>
         static void geqrf(ftn_int m, ftn_int n, dmatrix<T>& A, ftn_int ia, ftn_int ja);
+
+        /// QR factorization of a local matrix; upper triangle of A contains R on exit.
+        template <typename T>
+        static ftn_int geqrf(ftn_int m, ftn_int n, T* A, ftn_int lda);
 };
 
 #ifdef __GPU
@@ -294,6 +304,48 @@ inline void linalg<CPU>::gemm<ftn_double_complex>(int transa, int transb, ftn_in
                    (ftn_len)1, (ftn_len)1);
 }
 
+// C = alpha * op(A) * op(B) + beta * op(C), complex
+template<>
+inline void linalg<CPU>::gemm<ftn_complex>(int transa, int transb, ftn_int m, ftn_int n, ftn_int k,
+                                           ftn_complex alpha,
+                                           ftn_complex const* A, ftn_int lda,
+                                           ftn_complex const* B, ftn_int ldb,
+                                           ftn_complex beta,
+                                           ftn_complex* C, ftn_int ldc)
+{
+    assert(lda != 0);
+    assert(ldb != 0);
+    assert(ldc != 0);
+
+    const char *trans[] = {"N", "T", "C"};
+
+    FORTRAN(cgemm)(trans[transa], trans[transb], &m, &n, &k, &alpha, const_cast<ftn_complex*>(A), &lda, const_cast<ftn_complex*>(B), &ldb, &beta, C, &ldc,
+                   (ftn_len)1, (ftn_len)1);
+}
+
+// C = alpha * A^{T} * A + beta * C, double
+template<>
+inline void linalg<CPU>::herk<ftn_double>(ftn_int n, ftn_int k, ftn_double alpha, ftn_double const* A, ftn_int lda,
+                                          ftn_double beta, ftn_double* C, ftn_int ldc)
+{
+    assert(lda != 0);
+    assert(ldc != 0);
+
+    FORTRAN(dsyrk)("U", "T", &n, &k, &alpha, const_cast<ftn_double*>(A), &lda, &beta, C, &ldc, (ftn_len)1, (ftn_len)1);
+}
+
+// C = alpha * A^{+} * A + beta * C, double_complex
+template<>
+inline void linalg<CPU>::herk<ftn_double_complex>(ftn_int n, ftn_int k, ftn_double alpha, ftn_double_complex const* A,
+                                                  ftn_int lda, ftn_double beta, ftn_double_complex* C, ftn_int ldc)
+{
+    assert(lda != 0);
+    assert(ldc != 0);
+
+    FORTRAN(zherk)("U", "C", &n, &k, &alpha, const_cast<ftn_double_complex*>(A), &lda, &beta, C, &ldc, (ftn_len)1,
+                   (ftn_len)1);
+}
+
 
 template<>
 inline void linalg<CPU>::gemv<ftn_double_complex>(int trans,
@@ -602,6 +654,34 @@ inline ftn_int linalg<CPU>::trtri<ftn_double_complex>(ftn_int n, ftn_double_comp
     return info;
 }
 
+template <>
+inline ftn_int linalg<CPU>::geqrf<ftn_double>(ftn_int m, ftn_int n, ftn_double* A, ftn_int lda)
+{
+    ftn_int lwork = -1;
+    ftn_double z;
+    ftn_int info;
+    FORTRAN(dgeqrf)(&m, &n, A, &lda, &z, &z, &lwork, &info);
+    lwork = static_cast<int>(z + 1);
+    std::vector<ftn_double> work(lwork);
+    std::vector<ftn_double> tau(std::max(1, std::min(m, n)));
+    FORTRAN(dgeqrf)(&m, &n, A, &lda, tau.data(), work.data(), &lwork, &info);
+    return info;
+}
+
+template <>
+inline ftn_int linalg<CPU>::geqrf<ftn_double_complex>(ftn_int m, ftn_int n, ftn_double_complex* A, ftn_int lda)
+{
+    ftn_int lwork = -1;
+    ftn_double_complex z;
+    ftn_int info;
+    FORTRAN(zgeqrf)(&m, &n, A, &lda, &z, &z, &lwork, &info);
+    lwork = static_cast<int>(z.real() + 1);
+    std::vector<ftn_double_complex> work(lwork);
+    std::vector<ftn_double_complex> tau(std::max(1, std::min(m, n)));
+    FORTRAN(zgeqrf)(&m, &n, A, &lda, tau.data(), work.data(), &lwork, &info);
+    return info;
+}
+
 template <>
 inline void linalg<CPU>::trmm<ftn_double>(char side, char uplo, char transa, ftn_int m, ftn_int n, ftn_double alpha,
                                           ftn_double* A, ftn_int lda, ftn_double* B, ftn_int ldb)
@@ -29,6 +29,7 @@
 #include <vector>
 #include <sstream>
 #include <limits>
+#include <numeric>
 
 namespace sddk {
 
@@ -445,6 +446,30 @@ class splindex<chunk, T> : public splindex_base<T>
     }
 };
 
+/// Split a list of elements into contiguous chunks of approximately equal cost.
+/** Returns the number of elements for each rank, to be used in splindex<chunk>. */
+inline std::vector<int> split_by_cost(std::vector<double> const& cost__, int num_ranks__)
+{
+    int n = static_cast<int>(cost__.size());
+
+    double total_cost = std::accumulate(cost__.begin(), cost__.end(), 0.0);
+
+    std::vector<int> counts(num_ranks__, 0);
+    int r{0};
+    double acc{0};
+    for (int i = 0; i < n; i++) {
+        /* move to the next rank if the midpoint of this element is past the cost target of the current rank
+         * or if the remaining elements are just enough to give one element to each of the remaining ranks */
+        if (r < num_ranks__ - 1 && counts[r] > 0 &&
+            (acc + 0.5 * cost__[i] > (r + 1) * total_cost / num_ranks__ || n - i <= num_ranks__ - r - 1)) {
+            r++;
+        }
+        counts[r]++;
+        acc += cost__[i];
+    }
+    return counts;
+}
+
 } // namespace sddk
 
 #endif // __SPLINDEX_HPP__
@@ -27,6 +27,7 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <fstream>
 #include "linalg.hpp"
 #include "eigenproblem.h"
 #include "hdf5_tree.hpp"
@@ -48,6 +49,72 @@ const int sddk_default_block_size = 256;
 
 namespace sddk {
 
+/// Precision of the local matrix-matrix multiplications in inner() and transform().
+/** Wave-functions are always stored in double precision. In case of fp32 the local panels of the wave-functions
+ *  are rounded to single precision, multiplied with cgemm and the result is accumulated in double precision.
+ *  This is used by the iterative solvers far from convergence and only for the complex wave-functions on CPU. */
+enum class linalg_precision_t
+{
+    fp64,
+    fp32
+};
+
+/// Local matrix-matrix multiplication \f$ C = \alpha\, op(A) B + \beta C \f$ of complex matrices in single precision.
+/** Matrices A and B are rounded to single precision, multiplied with cgemm and the product is added to the
+ *  double precision matrix C. Parameter transa__ has the same meaning as in linalg<CPU>::gemm(). */
+inline void gemm_fp32(int                   transa__,
+                      int                   m__,
+                      int                   n__,
+                      int                   k__,
+                      double_complex        alpha__,
+                      double_complex const* A__,
+                      int                   lda__,
+                      double_complex const* B__,
+                      int                   ldb__,
+                      double_complex        beta__,
+                      double_complex*       C__,
+                      int                   ldc__)
+{
+    if (m__ == 0 || n__ == 0) {
+        return;
+    }
+    /* dimensions of A */
+    int nra = (transa__ == 0) ? m__ : k__;
+    int nca = (transa__ == 0) ? k__ : m__;
+
+    std::vector<ftn_complex> c(static_cast<size_t>(m__) * n__, ftn_complex(0, 0));
+
+    if (k__ > 0) {
+        std::vector<ftn_complex> a(static_cast<size_t>(nra) * nca);
+        std::vector<ftn_complex> b(static_cast<size_t>(k__) * n__);
+
+        #pragma omp parallel for schedule(static)
+        for (int j = 0; j < nca; j++) {
+            for (int i = 0; i < nra; i++) {
+                a[i + static_cast<size_t>(nra) * j] = ftn_complex(A__[i + static_cast<size_t>(lda__) * j]);
+            }
+        }
+        #pragma omp parallel for schedule(static)
+        for (int j = 0; j < n__; j++) {
+            for (int i = 0; i < k__; i++) {
+                b[i + static_cast<size_t>(k__) * j] = ftn_complex(B__[i + static_cast<size_t>(ldb__) * j]);
+            }
+        }
+        linalg<CPU>::gemm(transa__, 0, m__, n__, k__, ftn_complex(1, 0), a.data(), nra, b.data(), k__,
+                          ftn_complex(0, 0), c.data(), m__);
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (int j = 0; j < n__; j++) {
+        for (int i = 0; i < m__; i++) {
+            double_complex z = alpha__ * double_complex(c[i + static_cast<size_t>(m__) * j]);
+            /* don't touch the uninitialized output if beta is zero */
+            size_t ij = i + static_cast<size_t>(ldc__) * j;
+            C__[ij] = (beta__ == 0.0) ? z : beta__ * C__[ij] + z;
+        }
+    }
+}
+
 /// Wave-functions representation.
 /** Wave-functions consist of two parts: plane-wave part and mufin-tin part. Both are the matrix_storage objects
  *  with the slab distribution. Wave-functions have one or two spin components. In case of collinear magnetism
@@ -93,6 +160,9 @@ class Wave_functions
 
     bool has_mt_{false};
 
+    /// True if the host part of wave-functions is released and stored in a file.
+    bool is_offloaded_{false};
+
     /// Lower boundary for the spin component index by spin index.
     inline int s0(int ispn__) const
     {
@@ -491,6 +561,95 @@ class Wave_functions
         return std::move(norm);
     }
 
+    /// Write the host part of wave-functions to a binary file and release the host memory.
+    /** Coefficients are stored in the order of spin components with plane-wave part followed by the muffin-tin part.
+     *  If single_precision__ is true the coefficients are rounded to complex<float> which halves the file size. */
+    inline void offload(std::string const& fname__, bool single_precision__)
+    {
+        PROFILE("sddk::Wave_functions::offload");
+
+        if (is_offloaded_) {
+            return;
+        }
+        std::ofstream ofs(fname__, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!ofs) {
+            TERMINATE("failed to open " + fname__ + " for writing");
+        }
+        int sp = single_precision__ ? 1 : 0;
+        ofs.write(reinterpret_cast<char const*>(&sp), sizeof(int));
+        std::vector<std::complex<float>> buf(single_precision__ ? std::max(pw_coeffs(0).num_rows_loc(), num_mt_coeffs()) : 0);
+        for (int s = 0; s < num_sc_; s++) {
+            for (auto e: {pw_coeffs_[s].get(), mt_coeffs_[s].get()}) {
+                if (e == nullptr) {
+                    continue;
+                }
+                auto& prime = e->prime();
+                int nr = e->num_rows_loc();
+                for (int i = 0; i < num_wf_ && nr; i++) {
+                    if (single_precision__) {
+                        for (int j = 0; j < nr; j++) {
+                            buf[j] = std::complex<float>(prime(j, i));
+                        }
+                        ofs.write(reinterpret_cast<char const*>(&buf[0]), nr * sizeof(std::complex<float>));
+                    } else {
+                        ofs.write(reinterpret_cast<char const*>(prime.template at<CPU>(0, i)), nr * sizeof(double_complex));
+                    }
+                }
+                prime = mdarray<double_complex, 2>();
+            }
+        }
+        if (!ofs) {
+            TERMINATE("failed to write " + fname__);
+        }
+        is_offloaded_ = true;
+    }
+
+    /// Allocate the host memory and read wave-functions from the file written by offload().
+    /** This function is not profiled because it can be executed by a background prefetch thread. */
+    inline void reload(std::string const& fname__)
+    {
+        if (!is_offloaded_) {
+            return;
+        }
+        std::ifstream ifs(fname__, std::ios::in | std::ios::binary);
+        if (!ifs) {
+            TERMINATE("failed to open " + fname__ + " for reading");
+        }
+        int sp;
+        ifs.read(reinterpret_cast<char*>(&sp), sizeof(int));
+        std::vector<std::complex<float>> buf(sp ? std::max(pw_coeffs(0).num_rows_loc(), num_mt_coeffs()) : 0);
+        for (int s = 0; s < num_sc_; s++) {
+            for (auto e: {pw_coeffs_[s].get(), mt_coeffs_[s].get()}) {
+                if (e == nullptr) {
+                    continue;
+                }
+                int nr = e->num_rows_loc();
+                auto& prime = e->prime();
+                prime = mdarray<double_complex, 2>(nr, num_wf_, memory_t::host, "matrix_storage.prime_");
+                for (int i = 0; i < num_wf_ && nr; i++) {
+                    if (sp) {
+                        ifs.read(reinterpret_cast<char*>(&buf[0]), nr * sizeof(std::complex<float>));
+                        for (int j = 0; j < nr; j++) {
+                            prime(j, i) = double_complex(buf[j].real(), buf[j].imag());
+                        }
+                    } else {
+                        ifs.read(reinterpret_cast<char*>(prime.template at<CPU>(0, i)), nr * sizeof(double_complex));
+                    }
+                }
+            }
+        }
+        if (!ifs) {
+            TERMINATE("failed to read " + fname__);
+        }
+        is_offloaded_ = false;
+    }
+
+    /// Return true if the wave-functions are currently stored in a file.
+    inline bool is_offloaded() const
+    {
+        return is_offloaded_;
+    }
+
     #ifdef __GPU
     void allocate_on_device(int ispn__) {
         for (int s = s0(ispn__); s <= s1(ispn__); s++) {
@@ -22,59 +22,94 @@
  *  \brief Contains implementation of inner product for wave-functions.
  */
 
-/// Inner product between wave-functions.
-/** This function computes the inner product using a moving window scheme plus allreduce.
+/// Complex conjugate which preserves the type of a real argument.
+inline double conj_value(double x__)
+{
+    return x__;
+}
+
+inline double_complex conj_value(double_complex z__)
+{
+    return std::conj(z__);
+}
+
+/// Inner product between several pairs of wave-functions.
+/** This function computes the inner products using a moving window scheme plus non-blocking allreduce. Inner products
+ *  of all pairs of wave-functions are computed for the same window and reduced in a single MPI call. Up to four
+ *  windows are in flight at the same time.
  *  The input wave-functions data must be previously allocated on the GPU.
  *  The result is always returned in the CPU pointer. In case of a single MPI rank the result is also returned in the
  *  GPU pointer.
  *
- *  The following \f$ m \times n \f$ sub-matrix is computed:
+ *  The following \f$ m \times n \f$ sub-matrices are computed for each pair of wave-functions:
  *  \f[
- *    S_{irow0+i,jcol0+j} = \beta S_{irow0+i,jcol0+j} + \langle \phi_{i0 + i} | \tilde \phi_{j0 + j} \rangle
+ *    S_{irow0+i,jcol0+j} = \langle \phi_{i0 + i} | \tilde \phi_{j0 + j} \rangle
  *  \f]
  *
+ *  If herm is true, the "ket" wave-functions are treated as the result of a Hermitian operator applied to the
+ *  "bra" wave-functions (for example \f$ \tilde \phi = \hat H \phi \f$ or \f$ \tilde \phi = \phi \f$) and the "ket"
+ *  states must be the last \f$ n \f$ states of the "bra" block (\f$ j0 + n = i0 + m \f$). In this case the lower
+ *  triangular part of the trailing \f$ n \times n \f$ sub-block is not computed but restored from the upper part.
+ *  Diagonal sub-blocks of \f$ \langle \phi | \phi \rangle \f$ are computed with herk. This is done only on CPU.
+ *
  *  \param [in] bra   "bra" wave-functions \f$ \phi \f$.
  *  \param [in] i0    index of the first "bra" wave-function.
  *  \param [in] m     number of "bra" wave-functions.
  *  \param [in] ket   "ket" wave-functions \f$ \tilde \phi \f$.
  *  \param [in] j0    index of the first "ket" wave-function.
  *  \param [in] n     number of "ket" wave-functions.
- *  \param [in] beta  \f$ \beta \f$ parameter.
- *  \param [in,out]   result inner product matrix \f$ S \f$.
+ *  \param [in,out]   result inner product matrices \f$ S \f$.
  *  \param [in] irow0 first row (in the global matrix) of the inner product sub-matrix.
  *  \param [in] jcol0 first column (in the global matix) of the inner product sub-matrix.
+ *  \param [in] herm  true if the trailing \f$ n \times n \f$ sub-block of the result is Hermitian.
+ *  \param [in] prec  precision of the local matrix-matrix multiplication (only complex case on CPU).
  */
 template <typename T>
-inline void inner(device_t        pu__,
-                  int             ispn__,
-                  Wave_functions& bra__,
-                  int             i0__,
-                  int             m__,
-                  Wave_functions& ket__,
-                  int             j0__,
-                  int             n__,
-                  dmatrix<T>&     result__,
-                  int             irow0__,
-                  int             jcol0__)
+inline void inner(device_t                     pu__,
+                  int                          ispn__,
+                  std::vector<Wave_functions*> bra__,
+                  int                          i0__,
+                  int                          m__,
+                  std::vector<Wave_functions*> ket__,
+                  int                          j0__,
+                  int                          n__,
+                  std::vector<dmatrix<T>*>     result__,
+                  int                          irow0__,
+                  int                          jcol0__,
+                  bool                         herm__,
+                  linalg_precision_t           prec__ = linalg_precision_t::fp64)
 {
     PROFILE("sddk::wave_functions::inner");
 
     static_assert(std::is_same<T, double>::value || std::is_same<T, double_complex>::value, "wrong type");
-    
-    //assert(&bra__.comm() == &ket__.comm());
-    //assert(bra__.pw_coeffs().num_rows_loc() == ket__.pw_coeffs().num_rows_loc());
-    //if (bra__.has_mt()) {
-    //    assert(bra__.mt_coeffs().num_rows_loc() == ket__.mt_coeffs().num_rows_loc());
-    //}
 
-    auto& comm = bra__.comm();
-    
+    assert(bra__.size() == ket__.size());
+    assert(bra__.size() == result__.size());
+
+    const int npair = static_cast<int>(bra__.size());
+
+    /* GPU implementation works with a single pair of wave-functions */
+    if (pu__ == GPU && npair > 1) {
+        for (int ip = 0; ip < npair; ip++) {
+            inner<T>(pu__, ispn__, {bra__[ip]}, i0__, m__, {ket__[ip]}, j0__, n__, {result__[ip]}, irow0__, jcol0__,
+                     false, prec__);
+        }
+        return;
+    }
+
+    auto& comm = bra__[0]->comm();
+
     const char* sddk_pp_raw = std::getenv("SDDK_PRINT_PERFORMANCE");
     int sddk_pp = (sddk_pp_raw == NULL) ? 0 : std::atoi(sddk_pp_raw);
 
     const char* sddk_bs_raw = std::getenv("SDDK_BLOCK_SIZE");
     int sddk_block_size = (sddk_bs_raw == NULL) ? sddk_default_block_size : std::atoi(sddk_bs_raw);
 
+    /* use Hermitian symmetry of the result */
+    const bool herm = herm__ && (pu__ == CPU) && (j0__ >= i0__) && (j0__ + n__ == i0__ + m__);
+    /* first row of the Hermitian sub-block */
+    const int d0 = j0__ - i0__;
+
     double ngop{0};
     if (std::is_same<T, double>::value) {
         ngop = 2e-9;
@@ -82,24 +117,29 @@ inline void inner(device_t        pu__,
     if (std::is_same<T, double_complex>::value) {
         ngop = 8e-9;
     }
+    ngop *= npair;
+    if (herm) {
+        ngop *= (static_cast<double>(m__ - n__) * n__ + 0.5 * n__ * (n__ + 1)) / m__ / n__;
+    }
 
     if (sddk_pp) {
         comm.barrier();
     }
     double time = -omp_get_wtime();
 
-    //result__.zero(i0__, j0__, m__, n__);
-
     T alpha = (std::is_same<T, double_complex>::value) ? 1 : 2;
     T beta = 0;
 
-    auto local_inner = [&](int i0__,
+    auto local_inner = [&](int ip__,
+                           int i0__,
                            int m__,
                            int j0__,
                            int n__,
                            T*  buf__,
                            int ld__,
                            int stream_id){
+        auto& bra = *bra__[ip__];
+        auto& ket = *ket__[ip__];
         int s0{0};
         int s1{1};
         if (ispn__ != 2) {
@@ -111,17 +151,34 @@ inline void inner(device_t        pu__,
             if (std::is_same<T, double_complex>::value) {
                 switch (pu__) {
                     case CPU: {
-                        linalg<CPU>::gemm(2, 0, m__, n__, bra__.pw_coeffs(s).num_rows_loc(),
+                        if (prec__ == linalg_precision_t::fp32) {
+                            gemm_fp32(2, m__, n__, bra.pw_coeffs(s).num_rows_loc(),
+                                      *reinterpret_cast<double_complex*>(&alpha),
+                                      bra.pw_coeffs(s).prime().at<CPU>(0, i0__), bra.pw_coeffs(s).prime().ld(),
+                                      ket.pw_coeffs(s).prime().at<CPU>(0, j0__), ket.pw_coeffs(s).prime().ld(),
+                                      *reinterpret_cast<double_complex*>(&beta),
+                                      reinterpret_cast<double_complex*>(buf__), ld__);
+                            if (bra.has_mt()) {
+                                gemm_fp32(2, m__, n__, bra.mt_coeffs(s).num_rows_loc(),
+                                          *reinterpret_cast<double_complex*>(&alpha),
+                                          bra.mt_coeffs(s).prime().at<CPU>(0, i0__), bra.mt_coeffs(s).prime().ld(),
+                                          ket.mt_coeffs(s).prime().at<CPU>(0, j0__), ket.mt_coeffs(s).prime().ld(),
+                                          linalg_const<double_complex>::one(),
+                                          reinterpret_cast<double_complex*>(buf__), ld__);
+                            }
+                            break;
+                        }
+                        linalg<CPU>::gemm(2, 0, m__, n__, bra.pw_coeffs(s).num_rows_loc(),
                                           *reinterpret_cast<double_complex*>(&alpha),
-                                          bra__.pw_coeffs(s).prime().at<CPU>(0, i0__), bra__.pw_coeffs(s).prime().ld(),
-                                          ket__.pw_coeffs(s).prime().at<CPU>(0, j0__), ket__.pw_coeffs(s).prime().ld(),
+                                          bra.pw_coeffs(s).prime().at<CPU>(0, i0__), bra.pw_coeffs(s).prime().ld(),
+                                          ket.pw_coeffs(s).prime().at<CPU>(0, j0__), ket.pw_coeffs(s).prime().ld(),
                                           *reinterpret_cast<double_complex*>(&beta),
                                           reinterpret_cast<double_complex*>(buf__), ld__);
-                        if (bra__.has_mt()) {
-                            linalg<CPU>::gemm(2, 0, m__, n__, bra__.mt_coeffs(s).num_rows_loc(),
+                        if (bra.has_mt()) {
+                            linalg<CPU>::gemm(2, 0, m__, n__, bra.mt_coeffs(s).num_rows_loc(),
                                               *reinterpret_cast<double_complex*>(&alpha),
-                                              bra__.mt_coeffs(s).prime().at<CPU>(0, i0__), bra__.mt_coeffs(s).prime().ld(),
-                                              ket__.mt_coeffs(s).prime().at<CPU>(0, j0__), ket__.mt_coeffs(s).prime().ld(),
+                                              bra.mt_coeffs(s).prime().at<CPU>(0, i0__), bra.mt_coeffs(s).prime().ld(),
+                                              ket.mt_coeffs(s).prime().at<CPU>(0, j0__), ket.mt_coeffs(s).prime().ld(),
                                               linalg_const<double_complex>::one(),
                                               reinterpret_cast<double_complex*>(buf__), ld__);
                         }
@@ -129,18 +186,18 @@ inline void inner(device_t        pu__,
                     }
                     case GPU: {
                         #ifdef __GPU
-                        linalg<GPU>::gemm(2, 0, m__, n__, bra__.pw_coeffs(s).num_rows_loc(),
+                        linalg<GPU>::gemm(2, 0, m__, n__, bra.pw_coeffs(s).num_rows_loc(),
                                           reinterpret_cast<double_complex*>(&alpha),
-                                          bra__.pw_coeffs(s).prime().at<GPU>(0, i0__), bra__.pw_coeffs(s).prime().ld(),
-                                          ket__.pw_coeffs(s).prime().at<GPU>(0, j0__), ket__.pw_coeffs(s).prime().ld(),
+                                          bra.pw_coeffs(s).prime().at<GPU>(0, i0__), bra.pw_coeffs(s).prime().ld(),
+                                          ket.pw_coeffs(s).prime().at<GPU>(0, j0__), ket.pw_coeffs(s).prime().ld(),
                                           reinterpret_cast<double_complex*>(&beta),
                                           reinterpret_cast<double_complex*>(buf__), ld__,
                                           stream_id);
-                        if (bra__.has_mt()) {
-                            linalg<GPU>::gemm(2, 0, m__, n__, bra__.mt_coeffs(s).num_rows_loc(),
+                        if (bra.has_mt()) {
+                            linalg<GPU>::gemm(2, 0, m__, n__, bra.mt_coeffs(s).num_rows_loc(),
                                               reinterpret_cast<double_complex*>(&alpha),
-                                              bra__.mt_coeffs(s).prime().at<GPU>(0, i0__), bra__.mt_coeffs(s).prime().ld(),
-                                              ket__.mt_coeffs(s).prime().at<GPU>(0, j0__), ket__.mt_coeffs(s).prime().ld(),
+                                              bra.mt_coeffs(s).prime().at<GPU>(0, i0__), bra.mt_coeffs(s).prime().ld(),
+                                              ket.mt_coeffs(s).prime().at<GPU>(0, j0__), ket.mt_coeffs(s).prime().ld(),
                                               &linalg_const<double_complex>::one(),
                                               reinterpret_cast<double_complex*>(buf__), ld__,
                                               stream_id);
@@ -152,22 +209,22 @@ inline void inner(device_t        pu__,
             }
             /* wave-functions are real and inner product is also real */
             if (std::is_same<T, double>::value) {
-                if (bra__.has_mt()) {
+                if (bra.has_mt()) {
                     TERMINATE("not implemented");
                 }
                 switch (pu__) {
                     case CPU: {
-                        linalg<CPU>::gemm(2, 0, m__, n__, 2 * bra__.pw_coeffs(s).num_rows_loc(),
+                        linalg<CPU>::gemm(2, 0, m__, n__, 2 * bra.pw_coeffs(s).num_rows_loc(),
                                           *reinterpret_cast<double*>(&alpha),
-                                          reinterpret_cast<double*>(bra__.pw_coeffs(s).prime().at<CPU>(0, i0__)), 2 * bra__.pw_coeffs(s).prime().ld(),
-                                          reinterpret_cast<double*>(ket__.pw_coeffs(s).prime().at<CPU>(0, j0__)), 2 * ket__.pw_coeffs(s).prime().ld(),
+                                          reinterpret_cast<double*>(bra.pw_coeffs(s).prime().at<CPU>(0, i0__)), 2 * bra.pw_coeffs(s).prime().ld(),
+                                          reinterpret_cast<double*>(ket.pw_coeffs(s).prime().at<CPU>(0, j0__)), 2 * ket.pw_coeffs(s).prime().ld(),
                                           *reinterpret_cast<double*>(&beta),
                                           reinterpret_cast<double*>(buf__), ld__);
                         /* subtract one extra G=0 contribution */
                         if (comm.rank() == 0) {
                             linalg<CPU>::ger(m__, n__, -1.0,
-                                             reinterpret_cast<double*>(bra__.pw_coeffs(s).prime().at<CPU>(0, i0__)), 2 * bra__.pw_coeffs(s).prime().ld(),
-                                             reinterpret_cast<double*>(ket__.pw_coeffs(s).prime().at<CPU>(0, j0__)), 2 * ket__.pw_coeffs(s).prime().ld(),
+                                             reinterpret_cast<double*>(bra.pw_coeffs(s).prime().at<CPU>(0, i0__)), 2 * bra.pw_coeffs(s).prime().ld(),
+                                             reinterpret_cast<double*>(ket.pw_coeffs(s).prime().at<CPU>(0, j0__)), 2 * ket.pw_coeffs(s).prime().ld(),
                                              reinterpret_cast<double*>(buf__), ld__); 
 
                         }
@@ -175,18 +232,18 @@ inline void inner(device_t        pu__,
                     }
                     case GPU: {
                         #ifdef __GPU
-                        linalg<GPU>::gemm(2, 0, m__, n__, 2 * bra__.pw_coeffs(s).num_rows_loc(),
+                        linalg<GPU>::gemm(2, 0, m__, n__, 2 * bra.pw_coeffs(s).num_rows_loc(),
                                           reinterpret_cast<double*>(&alpha),
-                                          reinterpret_cast<double*>(bra__.pw_coeffs(s).prime().at<GPU>(0, i0__)), 2 * bra__.pw_coeffs(s).prime().ld(),
-                                          reinterpret_cast<double*>(ket__.pw_coeffs(s).prime().at<GPU>(0, j0__)), 2 * ket__.pw_coeffs(s).prime().ld(),
+                                          reinterpret_cast<double*>(bra.pw_coeffs(s).prime().at<GPU>(0, i0__)), 2 * bra.pw_coeffs(s).prime().ld(),
+                                          reinterpret_cast<double*>(ket.pw_coeffs(s).prime().at<GPU>(0, j0__)), 2 * ket.pw_coeffs(s).prime().ld(),
                                           reinterpret_cast<double*>(&beta),
                                           reinterpret_cast<double*>(buf__), ld__,
                                           stream_id);
                         /* subtract one extra G=0 contribution */
                         if (comm.rank() == 0) {
                             linalg<GPU>::ger(m__, n__, &linalg_const<double>::m_one(),
-                                             reinterpret_cast<double*>(bra__.pw_coeffs(s).prime().at<GPU>(0, i0__)), 2 * bra__.pw_coeffs(s).prime().ld(),
-                                             reinterpret_cast<double*>(ket__.pw_coeffs(s).prime().at<GPU>(0, j0__)), 2 * ket__.pw_coeffs(s).prime().ld(),
+                                             reinterpret_cast<double*>(bra.pw_coeffs(s).prime().at<GPU>(0, i0__)), 2 * bra.pw_coeffs(s).prime().ld(),
+                                             reinterpret_cast<double*>(ket.pw_coeffs(s).prime().at<GPU>(0, j0__)), 2 * ket.pw_coeffs(s).prime().ld(),
                                              reinterpret_cast<double*>(buf__), ld__,
                                              stream_id);
                         }
@@ -199,50 +256,137 @@ inline void inner(device_t        pu__,
         }
     };
 
+    /* upper triangular part of <phi_{j0..j0+n}|phi_{j0..j0+n}> on CPU */
+    auto local_herk = [&](int ip__,
+                          int j0__,
+                          int n__,
+                          T*  buf__,
+                          int ld__){
+        auto& bra = *bra__[ip__];
+        int s0{0};
+        int s1{1};
+        if (ispn__ != 2) {
+            s0 = s1 = ispn__;
+        }
+        double b{0};
+        for (int s = s0; s <= s1; s++) {
+            if (std::is_same<T, double_complex>::value) {
+                linalg<CPU>::herk(n__, bra.pw_coeffs(s).num_rows_loc(), 1.0,
+                                  reinterpret_cast<double_complex*>(bra.pw_coeffs(s).prime().at<CPU>(0, j0__)),
+                                  bra.pw_coeffs(s).prime().ld(), b, reinterpret_cast<double_complex*>(buf__), ld__);
+                if (bra.has_mt()) {
+                    linalg<CPU>::herk(n__, bra.mt_coeffs(s).num_rows_loc(), 1.0,
+                                      reinterpret_cast<double_complex*>(bra.mt_coeffs(s).prime().at<CPU>(0, j0__)),
+                                      bra.mt_coeffs(s).prime().ld(), 1.0, reinterpret_cast<double_complex*>(buf__), ld__);
+                }
+            }
+            if (std::is_same<T, double>::value) {
+                if (bra.has_mt()) {
+                    TERMINATE("not implemented");
+                }
+                linalg<CPU>::herk(n__, 2 * bra.pw_coeffs(s).num_rows_loc(), 2.0,
+                                  reinterpret_cast<double*>(bra.pw_coeffs(s).prime().at<CPU>(0, j0__)),
+                                  2 * bra.pw_coeffs(s).prime().ld(), b, reinterpret_cast<double*>(buf__), ld__);
+                /* subtract one extra G=0 contribution */
+                if (comm.rank() == 0) {
+                    linalg<CPU>::ger(n__, n__, -1.0,
+                                     reinterpret_cast<double*>(bra.pw_coeffs(s).prime().at<CPU>(0, j0__)), 2 * bra.pw_coeffs(s).prime().ld(),
+                                     reinterpret_cast<double*>(bra.pw_coeffs(s).prime().at<CPU>(0, j0__)), 2 * bra.pw_coeffs(s).prime().ld(),
+                                     reinterpret_cast<double*>(buf__), ld__);
+                }
+            }
+            b = 1;
+        }
+    };
+
+    /* compute m x n block on CPU skipping the lower triangle of the Hermitian sub-block; the block is computed
+     * by panels of columns and then the lower triangle is restored */
+    auto local_inner_herm = [&](int ip__,
+                                T*  buf__,
+                                int ld__){
+        bool use_herk = (bra__[ip__] == ket__[ip__]) && (prec__ == linalg_precision_t::fp64);
+        for (int c0 = 0; c0 < n__; c0 += sddk_block_size) {
+            int nc = std::min(n__, c0 + sddk_block_size) - c0;
+            /* part of the panel above the diagonal block */
+            if (d0 + c0 > 0) {
+                local_inner(ip__, i0__, d0 + c0, j0__ + c0, nc, &buf__[ld__ * c0], ld__, -1);
+            }
+            /* diagonal block */
+            if (use_herk) {
+                local_herk(ip__, j0__ + c0, nc, &buf__[d0 + c0 + ld__ * c0], ld__);
+            } else {
+                local_inner(ip__, j0__ + c0, nc, j0__ + c0, nc, &buf__[d0 + c0 + ld__ * c0], ld__, -1);
+            }
+        }
+        #pragma omp parallel for schedule(static)
+        for (int c = 0; c < n__; c++) {
+            for (int r = d0 + c + 1; r < m__; r++) {
+                buf__[r + ld__ * c] = conj_value(buf__[d0 + c + ld__ * (r - d0)]);
+            }
+        }
+    };
+
     if (comm.size() == 1) {
-        T* buf = (pu__ == CPU) ? result__.template at<CPU>(irow0__, jcol0__) : result__.template at<GPU>(irow0__, jcol0__);
-        local_inner(i0__, m__, j0__, n__, buf, result__.ld(), -1);
-        #ifdef __GPU
-        if (pu__ == GPU) {
-            acc::copyout(result__.template at<CPU>(irow0__, jcol0__), result__.ld(),
-                         result__.template at<GPU>(irow0__, jcol0__), result__.ld(),
-                         m__, n__);
+        for (int ip = 0; ip < npair; ip++) {
+            auto& result = *result__[ip];
+            T* buf = (pu__ == CPU) ? result.template at<CPU>(irow0__, jcol0__) : result.template at<GPU>(irow0__, jcol0__);
+            if (herm) {
+                local_inner_herm(ip, buf, result.ld());
+            } else {
+                local_inner(ip, i0__, m__, j0__, n__, buf, result.ld(), -1);
+            }
+            #ifdef __GPU
+            if (pu__ == GPU) {
+                acc::copyout(result.template at<CPU>(irow0__, jcol0__), result.ld(),
+                             result.template at<GPU>(irow0__, jcol0__), result.ld(),
+                             m__, n__);
+            }
+            #endif
         }
-        #endif
         if (sddk_pp) {
             time += omp_get_wtime();
-            int k = bra__.gkvec().num_gvec() + bra__.num_mt_coeffs();
-            printf("inner() performance: %12.6f GFlops/rank, [m,n,k=%i %i %i, time=%f (sec)]\n", ngop * m__ * n__ * k / time, m__, n__, k, time);
+            int k = bra__[0]->gkvec().num_gvec() + bra__[0]->num_mt_coeffs();
+            printf("inner() performance: %12.6f GFlops/rank, [m,n,k=%i %i %i, npair=%i, time=%f (sec)]\n", ngop * m__ * n__ * k / time, m__, n__, k, npair, time);
         }
         return;
-    } else if (result__.blacs_grid().comm().size() == 1) {
-        mdarray<T, 2> tmp(m__, n__);
+    } else if (result__[0]->comm().size() == 1) {
+        mdarray<T, 3> tmp(m__, n__, npair);
         if (pu__ == GPU) {
             tmp.allocate(memory_t::device);
         }
-        T* buf = (pu__ == CPU) ? tmp.template at<CPU>(0, 0) : tmp.template at<GPU>(0, 0);
-        local_inner(i0__, m__, j0__, n__, buf, m__, -1);
+        for (int ip = 0; ip < npair; ip++) {
+            T* buf = (pu__ == CPU) ? tmp.template at<CPU>(0, 0, ip) : tmp.template at<GPU>(0, 0, ip);
+            if (herm) {
+                local_inner_herm(ip, buf, m__);
+            } else {
+                local_inner(ip, i0__, m__, j0__, n__, buf, m__, -1);
+            }
+        }
         if (pu__ == GPU) {
             tmp.template copy<memory_t::device, memory_t::host>();
         }
+        /* one reduction for all pairs */
         comm.allreduce(&tmp[0], static_cast<int>(tmp.size()));
-        for (int j = 0; j < n__; j++) {
-            for (int i = 0; i < m__; i++) {
-                result__(irow0__ + i, jcol0__ + j) = tmp(i, j);
+        for (int ip = 0; ip < npair; ip++) {
+            auto& result = *result__[ip];
+            for (int j = 0; j < n__; j++) {
+                for (int i = 0; i < m__; i++) {
+                    result(irow0__ + i, jcol0__ + j) = tmp(i, j, ip);
+                }
             }
+            #ifdef __GPU
+            if (pu__ == GPU) {
+                acc::copyin(result.template at<GPU>(irow0__, jcol0__), result.ld(),
+                            result.template at<CPU>(irow0__, jcol0__), result.ld(),
+                            m__, n__);
+            }
+            #endif
         }
-        #ifdef __GPU
-        if (pu__ == GPU) {
-            acc::copyin(result__.template at<GPU>(irow0__, jcol0__), result__.ld(),
-                        result__.template at<CPU>(irow0__, jcol0__), result__.ld(),
-                        m__, n__);
-        }
-        #endif
         if (sddk_pp) {
             time += omp_get_wtime();
-            int k = bra__.gkvec().num_gvec() + bra__.num_mt_coeffs();
+            int k = bra__[0]->gkvec().num_gvec() + bra__[0]->num_mt_coeffs();
             if (comm.rank() == 0) {
-                printf("inner() performance: %12.6f GFlops/rank, [m,n,k=%i %i %i, time=%f (sec)]\n", ngop * m__ * n__ * k / time / comm.size(), m__, n__, k, time);
+                printf("inner() performance: %12.6f GFlops/rank, [m,n,k=%i %i %i, npair=%i, time=%f (sec)]\n", ngop * m__ * n__ * k / time / comm.size(), m__, n__, k, npair, time);
             }
         }
         return;
@@ -250,9 +394,10 @@ inline void inner(device_t        pu__,
     
     const int BS = sddk_block_size;
 
+    /* number of buffers (and in-flight reductions) */
     const int num_streams{4};
 
-    mdarray<T, 2> c_tmp(BS * BS, num_streams, memory_t::host_pinned, "inner::c_tmp");
+    mdarray<T, 2> c_tmp(BS * BS * npair, num_streams, memory_t::host_pinned, "inner::c_tmp");
     if (pu__ == GPU) {
         c_tmp.allocate(memory_t::device);
     }
@@ -279,13 +424,16 @@ inline void inner(device_t        pu__,
     int nbr = m__ / BS + std::min(1, m__ % BS);
     /* number of blocks to cover columns of the output matrix */
     int nbc = n__ / BS + std::min(1, n__ % BS);
-    
-    /* A double buffer method is used in case of CPU */    
-    std::array<MPI_Request, 2> req = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
-    std::array<std::array<int, 4>, 2> dims;
+
+    /* true if the window lies below the diagonal of the Hermitian sub-block and can be skipped */
+    auto skip_window = [herm, d0, BS, n__](int ibr, int ibc)
+    {
+        return herm && (ibr * BS > d0 + std::min(n__, (ibc + 1) * BS) - 1);
+    };
     
     if (pu__ == GPU) {
         #ifdef __GPU
+        auto& result = *result__[0];
         /* state of the buffers:
          * state = 0: buffer is free
          * state = 1: buffer stores result of local zgemm */
@@ -337,7 +485,7 @@ inline void inner(device_t        pu__,
                             state = buf_state[s % num_streams];
                         }
                         /* enqueue the gemm kernel */
-                        local_inner(i0__ + i0, nrow, j0__ + j0, ncol, c_tmp.template at<GPU>(0, s % num_streams), nrow, s % num_streams);
+                        local_inner(0, i0__ + i0, nrow, j0__ + j0, ncol, c_tmp.template at<GPU>(0, s % num_streams), nrow, s % num_streams);
                         /* enqueue a copyout operation */
                         acc::copyout(c_tmp.template at<CPU>(0, s % num_streams), 
                                      c_tmp.template at<GPU>(0, s % num_streams),
@@ -365,8 +513,8 @@ inline void inner(device_t        pu__,
                         for (int jcol = 0; jcol < ncol; jcol++) {
                             for (int irow = 0; irow < nrow; irow++) {
                                 /* .add() method takes the global (row, column) indices */
-                                result__.set(irow0__ + i0 + irow, jcol0__ + j0 + jcol,
-                                             c_tmp(irow + nrow * jcol, s % num_streams));
+                                result.set(irow0__ + i0 + irow, jcol0__ + j0 + jcol,
+                                           c_tmp(irow + nrow * jcol, s % num_streams));
                             }
                         }
 
@@ -384,15 +532,24 @@ inline void inner(device_t        pu__,
     }
     
     if (pu__ == CPU) {
-        auto store_panel = [&req, &result__, &dims, &c_tmp, irow0__, jcol0__](int s)
-        {
-            MPI_Wait(&req[s % 2], MPI_STATUS_IGNORE);
+        /* A multiple buffer method is used in case of CPU */
+        std::array<MPI_Request, num_streams> req;
+        req.fill(MPI_REQUEST_NULL);
+        std::array<std::array<int, 4>, num_streams> dims;
 
-            #pragma omp parallel for
-            for (int jcol = 0; jcol < dims[s % 2][3]; jcol++) {
-                for (int irow = 0; irow < dims[s % 2][2]; irow++) {
-                    result__.set(irow0__ + irow +  dims[s % 2][0], jcol0__ + jcol +  dims[s % 2][1],
-                                 c_tmp(irow + dims[s % 2][2] * jcol, s % 2));
+        auto store_panel = [&req, &result__, &dims, &c_tmp, npair, irow0__, jcol0__](int s)
+        {
+            MPI_Wait(&req[s], MPI_STATUS_IGNORE);
+
+            int nrow = dims[s][2];
+            int ncol = dims[s][3];
+            for (int ip = 0; ip < npair; ip++) {
+                #pragma omp parallel for
+                for (int jcol = 0; jcol < ncol; jcol++) {
+                    for (int irow = 0; irow < nrow; irow++) {
+                        result__[ip]->set(irow0__ + irow + dims[s][0], jcol0__ + jcol + dims[s][1],
+                                          c_tmp(irow + nrow * jcol + nrow * ncol * ip, s));
+                    }
                 }
             }
         };
@@ -403,40 +560,100 @@ inline void inner(device_t        pu__,
             int ncol = std::min(n__, (ibc + 1) * BS) - j0;
 
             for (int ibr = 0; ibr < nbr; ibr++) {
+                if (skip_window(ibr, ibc)) {
+                    continue;
+                }
                 int i0 = ibr * BS;
                 int nrow = std::min(m__, (ibr + 1) * BS) - i0;
 
-                if (req[s % 2] != MPI_REQUEST_NULL) {
-                    store_panel(s);
+                if (req[s % num_streams] != MPI_REQUEST_NULL) {
+                    store_panel(s % num_streams);
                 }
 
-                dims[s % 2][0] = i0;
-                dims[s % 2][1] = j0;
-                dims[s % 2][2] = nrow;
-                dims[s % 2][3] = ncol;
+                dims[s % num_streams][0] = i0;
+                dims[s % num_streams][1] = j0;
+                dims[s % num_streams][2] = nrow;
+                dims[s % num_streams][3] = ncol;
 
-                T* buf = (pu__ == CPU) ? c_tmp.template at<CPU>(0, s % 2) : c_tmp.template at<GPU>(0, s % 2);
-                local_inner(i0__ + i0, nrow, j0__ + j0, ncol, buf, nrow, -1);
+                for (int ip = 0; ip < npair; ip++) {
+                    local_inner(ip, i0__ + i0, nrow, j0__ + j0, ncol, c_tmp.template at<CPU>(nrow * ncol * ip, s % num_streams),
+                                nrow, -1);
+                }
 
-                comm.iallreduce(c_tmp.template at<CPU>(0, s % 2), nrow * ncol, &req[s % 2]);
+                comm.iallreduce(c_tmp.template at<CPU>(0, s % num_streams), nrow * ncol * npair, &req[s % num_streams]);
 
                 s++;
             }
         }
 
-        for (int s: {0, 1}) {
-            if (req[s % 2] != MPI_REQUEST_NULL) {
+        for (int s = 0; s < num_streams; s++) {
+            if (req[s] != MPI_REQUEST_NULL) {
                 store_panel(s);
             }
         }
+
+        /* restore the skipped windows from the upper part of the Hermitian sub-block */
+        if (herm && nbr > 1) {
+            #ifdef __SCALAPACK
+            for (int ip = 0; ip < npair; ip++) {
+                auto& result = *result__[ip];
+                /* the same block-cyclic distribution of the transposed sub-block */
+                dmatrix<T> tmp(irow0__ + m__, jcol0__ + n__, result.blacs_grid(), result.bs_row(), result.bs_col());
+                linalg<CPU>::tranc(n__, n__, result, irow0__ + d0, jcol0__, tmp, irow0__ + d0, jcol0__);
+
+                splindex<block_cyclic> spl_row(irow0__ + m__, result.num_ranks_row(), result.rank_row(), result.bs_row());
+                splindex<block_cyclic> spl_col(jcol0__ + n__, result.num_ranks_col(), result.rank_col(), result.bs_col());
+
+                #pragma omp parallel for schedule(static)
+                for (int jloc = 0; jloc < spl_col.local_size(); jloc++) {
+                    int c = spl_col[jloc] - jcol0__;
+                    if (c < 0) {
+                        continue;
+                    }
+                    for (int iloc = 0; iloc < spl_row.local_size(); iloc++) {
+                        int r = spl_row[iloc] - irow0__;
+                        if (r >= 0 && skip_window(r / BS, c / BS)) {
+                            result(iloc, jloc) = tmp(iloc, jloc);
+                        }
+                    }
+                }
+            }
+            #else
+            TERMINATE_NO_SCALAPACK
+            #endif
+        }
     }
 
     if (sddk_pp) {
         comm.barrier();
         time += omp_get_wtime();
-        int k = bra__.gkvec().num_gvec() + bra__.num_mt_coeffs();
+        int k = bra__[0]->gkvec().num_gvec() + bra__[0]->num_mt_coeffs();
         if (comm.rank() == 0) {
-            printf("inner() performance: %12.6f GFlops/rank, [m,n,k=%i %i %i, time=%f (sec)]\n", ngop * m__ * n__ * k / time / comm.size(), m__, n__, k, time);
+            printf("inner() performance: %12.6f GFlops/rank, [m,n,k=%i %i %i, npair=%i, time=%f (sec)]\n", ngop * m__ * n__ * k / time / comm.size(), m__, n__, k, npair, time);
         }
     }
 }
+
+/// Inner product between wave-functions.
+/** The following \f$ m \times n \f$ sub-matrix is computed:
+ *  \f[
+ *    S_{irow0+i,jcol0+j} = \langle \phi_{i0 + i} | \tilde \phi_{j0 + j} \rangle
+ *  \f]
+ *  See the description of the inner product for several pairs of wave-functions above.
+ */
+template <typename T>
+inline void inner(device_t           pu__,
+                  int                ispn__,
+                  Wave_functions&    bra__,
+                  int                i0__,
+                  int                m__,
+                  Wave_functions&    ket__,
+                  int                j0__,
+                  int                n__,
+                  dmatrix<T>&        result__,
+                  int                irow0__,
+                  int                jcol0__,
+                  linalg_precision_t prec__ = linalg_precision_t::fp64)
+{
+    inner<T>(pu__, ispn__, {&bra__}, i0__, m__, {&ket__}, j0__, n__, {&result__}, irow0__, jcol0__, false, prec__);
+}
@@ -1,4 +1,247 @@
+/// Method of the orthogonalization of the new block of wave-functions.
+enum class ortho_method_t
+{
+    /// Cholesky factorization of the overlap matrix (with ScaLAPACK in case of distributed matrix).
+    cholesky,
+
+    /// Two passes of Cholesky-QR with the overlap matrix replicated on all MPI ranks.
+    cholesky_qr2,
+
+    /// Communication-avoiding QR factorization of the slab-distributed wave-functions.
+    tsqr
+};
+
+/// Get orthogonalization method by name.
+inline ortho_method_t get_ortho_method(std::string name__)
+{
+    std::map<std::string, ortho_method_t> m = {
+        {"cholesky",     ortho_method_t::cholesky},
+        {"cholesky_qr2", ortho_method_t::cholesky_qr2},
+        {"tsqr",         ortho_method_t::tsqr}
+    };
+    if (m.count(name__) == 0) {
+        std::stringstream s;
+        s << "wrong orthogonalization method " << name__;
+        TERMINATE(s);
+    }
+    return m[name__];
+}
+
+/// Multiply the block of wave-functions by the upper triangular matrix on CPU.
+template <typename T>
+inline void mul_upper_triangular(int                           ispn__,
+                                 std::vector<Wave_functions*>& wfs__,
+                                 int                           N__,
+                                 int                           n__,
+                                 T*                            r__,
+                                 int                           ld__)
+{
+    int s0{0};
+    int s1{1};
+    if (ispn__ != 2) {
+        s0 = s1 = ispn__;
+    }
+    for (int s = s0; s <= s1; s++) {
+        for (auto& e: wfs__) {
+            /* wave functions are complex, transformation matrix is complex */
+            if (std::is_same<T, double_complex>::value) {
+                linalg<CPU>::trmm('R', 'U', 'N', e->pw_coeffs(s).num_rows_loc(), n__, double_complex(1, 0),
+                                  reinterpret_cast<double_complex*>(r__), ld__,
+                                  e->pw_coeffs(s).prime().at<CPU>(0, N__), e->pw_coeffs(s).prime().ld());
+
+                if (e->has_mt()) {
+                    linalg<CPU>::trmm('R', 'U', 'N', e->mt_coeffs(s).num_rows_loc(), n__, double_complex(1, 0),
+                                      reinterpret_cast<double_complex*>(r__), ld__,
+                                      e->mt_coeffs(s).prime().at<CPU>(0, N__), e->mt_coeffs(s).prime().ld());
+                }
+            }
+            /* wave functions are real (psi(G) = psi^{*}(-G)), transformation matrix is real */
+            if (std::is_same<T, double>::value) {
+                linalg<CPU>::trmm('R', 'U', 'N', 2 * e->pw_coeffs(s).num_rows_loc(), n__, 1.0,
+                                  reinterpret_cast<double*>(r__), ld__,
+                                  reinterpret_cast<double*>(e->pw_coeffs(s).prime().at<CPU>(0, N__)), 2 * e->pw_coeffs(s).prime().ld());
+
+                if (e->has_mt()) {
+                    linalg<CPU>::trmm('R', 'U', 'N', 2 * e->mt_coeffs(s).num_rows_loc(), n__, 1.0,
+                                      reinterpret_cast<double*>(r__), ld__,
+                                      reinterpret_cast<double*>(e->mt_coeffs(s).prime().at<CPU>(0, N__)), 2 * e->mt_coeffs(s).prime().ld());
+                }
+            }
+        }
+    }
+}
+
+/// Orthogonalize the block of n wave-functions with the Cholesky-QR2 algorithm on CPU.
+/** The overlap matrix is replicated on all MPI ranks: each pass requires a single reduction and the small
+ *  factorization is done redundantly by all ranks. If the Cholesky factorization fails due to the ill-conditioning,
+ *  an extra pass with the shifted overlap matrix is done first (shifted Cholesky-QR3, see Fukaya et al.,
+ *  SIAM J. Sci. Comput. 42, A477 (2020)). */
+template <typename T, int idx_bra__, int idx_ket__>
+inline void cholesky_qr2(int                           ispn__,
+                         std::vector<Wave_functions*>& wfs__,
+                         int                           N__,
+                         int                           n__)
+{
+    PROFILE("sddk::Wave_functions::cholesky_qr2");
+
+    dmatrix<T> o(n__, n__);
+
+    /* one pass of Cholesky-QR; shift is relative to the largest diagonal element of the overlap matrix */
+    auto pass = [&](double shift__)
+    {
+        inner<T>(CPU, ispn__, {wfs__[idx_bra__]}, N__, n__, {wfs__[idx_ket__]}, N__, n__, {&o}, 0, 0, true);
+        if (shift__ > 0) {
+            double d{0};
+            for (int i = 0; i < n__; i++) {
+                d = std::max(d, std::abs(o(i, i)));
+            }
+            for (int i = 0; i < n__; i++) {
+                o(i, i) += shift__ * d;
+            }
+        }
+        if (linalg<CPU>::potrf(n__, o.template at<CPU>(), o.ld())) {
+            return false;
+        }
+        if (linalg<CPU>::trtri(n__, o.template at<CPU>(), o.ld())) {
+            return false;
+        }
+        mul_upper_triangular(ispn__, wfs__, N__, n__, o.template at<CPU>(), o.ld());
+        return true;
+    };
+
+    if (!pass(0)) {
+        double K = wfs__[0]->gkvec().num_gvec() + wfs__[0]->num_mt_coeffs();
+        double shift = 11 * (K * n__ + n__ * (n__ + 1)) * std::numeric_limits<double>::epsilon();
+        if (!pass(shift) || !pass(0)) {
+            std::stringstream s;
+            s << "shifted Cholesky-QR failed, matrix size : " << n__;
+            TERMINATE(s);
+        }
+    }
+    if (!pass(0)) {
+        std::stringstream s;
+        s << "second pass of Cholesky-QR failed, matrix size : " << n__;
+        TERMINATE(s);
+    }
+}
+
+/// Orthogonalize the block of n complex wave-functions with the TSQR algorithm on CPU.
+/** Each MPI rank computes the QR factorization of its slab of the wave-function coefficients. The local R factors
+ *  are combined pairwise along a binary reduction tree (two stacked R factors are factorized again at each level)
+ *  and the final R factor is broadcast from the root. All wave-functions in wfs__ are then multiplied by the
+ *  inverse of R. Two passes are done to get the orthogonality at the level of machine precision.
+ *
+ *  The factorization is done for wfs__[idx__] in the Euclidean metric, so the method is only valid without the
+ *  S operator (when the S-transformed wave-functions are equal to the wave-functions). */
+template <int idx__>
+inline void tsqr(int                           ispn__,
+                 std::vector<Wave_functions*>& wfs__,
+                 int                           N__,
+                 int                           n__)
+{
+    PROFILE("sddk::Wave_functions::tsqr");
+
+    auto& comm = wfs__[0]->comm();
+    auto& wf = *wfs__[idx__];
+
+    int s0{0};
+    int s1{1};
+    if (ispn__ != 2) {
+        s0 = s1 = ispn__;
+    }
+
+    /* local number of rows */
+    int nr{0};
+    for (int s = s0; s <= s1; s++) {
+        nr += wf.pw_coeffs(s).num_rows_loc();
+        if (wf.has_mt()) {
+            nr += wf.mt_coeffs(s).num_rows_loc();
+        }
+    }
+
+    auto geqrf = [n__](int m__, matrix<double_complex>& a__)
+    {
+        if (int info = linalg<CPU>::geqrf(m__, n__, a__.at<CPU>(), a__.ld())) {
+            std::stringstream s;
+            s << "geqrf failed in TSQR, info = " << info << ", matrix size : " << m__ << " x " << n__;
+            TERMINATE(s);
+        }
+    };
+
+    /* R factor of the current node of the reduction tree */
+    matrix<double_complex> r(n__, n__);
+    /* two stacked R factors */
+    matrix<double_complex> r2(2 * n__, n__);
+
+    /* the second pass restores the orthogonality lost in the multiplication by the inverse of R */
+    for (int pass = 0; pass < 2; pass++) {
+        /* local matrix is padded with zeros up to n rows */
+        matrix<double_complex> a(std::max(nr, n__), n__);
+        a.zero();
+        #pragma omp parallel for schedule(static)
+        for (int j = 0; j < n__; j++) {
+            int offs{0};
+            for (int s = s0; s <= s1; s++) {
+                std::copy(wf.pw_coeffs(s).prime().at<CPU>(0, N__ + j),
+                          wf.pw_coeffs(s).prime().at<CPU>(0, N__ + j) + wf.pw_coeffs(s).num_rows_loc(), &a(offs, j));
+                offs += wf.pw_coeffs(s).num_rows_loc();
+                if (wf.has_mt()) {
+                    std::copy(wf.mt_coeffs(s).prime().at<CPU>(0, N__ + j),
+                              wf.mt_coeffs(s).prime().at<CPU>(0, N__ + j) + wf.mt_coeffs(s).num_rows_loc(), &a(offs, j));
+                    offs += wf.mt_coeffs(s).num_rows_loc();
+                }
+            }
+        }
+        geqrf(static_cast<int>(a.size(0)), a);
+        r.zero();
+        for (int j = 0; j < n__; j++) {
+            for (int i = 0; i <= j; i++) {
+                r(i, j) = a(i, j);
+            }
+        }
+
+        /* binary reduction tree: at level d the rank (rank + d) sends its R factor to the rank */
+        for (int d = 1; d < comm.size(); d *= 2) {
+            if (comm.rank() % (2 * d) == 0) {
+                if (comm.rank() + d < comm.size()) {
+                    r2.zero();
+                    for (int j = 0; j < n__; j++) {
+                        std::copy(&r(0, j), &r(0, j) + n__, &r2(0, j));
+                    }
+                    comm.recv(r.at<CPU>(), n__ * n__, comm.rank() + d, d);
+                    for (int j = 0; j < n__; j++) {
+                        std::copy(&r(0, j), &r(0, j) + n__, &r2(n__, j));
+                    }
+                    geqrf(2 * n__, r2);
+                    r.zero();
+                    for (int j = 0; j < n__; j++) {
+                        for (int i = 0; i <= j; i++) {
+                            r(i, j) = r2(i, j);
+                        }
+                    }
+                }
+            } else {
+                comm.send(r.at<CPU>(), n__ * n__, comm.rank() - d, d);
+                break;
+            }
+        }
+        comm.bcast(r.at<CPU>(), n__ * n__, 0);
+
+        if (linalg<CPU>::trtri(n__, r.at<CPU>(), r.ld())) {
+            std::stringstream s;
+            s << "R factor of TSQR is singular, matrix size : " << n__;
+            TERMINATE(s);
+        }
+        mul_upper_triangular(ispn__, wfs__, N__, n__, r.at<CPU>(), r.ld());
+    }
+}
+
 /// Orthogonalize n new wave-functions to the N old wave-functions
+/** The new wave-functions are first projected out of the old subspace and then orthogonalized between themselves
+ *  with the selected method. Cholesky-QR2 and TSQR are CPU only; on GPU the Cholesky method is always used.
+ *  TSQR is implemented for the complex wave-functions only. It factorizes wfs__[idx_bra__] in the Euclidean
+ *  metric, so in the three wave-functions form the caller must make sure that there is no S operator.
+ *  On CPU, if the Cholesky factorization fails, the orthogonalization falls back to the (shifted) Cholesky-QR. */
 template <typename T, int idx_bra__, int idx_ket__>
 inline void orthogonalize(device_t                     pu__,
                           int                          ispn__, 
@@ -6,7 +249,8 @@ inline void orthogonalize(device_t                     pu__,
                           int                          N__,
                           int                          n__,
                           dmatrix<T>&                  o__,
-                          Wave_functions&              tmp__)
+                          Wave_functions&              tmp__,
+                          ortho_method_t               method__ = ortho_method_t::cholesky)
 {
     PROFILE("sddk::Wave_functions::orthogonalize");
 
@@ -92,8 +336,20 @@ inline void orthogonalize(device_t                     pu__,
         }
     }
 
-    /* orthogonalize new n__ x n__ block */
-    inner(pu__, ispn__, *wfs__[idx_bra__], N__, n__, *wfs__[idx_ket__], N__, n__, o__, 0, 0);
+    if (pu__ == CPU && method__ != ortho_method_t::cholesky) {
+        if (method__ == ortho_method_t::tsqr) {
+            if (!std::is_same<T, double_complex>::value) {
+                TERMINATE("TSQR orthogonalization is implemented only for complex wave-functions");
+            }
+            tsqr<idx_bra__>(ispn__, wfs__, N__, n__);
+        } else {
+            cholesky_qr2<T, idx_bra__, idx_ket__>(ispn__, wfs__, N__, n__);
+        }
+        return;
+    }
+
+    /* orthogonalize new n__ x n__ block; the overlap matrix is Hermitian */
+    inner<T>(pu__, ispn__, {wfs__[idx_bra__]}, N__, n__, {wfs__[idx_ket__]}, N__, n__, {&o__}, 0, 0, true);
 
     if (sddk_debug >= 1) {
         if (o__.blacs_grid().comm().rank() == 0) {
@@ -145,6 +401,13 @@ inline void orthogonalize(device_t                     pu__,
         } else { /* CPU version */
             /* Cholesky factorization */
             if (int info = linalg<CPU>::potrf(n__, &o__(0, 0), o__.ld())) {
+                if (pu__ == CPU) {
+                    if (sddk_debug >= 1) {
+                        printf("Cholesky factorization failed (info = %i), switching to Cholesky-QR\n", info);
+                    }
+                    cholesky_qr2<T, idx_bra__, idx_ket__>(ispn__, wfs__, N__, n__);
+                    return;
+                }
                 std::stringstream s;
                 s << "error in factorization, info = " << info << std::endl
                   << "number of existing states: " << N__ << std::endl
@@ -164,42 +427,18 @@ inline void orthogonalize(device_t                     pu__,
             }
         }
         
+        /* CPU version */
+        if (pu__ == CPU) {
+            /* multiplication by triangular matrix */
+            mul_upper_triangular(ispn__, wfs__, N__, n__, o__.template at<CPU>(), o__.ld());
+        }
+
         int s0{0};
         int s1{1};
         if (ispn__ != 2) {
             s0 = s1 = ispn__;
         }
         for (int s = s0; s <= s1; s++) {
-            /* CPU version */
-            if (pu__ == CPU) {
-                /* multiplication by triangular matrix */
-                for (auto& e: wfs__) {
-                    /* wave functions are complex, transformation matrix is complex */
-                    if (std::is_same<T, double_complex>::value) {
-                        linalg<CPU>::trmm('R', 'U', 'N', e->pw_coeffs(s).num_rows_loc(), n__, double_complex(1, 0),
-                                          reinterpret_cast<double_complex*>(o__.template at<CPU>()), o__.ld(),
-                                          e->pw_coeffs(s).prime().at<CPU>(0, N__), e->pw_coeffs(s).prime().ld());
-
-                        if (e->has_mt()) {
-                            linalg<CPU>::trmm('R', 'U', 'N', e->mt_coeffs(s).num_rows_loc(), n__, double_complex(1, 0),
-                                              reinterpret_cast<double_complex*>(o__.template at<CPU>()), o__.ld(),
-                                              e->mt_coeffs(s).prime().at<CPU>(0, N__), e->mt_coeffs(s).prime().ld());
-                        }
-                    }
-                    /* wave functions are real (psi(G) = psi^{*}(-G)), transformation matrix is real */
-                    if (std::is_same<T, double>::value) {
-                        linalg<CPU>::trmm('R', 'U', 'N', 2 * e->pw_coeffs(s).num_rows_loc(), n__, 1.0,
-                                          reinterpret_cast<double*>(o__.template at<CPU>()), o__.ld(),
-                                          reinterpret_cast<double*>(e->pw_coeffs(s).prime().at<CPU>(0, N__)), 2 * e->pw_coeffs(s).prime().ld());
-
-                        if (e->has_mt()) {
-                            linalg<CPU>::trmm('R', 'U', 'N', 2 * e->mt_coeffs(s).num_rows_loc(), n__, 1.0,
-                                              reinterpret_cast<double*>(o__.template at<CPU>()), o__.ld(),
-                                              reinterpret_cast<double*>(e->mt_coeffs(s).prime().at<CPU>(0, N__)), 2 * e->mt_coeffs(s).prime().ld());
-                        }
-                    }
-                }
-            }
             #ifdef __GPU
             if (pu__ == GPU) {
                 /* multiplication by triangular matrix */
@@ -246,6 +485,13 @@ inline void orthogonalize(device_t                     pu__,
             diag = o__.get_diag(n__);
         }
         if (int info = linalg<CPU>::potrf(n__, o__)) {
+            if (pu__ == CPU) {
+                if (sddk_debug >= 1 && comm.rank() == 0) {
+                    printf("Cholesky factorization failed (info = %i), switching to Cholesky-QR\n", info);
+                }
+                cholesky_qr2<T, idx_bra__, idx_ket__>(ispn__, wfs__, N__, n__);
+                return;
+            }
             std::stringstream s;
             s << "error in Cholesky factorization, info = " << info << ", matrix size = " << n__;
             if (sddk_debug >= 1) {
@@ -292,13 +538,14 @@ inline void orthogonalize(device_t        pu__,
                           int             N__,
                           int             n__,
                           dmatrix<T>&     o__,
-                          Wave_functions& tmp__)
+                          Wave_functions& tmp__,
+                          ortho_method_t  method__ = ortho_method_t::cholesky)
 {
     static_assert(std::is_same<T, double>::value || std::is_same<T, double_complex>::value, "wrong type");
 
     auto wfs = {&phi__, &hphi__, &ophi__};
 
-    orthogonalize<T, 0, 2>(pu__, ispn__, wfs, N__, n__, o__, tmp__);
+    orthogonalize<T, 0, 2>(pu__, ispn__, wfs, N__, n__, o__, tmp__, method__);
 }
 
 template <typename T>
@@ -309,11 +556,12 @@ inline void orthogonalize(device_t        pu__,
                           int             N__,
                           int             n__,
                           dmatrix<T>&     o__,
-                          Wave_functions& tmp__)
+                          Wave_functions& tmp__,
+                          ortho_method_t  method__ = ortho_method_t::cholesky)
 {
     static_assert(std::is_same<T, double>::value || std::is_same<T, double_complex>::value, "wrong type");
 
     auto wfs = {&phi__, &hphi__};
 
-    orthogonalize<T, 0, 0>(pu__, ispn__, wfs, N__, n__, o__, tmp__);
+    orthogonalize<T, 0, 0>(pu__, ispn__, wfs, N__, n__, o__, tmp__, method__);
 }
@@ -1,5 +1,6 @@
 /// Linear transformation of the wave-functions.
-/** The transformation matrix is expected in the CPU memory. */
+/** The transformation matrix is expected in the CPU memory. In case of complex wave-functions on CPU the
+ *  local multiplication can be done in single precision (see linalg_precision_t). */
 template <typename T>
 inline void transform(device_t                     pu__,
                       int                          ispn__,
@@ -13,7 +14,8 @@ inline void transform(device_t                     pu__,
                       double                       beta__,
                       std::vector<Wave_functions*> wf_out__,
                       int                          j0__,
-                      int                          n__)
+                      int                          n__,
+                      linalg_precision_t           prec__ = linalg_precision_t::fp64)
 {
     PROFILE("sddk::wave_functions::transform");
 
@@ -65,6 +67,26 @@ inline void transform(device_t                     pu__,
                wave-fucntions; in this case we set spin index of input wave-function to 0 */
             int in_s = (wf_in__->num_sc() == 1) ? 0 : s;
 
+            if (pu__ == CPU && prec__ == linalg_precision_t::fp32 && std::is_same<T, double_complex>::value) {
+                /* transform plane-wave part */
+                gemm_fp32(0, wf_in__->pw_coeffs(in_s).num_rows_loc(), n__, m__,
+                          *reinterpret_cast<double_complex*>(alpha),
+                          wf_in__->pw_coeffs(in_s).prime().at<CPU>(0, i0__), wf_in__->pw_coeffs(in_s).prime().ld(),
+                          reinterpret_cast<double_complex*>(ptr__), ld__,
+                          linalg_const<double_complex>::one(),
+                          wf_out__->pw_coeffs(s).prime().at<CPU>(0, j0__), wf_out__->pw_coeffs(s).prime().ld());
+                /* transform muffin-tin part */
+                if (wf_in__->has_mt()) {
+                    gemm_fp32(0, wf_in__->mt_coeffs(in_s).num_rows_loc(), n__, m__,
+                              *reinterpret_cast<double_complex*>(alpha),
+                              wf_in__->mt_coeffs(in_s).prime().at<CPU>(0, i0__), wf_in__->mt_coeffs(in_s).prime().ld(),
+                              reinterpret_cast<double_complex*>(ptr__), ld__,
+                              linalg_const<double_complex>::one(),
+                              wf_out__->mt_coeffs(s).prime().at<CPU>(0, j0__), wf_out__->mt_coeffs(s).prime().ld());
+                }
+                continue;
+            }
+
             if (pu__ == CPU) {
                 if (std::is_same<T, double_complex>::value) {
                     /* transform plane-wave part */
@@ -350,9 +372,10 @@ inline void transform(device_t                     pu__,
                       int                          jcol0__,
                       std::vector<Wave_functions*> wf_out__,
                       int                          j0__,
-                      int                          n__)
+                      int                          n__,
+                      linalg_precision_t           prec__ = linalg_precision_t::fp64)
 {
-    transform<T>(pu__, ispn__, 1.0, wf_in__, i0__, m__, mtrx__, irow0__, jcol0__, 0.0, wf_out__, j0__, n__);
+    transform<T>(pu__, ispn__, 1.0, wf_in__, i0__, m__, mtrx__, irow0__, jcol0__, 0.0, wf_out__, j0__, n__, prec__);
 }
 
 template <typename T>
@@ -134,7 +134,10 @@ class Atom
             b_radial_integrals_ = mdarray<double, 4>(lmmax, nrf, nrf, type().parameters().num_mag_dims());
             b_radial_integrals_.zero();
 
-            occupation_matrix_ = mdarray<double_complex, 4>(16, 16, 2, 2);
+            /* occupation matrix is only needed up to the f-channel; don't allocate more than the basis has */
+            int lmmax_om = Utils::lmmax(std::min(type().indexr().lmax(), 3));
+            occupation_matrix_ = mdarray<double_complex, 4>(lmmax_om, lmmax_om, 2, 2);
+            occupation_matrix_.zero();
 
             uj_correction_matrix_ = mdarray<double_complex, 4>(16, 16, 2, 2);
         }
@@ -406,6 +409,28 @@ class Atom
         }
     }
 
+    /// Return muffin-tin potential.
+    inline mdarray<double, 2> const& veff() const
+    {
+        return veff_;
+    }
+
+    /// Return j-th component of the muffin-tin magnetic field.
+    inline mdarray<double, 2> const& beff(int j__) const
+    {
+        return beff_[j__];
+    }
+
+    inline mdarray<double, 3>& h_radial_integrals()
+    {
+        return h_radial_integrals_;
+    }
+
+    inline mdarray<double, 4>& b_radial_integrals()
+    {
+        return b_radial_integrals_;
+    }
+
     inline void sync_radial_integrals(Communicator const& comm__, int const rank__)
     {
         comm__.bcast(h_radial_integrals_.at<CPU>(), (int)h_radial_integrals_.size(), rank__);
@@ -541,15 +566,38 @@ class Atom
         return type_.mt_lo_basis_size();
     }
 
+    /// Set occupation matrix from the host code array of size 16 x 16 x 2 x 2.
     inline void set_occupation_matrix(const double_complex* source)
     {
-        std::memcpy(occupation_matrix_.at<CPU>(), source, 16 * 16 * 2 * 2 * sizeof(double_complex));
+        mdarray<double_complex, 4> src(const_cast<double_complex*>(source), 16, 16, 2, 2);
+        int lmmax = static_cast<int>(occupation_matrix_.size(0));
+        for (int s2 = 0; s2 < 2; s2++) {
+            for (int s1 = 0; s1 < 2; s1++) {
+                for (int lm2 = 0; lm2 < lmmax; lm2++) {
+                    for (int lm1 = 0; lm1 < lmmax; lm1++) {
+                        occupation_matrix_(lm1, lm2, s1, s2) = src(lm1, lm2, s1, s2);
+                    }
+                }
+            }
+        }
         apply_uj_correction_ = false;
     }
 
+    /// Get occupation matrix in the host code array of size 16 x 16 x 2 x 2.
     inline void get_occupation_matrix(double_complex* destination)
     {
-        std::memcpy(destination, occupation_matrix_.at<CPU>(), 16 * 16 * 2 * 2 * sizeof(double_complex));
+        mdarray<double_complex, 4> dest(destination, 16, 16, 2, 2);
+        dest.zero();
+        int lmmax = static_cast<int>(occupation_matrix_.size(0));
+        for (int s2 = 0; s2 < 2; s2++) {
+            for (int s1 = 0; s1 < 2; s1++) {
+                for (int lm2 = 0; lm2 < lmmax; lm2++) {
+                    for (int lm1 = 0; lm1 < lmmax; lm1++) {
+                        dest(lm1, lm2, s1, s2) = occupation_matrix_(lm1, lm2, s1, s2);
+                    }
+                }
+            }
+        }
     }
 
     inline void set_uj_correction_matrix(const int l, const double_complex* source)
@@ -205,6 +205,11 @@ class Atom_type
 
     mdarray<int, 2> idx_radial_integrals_;
 
+    /// Integration weights of the muffin-tin radial grid.
+    /** Integral of the cubic spline interpolation of \f$ f(r) \f$ with \f$ r^2 \f$ prefactor is
+     *  \f$ \sum_{i} w_i f(r_i) \f$ because the interpolation is linear in the values of the function. */
+    mdarray<double, 1> mt_integration_weights_;
+
     mutable mdarray<double, 3> rf_coef_;
     mutable mdarray<double, 3> vrf_coef_;
 
@@ -212,6 +217,23 @@ class Atom_type
 
     inline void read_hubbard_parameters(json const& parser);
 
+    /// Compute integration weights of the muffin-tin radial grid.
+    inline void init_mt_integration_weights()
+    {
+        mt_integration_weights_ = mdarray<double, 1>(num_mt_points());
+        #pragma omp parallel
+        {
+            Spline<double> s(radial_grid());
+            #pragma omp for
+            for (int ir = 0; ir < num_mt_points(); ir++) {
+                for (int ir1 = 0; ir1 < num_mt_points(); ir1++) {
+                    s(ir1) = (ir1 == ir) ? 1 : 0;
+                }
+                mt_integration_weights_(ir) = s.interpolate().integrate(2);
+            }
+        }
+    }
+
     inline void read_input_core(json const& parser);
 
     inline void read_input_aw(json const& parser);
@@ -303,6 +325,10 @@ class Atom_type
         if (parameters_.processing_unit() == GPU) {
             radial_grid_.copy_to_device();
         }
+        /* grid of an initialized atom type can be changed, e.g. by the automatic muffin-tin radii */
+        if (initialized_ && parameters_.full_potential()) {
+            init_mt_integration_weights();
+        }
     }
 
     inline void set_radial_grid(int num_points__, double const* points__)
@@ -311,6 +337,10 @@ class Atom_type
         if (parameters_.processing_unit() == GPU) {
             radial_grid_.copy_to_device();
         }
+        /* grid of an initialized atom type can be changed, e.g. by the automatic muffin-tin radii */
+        if (initialized_ && parameters_.full_potential()) {
+            init_mt_integration_weights();
+        }
     }
 
     /// Add augmented-wave descriptor.
@@ -888,6 +918,11 @@ class Atom_type
         return idx_radial_integrals_;
     }
 
+    inline mdarray<double, 1> const& mt_integration_weights() const
+    {
+        return mt_integration_weights_;
+    }
+
     inline mdarray<double, 3>& rf_coef() const
     {
         return rf_coef_;
@@ -1537,6 +1572,8 @@ inline void Atom_type::init(int offset_lo__)
             idx_radial_integrals_(0, j) = non_zero_elements[j].first;
             idx_radial_integrals_(1, j) = non_zero_elements[j].second;
         }
+
+        init_mt_integration_weights();
     }
 
     if (parameters_.processing_unit() == GPU && parameters_.full_potential()) {
@@ -26,6 +26,8 @@
 #define __UNIT_CELL_H__
 
 #include <algorithm>
+#include <numeric>
+#include <set>
 #include "descriptors.h"
 #include "atom_type.h"
 #include "atom_symmetry_class.h"
@@ -65,7 +67,7 @@ class Unit_cell
     std::vector<int> paw_atom_index_;
 
     /// Split index of PAW atoms.
-    splindex<block> spl_num_paw_atoms_;
+    splindex<chunk> spl_num_paw_atoms_;
 
     /// Split index of atom symmetry classes.
     splindex<block> spl_num_atom_symmetry_classes_;
@@ -204,6 +206,14 @@ class Unit_cell
      *    7. Create split indices for atoms and atom classes */
     inline void initialize();
 
+    /// Update the unit cell after the atoms were moved.
+    /** Nearest neighbours and symmetry are found for the new atomic positions. Atom types, radial grids, MT
+     *  radii and atom symmetry classes (with their radial functions and core density in the full-potential case)
+     *  are kept. The new configuration must have the same number of symmetry operations and the same atom
+     *  symmetry classes, otherwise the irreducible k-point set and the class data are no longer valid and the
+     *  run is terminated. */
+    inline void update();
+
     /// Add new atom type to the list of atom types and read necessary data from the .json file
     inline void add_atom_type(const std::string label, const std::string file_name = "")
     {
@@ -249,7 +259,15 @@ class Unit_cell
             }
         }
 
-        spl_num_paw_atoms_ = splindex<block>(num_paw_atoms(), comm_.size(), comm_.rank());
+        /* PAW atoms are split in contiguous chunks of similar cost; the work of the one-centre density,
+         * potential and D-operator scales with the number of radial points and the square of the basis size */
+        std::vector<double> cost(num_paw_atoms());
+        for (int i = 0; i < num_paw_atoms(); i++) {
+            auto& type = atom(paw_atom_index_[i]).type();
+            cost[i] = std::pow(type.mt_basis_size(), 2) * type.num_mt_points();
+        }
+        spl_num_paw_atoms_ = splindex<chunk>(num_paw_atoms(), comm_.size(), comm_.rank(),
+                                             split_by_cost(cost, comm_.size()));
     }
 
     /// Return number of PAW atoms.
@@ -259,7 +277,7 @@ class Unit_cell
     }
 
     /// Get split index of PAW atoms.
-    inline splindex<block> spl_num_paw_atoms() const
+    inline splindex<chunk> const& spl_num_paw_atoms() const
     {
         return spl_num_paw_atoms_;
     }
@@ -285,6 +303,9 @@ class Unit_cell
      *  atoms is then used to make a list of atom symmetry classes and related data. */
     inline void get_symmetry();
 
+    /// Run spglib for the current lattice vectors and atomic positions.
+    inline std::unique_ptr<Unit_cell_symmetry> find_symmetry();
+
     /// Write structure to CIF file.
     inline void write_cif();
 
@@ -737,6 +758,61 @@ inline void Unit_cell::initialize()
     //== }
 }
 
+inline void Unit_cell::update()
+{
+    PROFILE("sirius::Unit_cell::update");
+
+    auto v0 = lattice_vector(0);
+    auto v1 = lattice_vector(1);
+    auto v2 = lattice_vector(2);
+
+    double r = std::max(std::max(v0.length(), std::max(v1.length(), v2.length())),
+                        parameters_.parameters_input().nn_radius_);
+
+    find_nearest_neighbours(r);
+
+    if (parameters_.full_potential()) {
+        int ia, ja;
+        if (check_mt_overlap(ia, ja)) {
+            std::stringstream s;
+            s << "overlaping muffin-tin spheres for atoms " << ia << "(" << atom(ia).type().symbol() << ")"
+              << " and " << ja << "(" << atom(ja).type().symbol() << ")" << std::endl
+              << "  radius of atom " << ia << " : " << atom(ia).mt_radius() << std::endl
+              << "  radius of atom " << ja << " : " << atom(ja).mt_radius() << std::endl
+              << "  distance : " << nearest_neighbours_[ia][1].distance << " " << nearest_neighbours_[ja][1].distance;
+            TERMINATE(s);
+        }
+    }
+
+    if (parameters_.use_symmetry()) {
+        auto sym = find_symmetry();
+        if (sym->num_mag_sym() != symmetry_->num_mag_sym()) {
+            std::stringstream s;
+            s << "number of symmetry operations has changed from " << symmetry_->num_mag_sym() << " to "
+              << sym->num_mag_sym() << std::endl
+              << "  irreducible k-point set must be regenerated; start a new calculation";
+            TERMINATE(s);
+        }
+        /* atoms of each class must stay equivalent and atoms of different classes must stay non-equivalent */
+        if (!equivalent_atoms_.size()) {
+            bool same_classes{true};
+            std::set<int> ids;
+            for (auto& e : atom_symmetry_classes_) {
+                int id = sym->atom_symmetry_class(e.atom_id(0));
+                for (int i = 1; i < e.num_atoms(); i++) {
+                    same_classes &= (sym->atom_symmetry_class(e.atom_id(i)) == id);
+                }
+                ids.insert(id);
+            }
+            same_classes &= (static_cast<int>(ids.size()) == num_atom_symmetry_classes());
+            if (!same_classes) {
+                TERMINATE("atom symmetry classes have changed; start a new calculation");
+            }
+        }
+        symmetry_ = std::move(sym);
+    }
+}
+
 inline void Unit_cell::get_symmetry()
 {
     PROFILE("sirius::Unit_cell::get_symmetry");
@@ -756,21 +832,7 @@ inline void Unit_cell::get_symmetry()
         TERMINATE("Symmetry() object is already allocated");
     }
 
-    mdarray<double, 2> positions(3, num_atoms());
-    mdarray<double, 2> spins(3, num_atoms());
-    std::vector<int> types(num_atoms());
-    for (int ia = 0; ia < num_atoms(); ia++) {
-        auto vp = atom(ia).position();
-        auto vf = atom(ia).vector_field();
-        for (int x : {0, 1, 2}) {
-            positions(x, ia) = vp[x];
-            spins(x, ia)     = vf[x];
-        }
-        types[ia] = atom(ia).type_id();
-    }
-
-    symmetry_ = std::unique_ptr<Unit_cell_symmetry>(
-        new Unit_cell_symmetry(lattice_vectors_, num_atoms(), positions, spins, types, parameters_.spglib_tolerance()));
+    symmetry_ = find_symmetry();
 
     int atom_class_id{-1};
     std::vector<int> asc(num_atoms(), -1);
@@ -805,6 +867,25 @@ inline void Unit_cell::get_symmetry()
     assert(num_atom_symmetry_classes() != 0);
 }
 
+inline std::unique_ptr<Unit_cell_symmetry> Unit_cell::find_symmetry()
+{
+    mdarray<double, 2> positions(3, num_atoms());
+    mdarray<double, 2> spins(3, num_atoms());
+    std::vector<int> types(num_atoms());
+    for (int ia = 0; ia < num_atoms(); ia++) {
+        auto vp = atom(ia).position();
+        auto vf = atom(ia).vector_field();
+        for (int x : {0, 1, 2}) {
+            positions(x, ia) = vp[x];
+            spins(x, ia)     = vf[x];
+        }
+        types[ia] = atom(ia).type_id();
+    }
+
+    return std::unique_ptr<Unit_cell_symmetry>(
+        new Unit_cell_symmetry(lattice_vectors_, num_atoms(), positions, spins, types, parameters_.spglib_tolerance()));
+}
+
 inline std::vector<double> Unit_cell::find_mt_radii()
 {
     if (nearest_neighbours_.size() == 0) {
@@ -1311,14 +1392,164 @@ inline void Unit_cell::generate_radial_integrals()
         atom_symmetry_class(ic).sync_radial_integrals(comm_, rank);
     }
 
+    if (parameters_.processing_unit() == GPU) {
+        for (int ialoc = 0; ialoc < spl_num_atoms_.local_size(); ialoc++) {
+            int ia = spl_num_atoms_[ialoc];
+            atom(ia).generate_radial_integrals(parameters_.processing_unit(), mpi_comm_self());
+        }
+
+        for (int ia = 0; ia < num_atoms(); ia++) {
+            int rank = spl_num_atoms().local_rank(ia);
+            atom(ia).sync_radial_integrals(comm_, rank);
+        }
+        return;
+    }
+
+    /* Radial integrals
+     *   \int u_{i_1}(r) u_{i_2}(r) V_{\ell m}(r) r^2 dr = \sum_{r} w(r) u_{i_1}(r) u_{i_2}(r) V_{\ell m}(r)
+     * are computed for all local atoms of a symmetry class at once: the weighted products of radial functions
+     * are packed in a matrix P(r, i_1 i_2) and multiplied by the matrix of potential components V(r, \ell m) of all
+     * atoms. Pairs with even and odd \ell_1 + \ell_2 are contracted separately with even and odd \ell. */
+    int num_mag_dims = parameters_.num_mag_dims();
+    int lmmax        = Utils::lmmax(parameters_.lmax_pot());
+    auto l_by_lm     = Utils::l_by_lm(parameters_.lmax_pot());
+    double tol       = parameters_.settings().mt_radial_integrals_tol_;
+
+    std::vector<std::vector<int>> atoms_of_class(num_atom_symmetry_classes());
+    for (int ialoc = 0; ialoc < spl_num_atoms_.local_size(); ialoc++) {
+        int ia = spl_num_atoms_[ialoc];
+        atoms_of_class[atom(ia).symmetry_class_id()].push_back(ia);
+    }
+
+    for (int ic = 0; ic < num_atom_symmetry_classes(); ic++) {
+        if (atoms_of_class[ic].empty()) {
+            continue;
+        }
+        auto& asc   = atom_symmetry_class(ic);
+        auto& type  = asc.atom_type();
+        int nmtp    = type.num_mt_points();
+        int nrf     = type.indexr().size();
+        auto& w     = type.mt_integration_weights();
+
+        for (int ia: atoms_of_class[ic]) {
+            atom(ia).h_radial_integrals().zero();
+            if (num_mag_dims) {
+                atom(ia).b_radial_integrals().zero();
+            }
+            for (int i2 = 0; i2 < nrf; i2++) {
+                for (int i1 = 0; i1 <= i2; i1++) {
+                    if ((type.indexr(i1).l + type.indexr(i2).l) % 2 == 0) {
+                        atom(ia).h_radial_integrals()(0, i1, i2) = asc.h_spherical_integral(i1, i2);
+                        atom(ia).h_radial_integrals()(0, i2, i1) = asc.h_spherical_integral(i2, i1);
+                    }
+                }
+            }
+        }
+
+        for (int parity: {0, 1}) {
+            /* pairs of radial functions */
+            std::vector<std::pair<int, int>> pairs;
+            for (int i2 = 0; i2 < nrf; i2++) {
+                for (int i1 = 0; i1 <= i2; i1++) {
+                    if ((type.indexr(i1).l + type.indexr(i2).l) % 2 == parity) {
+                        pairs.push_back(std::make_pair(i1, i2));
+                    }
+                }
+            }
+            /* potential components: atom, lm and component of the effective field (0 for the potential) */
+            std::vector<std::array<int, 3>> cols;
+            for (int ia: atoms_of_class[ic]) {
+                for (int j = 0; j < num_mag_dims + 1; j++) {
+                    auto& v = (j == 0) ? atom(ia).veff() : atom(ia).beff(j - 1);
+                    for (int lm = 0; lm < lmmax; lm++) {
+                        /* spherical part of the potential enters the spherical integrals */
+                        if (l_by_lm[lm] % 2 != parity || (j == 0 && lm == 0)) {
+                            continue;
+                        }
+                        double vmax{0};
+                        for (int ir = 0; ir < nmtp; ir++) {
+                            vmax = std::max(vmax, std::abs(v(lm, ir)));
+                        }
+                        if (vmax >= tol) {
+                            cols.push_back({ia, lm, j});
+                        }
+                    }
+                }
+            }
+            int npairs = static_cast<int>(pairs.size());
+            int ncols  = static_cast<int>(cols.size());
+            if (npairs == 0 || ncols == 0) {
+                continue;
+            }
+
+            matrix<double> p(nmtp, npairs);
+            #pragma omp parallel for schedule(static)
+            for (int k = 0; k < npairs; k++) {
+                for (int ir = 0; ir < nmtp; ir++) {
+                    p(ir, k) = w(ir) * asc.radial_function(ir, pairs[k].first) * asc.radial_function(ir, pairs[k].second);
+                }
+            }
+            matrix<double> v(nmtp, ncols);
+            #pragma omp parallel for schedule(static)
+            for (int k = 0; k < ncols; k++) {
+                int ia = cols[k][0];
+                int lm = cols[k][1];
+                int j  = cols[k][2];
+                auto& vj = (j == 0) ? atom(ia).veff() : atom(ia).beff(j - 1);
+                for (int ir = 0; ir < nmtp; ir++) {
+                    v(ir, k) = vj(lm, ir);
+                }
+            }
+            matrix<double> result(npairs, ncols);
+            linalg<CPU>::gemm(1, 0, npairs, ncols, nmtp, p, v, result);
+
+            for (int k = 0; k < ncols; k++) {
+                int ia = cols[k][0];
+                int lm = cols[k][1];
+                int j  = cols[k][2];
+                for (int n = 0; n < npairs; n++) {
+                    int i1 = pairs[n].first;
+                    int i2 = pairs[n].second;
+                    if (j == 0) {
+                        atom(ia).h_radial_integrals()(lm, i1, i2) = atom(ia).h_radial_integrals()(lm, i2, i1) = result(n, k);
+                    } else {
+                        atom(ia).b_radial_integrals()(lm, i1, i2, j - 1) =
+                            atom(ia).b_radial_integrals()(lm, i2, i1, j - 1) = result(n, k);
+                    }
+                }
+            }
+        }
+    }
+
+    /* collect the integrals of all atoms with a single gather; local atoms are stored contiguously */
+    std::vector<size_t> offset(num_atoms() + 1, 0);
+    for (int ia = 0; ia < num_atoms(); ia++) {
+        offset[ia + 1] = offset[ia] + atom(ia).h_radial_integrals().size() + atom(ia).b_radial_integrals().size();
+    }
+    std::vector<double> buf(offset.back());
     for (int ialoc = 0; ialoc < spl_num_atoms_.local_size(); ialoc++) {
         int ia = spl_num_atoms_[ialoc];
-        atom(ia).generate_radial_integrals(parameters_.processing_unit(), mpi_comm_self());
+        auto& h = atom(ia).h_radial_integrals();
+        std::copy(h.at<CPU>(), h.at<CPU>() + h.size(), &buf[offset[ia]]);
+        if (num_mag_dims) {
+            auto& b = atom(ia).b_radial_integrals();
+            std::copy(b.at<CPU>(), b.at<CPU>() + b.size(), &buf[offset[ia] + h.size()]);
+        }
     }
+    int ia0 = (spl_num_atoms_.local_size()) ? spl_num_atoms_[0] : 0;
+    int ia1 = ia0 + spl_num_atoms_.local_size();
+    comm_.allgather(buf.data(), static_cast<int>(offset[ia0]), static_cast<int>(offset[ia1] - offset[ia0]));
 
     for (int ia = 0; ia < num_atoms(); ia++) {
-        int rank = spl_num_atoms().local_rank(ia);
-        atom(ia).sync_radial_integrals(comm_, rank);
+        auto& h = atom(ia).h_radial_integrals();
+        std::copy(&buf[offset[ia]], &buf[offset[ia]] + h.size(), h.at<CPU>());
+        if (num_mag_dims) {
+            auto& b = atom(ia).b_radial_integrals();
+            std::copy(&buf[offset[ia] + h.size()], &buf[offset[ia] + h.size()] + b.size(), b.at<CPU>());
+        }
+        if (parameters_.control().print_checksum_ && comm_.rank() == 0) {
+            DUMP("checksum(h_radial_integrals): %18.10f", h.checksum());
+        }
     }
 }
 
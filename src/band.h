@@ -32,6 +32,10 @@
 #include "hubbard.hpp"
 #include "Hamiltonian.h"
 
+#ifdef __MKL
+#include <mkl_service.h>
+#endif
+
 namespace sirius {
 
 // TODO: Band problem is a mess and needs more formal organizaiton. We have different basis functions.
@@ -65,15 +69,25 @@ class Band
     inline int solve_with_single_variation(K_point& kp__, Hamiltonian& hamiltonian__) const;
 
     /// Solve the band diagonalziation problem with second variation approach.
-    /** This is only used by the FP-LAPW method. */
-    inline void solve_with_second_variation(K_point& kp__, Hamiltonian& hamiltonian__) const;
+    /** This is only used by the FP-LAPW method. First-variational problems of all local k-points are solved
+     *  before the second-variational problems, which are then handled as a single batch.
+     *  Returns the total number of iterations of the first-variational iterative solver. */
+    inline int solve_with_second_variation(K_point_set& kset__, Hamiltonian& hamiltonian__) const;
+
+    /// Setup the second-variational Hamiltonian of a k-point.
+    /** One matrix per spin block is returned in the collinear case and a single \f$ 2N_{fv} \times 2N_{fv} \f$
+     *  matrix in the non-collinear case. */
+    inline void set_sv_h(K_point* kp__, Hamiltonian& hamiltonian__, std::vector<dmatrix<double_complex>>& h__) const;
 
     /// Solve the first-variational (non-magnetic) problem with exact diagonalization.
     /** This is only used by the LAPW method. */
     inline void diag_fv_exact(K_point* kp__, Hamiltonian& hamiltonian__) const;
 
     /// Solve the first-variational (non-magnetic) problem with iterative Davidson diagonalization.
-    inline void diag_fv_davidson(K_point* kp__, Hamiltonian& hamiltonian__) const;
+    /** This is a matrix-free solver: the LAPW Hamiltonian and overlap operators are applied to the trial
+     *  wave-functions by Hamiltonian::apply_fv_h_o() and full \f$ N_{G+k} \times N_{G+k} \f$ matrices are never
+     *  constructed. Returns the number of iterations. */
+    inline int diag_fv_davidson(K_point* kp__, Hamiltonian& hamiltonian__) const;
 
     /// Get singular components of the LAPW overlap matrix.
     /** Singular components are the eigen-vectors with a very small eigen-value. */
@@ -120,108 +134,159 @@ class Band
                          Wave_functions& opsi__,
                          Wave_functions& res__,
                          mdarray<double, 2>& h_diag__,
-                         mdarray<double, 1>& o_diag__) const;
-
-    /** Compute \f$ O_{ii'} = \langle \phi_i | \hat O | \phi_{i'} \rangle \f$ operator matrix
-     *  for the subspace spanned by the wave-functions \f$ \phi_i \f$. The matrix is always returned
-     *  in the CPU pointer because most of the standard math libraries start from the CPU. */
+                         mdarray<double, 1>& o_diag__,
+                         linalg_precision_t prec__ = linalg_precision_t::fp64) const;
+
+    /// Orthogonalize the new basis functions and compute the new block of the subspace Hamiltonian in a single pass.
+    /** The old basis functions \f$ \phi_{old} \f$ are expected to be S-orthonormal and the old Hamiltonian block
+     *  must be stored in hmlt_old. The projections \f$ \langle \phi | \hat S | \phi_{new} \rangle \f$ and
+     *  \f$ \langle \phi | \hat H | \phi_{new} \rangle \f$ are computed in one pass over the basis. The
+     *  orthogonalization coefficients and the new block of the Hamiltonian are then obtained from these small matrices
+     *  and phi, hphi and sphi are updated with a single transformation each. Returns false (and leaves everything
+     *  untouched) if the Cholesky factorization of the projected overlap fails. Works with a non-distributed subspace
+     *  matrix on CPU. */
+    template <typename T>
+    inline bool expand_subspace(int             ispn__,
+                                int             N__,
+                                int             n__,
+                                Wave_functions& phi__,
+                                Wave_functions& hphi__,
+                                Wave_functions& sphi__,
+                                dmatrix<T>&     hmlt__,
+                                dmatrix<T>&     hmlt_old__,
+                                Wave_functions& tmp__) const;
+
+    /** Compute \f$ O_{ii'} = \langle \phi_i | \hat O | \phi_{i'} \rangle \f$ operator matrices
+     *  for the subspace spanned by the wave-functions \f$ \phi_i \f$. Several Hermitian operators can be given at
+     *  once; in this case the inner products share the same MPI reduction. Only the upper part of the new block is
+     *  computed, the lower part is restored by Hermitian symmetry. The matrix is always returned
+     *  in the CPU pointer because most of the standard math libraries start from the CPU. The new block of the
+     *  matrix can be computed in single precision (see sddk::linalg_precision_t). */
     template <typename T>
     inline void set_subspace_mtrx(int N__,
                                   int n__,
                                   Wave_functions& phi__,
-                                  Wave_functions& op_phi__,
-                                  dmatrix<T>& mtrx__,
-                                  dmatrix<T>& mtrx_old__) const
+                                  std::vector<Wave_functions*> op_phi__,
+                                  std::vector<dmatrix<T>*> mtrx__,
+                                  std::vector<dmatrix<T>*> mtrx_old__,
+                                  linalg_precision_t prec__ = linalg_precision_t::fp64) const
     {
         PROFILE("sirius::Band::set_subspace_mtrx");
 
         assert(n__ != 0);
-        if (mtrx_old__.size()) {
-            assert(&mtrx__.blacs_grid() == &mtrx_old__.blacs_grid());
-        }
+        assert(op_phi__.size() == mtrx__.size());
+        assert(op_phi__.size() == mtrx_old__.size());
 
-        /* copy old N x N distributed matrix */
-        if (N__ > 0) {
-            splindex<block_cyclic> spl_row(N__, mtrx__.blacs_grid().num_ranks_row(), mtrx__.blacs_grid().rank_row(),
-                                           mtrx__.bs_row());
-            splindex<block_cyclic> spl_col(N__, mtrx__.blacs_grid().num_ranks_col(), mtrx__.blacs_grid().rank_col(),
-                                           mtrx__.bs_col());
+        for (size_t k = 0; k < mtrx__.size(); k++) {
+            auto& mtrx = *mtrx__[k];
+            auto& mtrx_old = *mtrx_old__[k];
 
-            #pragma omp parallel for schedule(static)
-            for (int i = 0; i < spl_col.local_size(); i++) {
-                std::copy(&mtrx_old__(0, i), &mtrx_old__(0, i) + spl_row.local_size(), &mtrx__(0, i));
+            if (mtrx_old.size()) {
+                assert(&mtrx.blacs_grid() == &mtrx_old.blacs_grid());
             }
 
-            if (ctx_.control().print_checksum_) {
-                double_complex cs(0, 0);
+            /* copy old N x N distributed matrix */
+            if (N__ > 0) {
+                splindex<block_cyclic> spl_row(N__, mtrx.blacs_grid().num_ranks_row(), mtrx.blacs_grid().rank_row(),
+                                               mtrx.bs_row());
+                splindex<block_cyclic> spl_col(N__, mtrx.blacs_grid().num_ranks_col(), mtrx.blacs_grid().rank_col(),
+                                               mtrx.bs_col());
+
+                #pragma omp parallel for schedule(static)
                 for (int i = 0; i < spl_col.local_size(); i++) {
-                    for (int j = 0; j < spl_row.local_size(); j++) {
-                        cs += mtrx__(j, i);
-                    }
+                    std::copy(&mtrx_old(0, i), &mtrx_old(0, i) + spl_row.local_size(), &mtrx(0, i));
                 }
-                mtrx__.blacs_grid().comm().allreduce(&cs, 1);
-                if (ctx_.comm_band().rank() == 0) {
-                    print_checksum("subspace_mtrx_old", cs);
+
+                if (ctx_.control().print_checksum_) {
+                    double_complex cs(0, 0);
+                    for (int i = 0; i < spl_col.local_size(); i++) {
+                        for (int j = 0; j < spl_row.local_size(); j++) {
+                            cs += mtrx(j, i);
+                        }
+                    }
+                    mtrx.blacs_grid().comm().allreduce(&cs, 1);
+                    if (ctx_.comm_band().rank() == 0) {
+                        print_checksum("subspace_mtrx_old", cs);
+                    }
                 }
             }
         }
 
         /* <{phi,phi_new}|Op|phi_new> */
-        inner(ctx_.processing_unit(), (ctx_.num_mag_dims() == 3) ? 2 : 0, phi__, 0, N__ + n__, op_phi__, N__, n__,
-              mtrx__, 0, N__);
-
-        /* restore lower part */
-        if (N__ > 0) {
-            if (mtrx__.blacs_grid().comm().size() == 1) {
-                #pragma omp parallel for
-                for (int i = 0; i < N__; i++) {
-                    for (int j = N__; j < N__ + n__; j++) {
-                        mtrx__(j, i) = type_wrapper<T>::bypass(std::conj(mtrx__(i, j)));
+        std::vector<Wave_functions*> bra(op_phi__.size(), &phi__);
+        inner<T>(ctx_.processing_unit(), (ctx_.num_mag_dims() == 3) ? 2 : 0, bra, 0, N__ + n__, op_phi__, N__, n__,
+                 mtrx__, 0, N__, true, prec__);
+
+        for (size_t k = 0; k < mtrx__.size(); k++) {
+            auto& mtrx = *mtrx__[k];
+            auto& mtrx_old = *mtrx_old__[k];
+
+            /* restore lower part */
+            if (N__ > 0) {
+                if (mtrx.blacs_grid().comm().size() == 1) {
+                    #pragma omp parallel for
+                    for (int i = 0; i < N__; i++) {
+                        for (int j = N__; j < N__ + n__; j++) {
+                            mtrx(j, i) = type_wrapper<T>::bypass(std::conj(mtrx(i, j)));
+                        }
                     }
-                }
-            } else {
+                } else {
 #ifdef __SCALAPACK
-                linalg<CPU>::tranc(n__, N__, mtrx__, 0, N__, mtrx__, N__, 0);
+                    linalg<CPU>::tranc(n__, N__, mtrx, 0, N__, mtrx, N__, 0);
 #else
-                TERMINATE_NO_SCALAPACK
+                    TERMINATE_NO_SCALAPACK
 #endif
+                }
             }
-        }
 
-        if (ctx_.control().print_checksum_) {
-            splindex<block_cyclic> spl_row(N__ + n__, mtrx__.blacs_grid().num_ranks_row(),
-                                           mtrx__.blacs_grid().rank_row(), mtrx__.bs_row());
-            splindex<block_cyclic> spl_col(N__ + n__, mtrx__.blacs_grid().num_ranks_col(),
-                                           mtrx__.blacs_grid().rank_col(), mtrx__.bs_col());
-            double_complex cs(0, 0);
-            for (int i = 0; i < spl_col.local_size(); i++) {
-                for (int j = 0; j < spl_row.local_size(); j++) {
-                    cs += mtrx__(j, i);
+            if (ctx_.control().print_checksum_) {
+                splindex<block_cyclic> spl_row(N__ + n__, mtrx.blacs_grid().num_ranks_row(),
+                                               mtrx.blacs_grid().rank_row(), mtrx.bs_row());
+                splindex<block_cyclic> spl_col(N__ + n__, mtrx.blacs_grid().num_ranks_col(),
+                                               mtrx.blacs_grid().rank_col(), mtrx.bs_col());
+                double_complex cs(0, 0);
+                for (int i = 0; i < spl_col.local_size(); i++) {
+                    for (int j = 0; j < spl_row.local_size(); j++) {
+                        cs += mtrx(j, i);
+                    }
+                }
+                mtrx.blacs_grid().comm().allreduce(&cs, 1);
+                if (ctx_.comm_band().rank() == 0) {
+                    print_checksum("subspace_mtrx", cs);
                 }
             }
-            mtrx__.blacs_grid().comm().allreduce(&cs, 1);
-            if (ctx_.comm_band().rank() == 0) {
-                print_checksum("subspace_mtrx", cs);
-            }
-        }
 
-        /* kill any numerical noise */
-        mtrx__.make_real_diag(N__ + n__);
+            /* kill any numerical noise */
+            mtrx.make_real_diag(N__ + n__);
 
-        /* save new matrix */
-        if (mtrx_old__.size()) {
-            splindex<block_cyclic> spl_row(N__ + n__, mtrx__.blacs_grid().num_ranks_row(),
-                                           mtrx__.blacs_grid().rank_row(), mtrx__.bs_row());
-            splindex<block_cyclic> spl_col(N__ + n__, mtrx__.blacs_grid().num_ranks_col(),
-                                           mtrx__.blacs_grid().rank_col(), mtrx__.bs_col());
+            /* save new matrix */
+            if (mtrx_old.size()) {
+                splindex<block_cyclic> spl_row(N__ + n__, mtrx.blacs_grid().num_ranks_row(),
+                                               mtrx.blacs_grid().rank_row(), mtrx.bs_row());
+                splindex<block_cyclic> spl_col(N__ + n__, mtrx.blacs_grid().num_ranks_col(),
+                                               mtrx.blacs_grid().rank_col(), mtrx.bs_col());
 
-            #pragma omp parallel for schedule(static)
-            for (int i = 0; i < spl_col.local_size(); i++) {
-                std::copy(&mtrx__(0, i), &mtrx__(0, i) + spl_row.local_size(), &mtrx_old__(0, i));
+                #pragma omp parallel for schedule(static)
+                for (int i = 0; i < spl_col.local_size(); i++) {
+                    std::copy(&mtrx(0, i), &mtrx(0, i) + spl_row.local_size(), &mtrx_old(0, i));
+                }
             }
         }
     }
 
+    /// Compute the subspace matrix of a single operator.
+    template <typename T>
+    inline void set_subspace_mtrx(int N__,
+                                  int n__,
+                                  Wave_functions& phi__,
+                                  Wave_functions& op_phi__,
+                                  dmatrix<T>& mtrx__,
+                                  dmatrix<T>& mtrx_old__,
+                                  linalg_precision_t prec__ = linalg_precision_t::fp64) const
+    {
+        set_subspace_mtrx<T>(N__, n__, phi__, {&op_phi__}, {&mtrx__}, {&mtrx_old__}, prec__);
+    }
+
     /// Diagonalize a pseudo-potential Hamiltonian.
     template <typename T>
     int diag_pseudo_potential(K_point* kp__, Hamiltonian& H__) const
@@ -334,6 +399,12 @@ class Band
     /// Solve second-variational problem.
     inline void diag_sv(K_point* kp, Hamiltonian& hamiltonian__) const;
 
+    /// Solve second-variational problems of all local k-points.
+    /** If the matrices are not distributed and the LAPACK solver is selected, Hamiltonians of all local k-points
+     *  are set up first and then diagonalized concurrently with one sequential eigen-solver call per thread.
+     *  Otherwise k-points are processed one by one. */
+    inline void diag_sv(K_point_set& kset__, Hamiltonian& hamiltonian__) const;
+
     /// Solve \f$ \hat H \psi = E \psi \f$ and find eigen-states of the Hamiltonian.
     inline void solve_for_kset(K_point_set& kset__, Hamiltonian& hamiltonian__, bool precompute__) const;
 
@@ -352,6 +423,7 @@ class Band
 };
 
 #include "Band/residuals.hpp"
+#include "Band/expand_subspace.hpp"
 #include "Band/diag_full_potential.hpp"
 #include "Band/diag_pseudo_potential.hpp"
 #include "Band/initialize_subspace.hpp"
@@ -325,7 +325,7 @@ class Density
         {
             PROFILE("sirius::Density::generate_pseudo_core_charge_density");
 
-            auto ri = Radial_integrals_rho_core_pseudo<false>(ctx_.unit_cell(), ctx_.pw_cutoff(), ctx_.settings().nprii_rho_core_);
+            auto& ri = ctx_.ps_core_ri();
 
             auto v = ctx_.make_periodic_function<index_domain_t::local>([&ri](int iat, double g)
                                                                         {
@@ -399,6 +399,22 @@ class Density
             }
         }
         
+        /// Update the position-dependent parts of the density after the atoms were moved.
+        inline void update()
+        {
+            PROFILE("sirius::Density::update");
+
+            if (rho_pseudo_core_ != nullptr) {
+                bool is_empty{true};
+                for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+                    is_empty &= unit_cell_.atom_type(iat).ps_core_charge_density().empty();
+                }
+                if (!is_empty) {
+                    generate_pseudo_core_charge_density();
+                }
+            }
+        }
+
         /// Set pointers to muffin-tin and interstitial charge density arrays
         void set_charge_density_ptr(double* rhomt, double* rhorg)
         {
@@ -30,6 +30,7 @@
 #include "k_point_set.h"
 #include "Geometry/force.hpp"
 #include "Geometry/stress.hpp"
+#include "Geometry/extrapolation.hpp"
 #include "json.hpp"
 #include "hubbard.hpp"
 
@@ -194,6 +195,21 @@ class DFT_ground_state
             }
         }
 
+        /// Update the position-dependent data of the ground state objects after the atoms were moved.
+        /** Simulation context must be updated first with Simulation_context::update_atomic_positions(). */
+        inline void update()
+        {
+            PROFILE("sirius::DFT_ground_state::update");
+
+            kset_.update();
+            potential_.update();
+            density_.update();
+
+            if (!ctx_.full_potential()) {
+                ewald_energy_ = ewald_energy();
+            }
+        }
+
         int find(double potential_tol, double energy_tol, int num_dft_iter, bool write_state);
 
         void print_info();
@@ -519,11 +535,7 @@ inline double DFT_ground_state::ewald_energy()
 
             double g2 = std::pow(ctx_.gvec().gvec_len(ig), 2);
 
-            double_complex rho(0, 0);
-
-            for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
-                rho += ctx_.gvec_phase_factor(ig, ia) * static_cast<double>(unit_cell_.atom(ia).zn());
-            }
+            double_complex rho = ctx_.ion_charge_structure_factor(igloc);
 
             ewald_g_pt += std::pow(std::abs(rho), 2) * std::exp(-g2 / 4 / alpha) / g2;
         }
@@ -25,6 +25,7 @@
 #ifndef __EIGENPROBLEM_H__
 #define __EIGENPROBLEM_H__
 
+#include <random>
 #include "constants.h"
 #include "linalg.hpp"
 
@@ -60,9 +61,61 @@ enum class ev_solver_t
     magma,
 
     /// PLASMA
-    plasma
+    plasma,
+
+    /// Chebyshev-filtered subspace iteration for the lowest eigen-pairs
+    chebyshev
 };
 
+/// Get type of the eigen-value solver by name.
+inline ev_solver_t get_ev_solver_t(std::string name__)
+{
+    std::map<std::string, ev_solver_t> m = {
+        {"lapack",    ev_solver_t::lapack},
+        {"scalapack", ev_solver_t::scalapack},
+        {"elpa1",     ev_solver_t::elpa1},
+        {"elpa2",     ev_solver_t::elpa2},
+        {"magma",     ev_solver_t::magma},
+        {"plasma",    ev_solver_t::plasma},
+        {"chebyshev", ev_solver_t::chebyshev}
+    };
+    if (m.count(name__) == 0) {
+        std::stringstream s;
+        s << "wrong eigen value solver " << name__;
+        TERMINATE(s);
+    }
+    return m[name__];
+}
+
+/// Get name of the eigen-value solver.
+inline std::string ev_solver_name(ev_solver_t type__)
+{
+    switch (type__) {
+        case ev_solver_t::lapack: {
+            return "lapack";
+        }
+        case ev_solver_t::scalapack: {
+            return "scalapack";
+        }
+        case ev_solver_t::elpa1: {
+            return "elpa1";
+        }
+        case ev_solver_t::elpa2: {
+            return "elpa2";
+        }
+        case ev_solver_t::magma: {
+            return "magma";
+        }
+        case ev_solver_t::plasma: {
+            return "plasma";
+        }
+        case ev_solver_t::chebyshev: {
+            return "chebyshev";
+        }
+    }
+    return "";
+}
+
 template <typename T>
 class Eigensolver
 {
@@ -108,7 +161,7 @@ class Eigensolver_lapack: public Eigensolver<T>
 {
   private:
 
-    std::array<ftn_int, 3> get_work_sizes(ftn_int matrix_size) const
+    static std::array<ftn_int, 3> get_work_sizes(ftn_int matrix_size)
     {
         std::array<ftn_int, 3> work_sizes;
 
@@ -125,51 +178,39 @@ class Eigensolver_lapack: public Eigensolver<T>
         return false;
     }
 
-    /// Solve a standard eigen-value problem for all eigen-pairs.
-    int solve(ftn_int matrix_size__, dmatrix<T>& A__, double* eval__, dmatrix<T>& Z__)
+    /// Find all eigen-pairs of the standard eigen-value problem with the divide and conquer LAPACK driver.
+    /** No timers are used, so the function can be called from an OpenMP parallel region. Returns the LAPACK
+     *  status. */
+    static int heevd(ftn_int matrix_size__, dmatrix<T>& A__, double* eval__, dmatrix<T>& Z__)
     {
-        sddk::timer t0("Eigensolver_lapack::solve_std");
-
-        auto work_sizes = get_work_sizes(matrix_size__);
-
         ftn_int info;
         ftn_int lda = A__.ld();
 
         if (std::is_same<T, double_complex>::value) {
+            auto work_sizes = get_work_sizes(matrix_size__);
+
             std::vector<double_complex> work(work_sizes[0]);
             std::vector<double> rwork(work_sizes[1]);
             std::vector<ftn_int> iwork(work_sizes[2]);
 
-            sddk::timer t1("Eigensolver_lapack::solve_std|zheevd");
             FORTRAN(zheevd)("V", "U", &matrix_size__, reinterpret_cast<double_complex*>(A__.template at<CPU>()),
-                            &lda, eval__, &work[0], &work_sizes[0], &rwork[0], &work_sizes[1], 
+                            &lda, eval__, &work[0], &work_sizes[0], &rwork[0], &work_sizes[1],
                             &iwork[0], &work_sizes[2], &info, (ftn_int)1, (ftn_int)1);
-
-            if (info) {
-                std::stringstream s;
-                s << "zheevd returned " << info; 
-                TERMINATE(s);
-            }
         }
 
         if (std::is_same<T, double>::value) {
+            ftn_int lwork  = 1 + 6 * matrix_size__ + 2 * matrix_size__ * matrix_size__;
+            ftn_int liwork = 3 + 5 * matrix_size__;
 
-            int32_t lwork = 1 + 6 * matrix_size__ + 2 * matrix_size__ * matrix_size__;
-            int32_t liwork = 3 + 5 * matrix_size__; 
-            
             std::vector<double> work(lwork);
-            std::vector<int32_t> iwork(liwork);
+            std::vector<ftn_int> iwork(liwork);
 
-            sddk::timer t1("Eigensolver_lapack::solve_std|dsyevd");
             FORTRAN(dsyevd)("V", "U", &matrix_size__, reinterpret_cast<double*>(A__.template at<CPU>()), &lda,
-                            eval__, &work[0], &lwork, 
-                            &iwork[0], &liwork, &info, (ftn_int)1, (ftn_int)1);
-            
-            if (info) {
-                std::stringstream s;
-                s << "dsyevd returned " << info; 
-                TERMINATE(s);
-            }
+                            eval__, &work[0], &lwork, &iwork[0], &liwork, &info, (ftn_int)1, (ftn_int)1);
+        }
+
+        if (info) {
+            return info;
         }
 
         for (int i = 0; i < matrix_size__; i++) {
@@ -179,6 +220,20 @@ class Eigensolver_lapack: public Eigensolver<T>
         return 0;
     }
 
+    /// Solve a standard eigen-value problem for all eigen-pairs.
+    int solve(ftn_int matrix_size__, dmatrix<T>& A__, double* eval__, dmatrix<T>& Z__)
+    {
+        sddk::timer t0("Eigensolver_lapack::solve_std");
+
+        if (int info = heevd(matrix_size__, A__, eval__, Z__)) {
+            std::stringstream s;
+            s << (std::is_same<T, double_complex>::value ? "zheevd" : "dsyevd") << " returned " << info;
+            TERMINATE(s);
+        }
+
+        return 0;
+    }
+
     /// Solve a standard eigen-value problem for N lowest eigen-pairs.
     int solve(ftn_int matrix_size__, ftn_int nev__, dmatrix<T>& A__, double* eval__, dmatrix<T>& Z__)
     {
@@ -341,6 +396,401 @@ class Eigensolver_lapack: public Eigensolver<T>
     }
 };
 
+/// Chebyshev-filtered subspace iteration for the lowest eigen-pairs.
+/** The generalized problem is reduced to the standard form \f$ \tilde A = U^{-H} A U^{-1} \f$ with the Cholesky
+ *  factor of the overlap matrix \f$ B = U^{H} U \f$. The lowest eigen-pairs of \f$ \tilde A \f$ are found by the
+ *  subspace iteration with the polynomial filter which damps the unwanted part of the spectrum
+ *  [Y. Zhou, Y. Saad, M. L. Tiago, J. R. Chelikowsky, J. Comp. Phys. 219, 172 (2006)]. Only the products of
+ *  the N x N matrix with the N x (nev + buffer) block of vectors are computed; the full reduction of the matrix to
+ *  the tridiagonal form is avoided.
+ *
+ *  The filter acts on each vector of the subspace independently. Sequential solvers are called by all ranks of
+ *  the band communicator with the replicated matrices, so the vectors are split between the ranks of the
+ *  communicator, which is passed to the constructor, and gathered before the Rayleigh-Ritz step.
+ *
+ *  Non-zero input vectors Z (eigen-vectors of the previous SCF iteration) are used as a starting guess. If the
+ *  subspace iteration does not converge, the reduced problem is solved with LAPACK. */
+template <typename T>
+class Eigensolver_chebyshev: public Eigensolver<T>
+{
+  private:
+    /// Communicator of the ranks which share the work.
+    Communicator const& comm_;
+
+    /// Degree of the filter polynomial.
+    int degree_;
+
+    /// Tolerance on the residual norm of the eigen-pairs of the reduced problem.
+    double tol_;
+
+    /// Maximum number of filter applications.
+    int num_iter_;
+
+    /// Generator of the random starting vectors; identical sequence on all ranks.
+    mutable std::mt19937 rng_{1234};
+
+    static inline double conj(double x__)
+    {
+        return x__;
+    }
+
+    static inline double_complex conj(double_complex z__)
+    {
+        return std::conj(z__);
+    }
+
+    static inline void set_random(double& v__, double x__, double y__)
+    {
+        v__ = x__;
+    }
+
+    static inline void set_random(double_complex& v__, double x__, double y__)
+    {
+        v__ = double_complex(x__, y__);
+    }
+
+    inline T random() const
+    {
+        std::uniform_real_distribution<double> d(-0.5, 0.5);
+        double x = d(rng_);
+        double y = d(rng_);
+        T v;
+        set_random(v, x, y);
+        return v;
+    }
+
+    /// Gather the columns of the n x m matrix X with the leading dimension n; this rank holds the columns [j0, j0 + nc).
+    inline void allgather_columns(int n__, int j0__, int nc__, matrix<T>& X__) const
+    {
+        size_t offs = static_cast<size_t>(n__) * j0__;
+        size_t size = static_cast<size_t>(n__) * nc__;
+        /* MPI offsets and counts are of type int */
+        if (offs + size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+            std::stringstream s;
+            s << "matrix is too large for the Chebyshev solver: " << n__ << " rows, " << j0__ + nc__ << " columns";
+            TERMINATE(s);
+        }
+        comm_.allgather(X__.template at<CPU>(), static_cast<int>(offs), static_cast<int>(size));
+    }
+
+    /// Compute Y = A X for the local columns of X and gather the result.
+    inline void multiply(int n__, int m__, T* A__, int lda__, matrix<T>& X__, matrix<T>& Y__) const
+    {
+        splindex<block> spl(m__, comm_.size(), comm_.rank());
+        if (spl.local_size()) {
+            linalg<CPU>::gemm(0, 0, n__, spl.local_size(), n__, A__, lda__, X__.template at<CPU>(0, spl.global_offset()), X__.ld(),
+                              Y__.template at<CPU>(0, spl.global_offset()), Y__.ld());
+        }
+        allgather_columns(n__, spl.global_offset(), spl.local_size(), Y__);
+    }
+
+    /// Upper bound of the spectrum from the short Lanczos run.
+    inline double upper_bound(int n__, T* A__, int lda__) const
+    {
+        int k = std::min(n__, 20);
+
+        matrix<T> v(n__, 3);
+        v.zero();
+        double nrm{0};
+        for (int i = 0; i < n__; i++) {
+            v(i, 1) = random();
+            nrm += std::pow(std::abs(v(i, 1)), 2);
+        }
+        for (int i = 0; i < n__; i++) {
+            v(i, 1) /= std::sqrt(nrm);
+        }
+
+        std::vector<double> alpha;
+        std::vector<double> beta;
+        double b{0};
+        for (int j = 0; j < k; j++) {
+            /* w = A v_j */
+            linalg<CPU>::gemm(0, 0, n__, 1, n__, A__, lda__, &v(0, 1), v.ld(), &v(0, 2), v.ld());
+            double a{0};
+            for (int i = 0; i < n__; i++) {
+                a += std::real(std::conj(v(i, 1)) * v(i, 2));
+            }
+            /* w = w - a v_j - b v_{j-1} */
+            nrm = 0;
+            for (int i = 0; i < n__; i++) {
+                v(i, 2) -= (a * v(i, 1) + b * v(i, 0));
+                nrm += std::pow(std::abs(v(i, 2)), 2);
+            }
+            b = std::sqrt(nrm);
+            alpha.push_back(a);
+            beta.push_back(b);
+            if (b < 1e-12) {
+                break;
+            }
+            for (int i = 0; i < n__; i++) {
+                v(i, 0) = v(i, 1);
+                v(i, 1) = v(i, 2) / b;
+            }
+        }
+        k = static_cast<int>(alpha.size());
+
+        dmatrix<double> t(k, k);
+        dmatrix<double> z(k, k);
+        t.zero();
+        for (int j = 0; j < k; j++) {
+            t(j, j) = alpha[j];
+            if (j + 1 < k) {
+                t(j, j + 1) = t(j + 1, j) = beta[j];
+            }
+        }
+        std::vector<double> theta(k);
+        Eigensolver_lapack<double>().solve(k, t, theta.data(), z);
+
+        return theta.back() + beta.back();
+    }
+
+    /// Orthonormalize the columns with the shifted Cholesky QR followed by two unshifted passes.
+    inline bool orthonormalize(int n__, int m__, matrix<T>& X__) const
+    {
+        matrix<T> s(m__, m__);
+        for (int pass = 0; pass < 3; pass++) {
+            linalg<CPU>::gemm(2, 0, m__, m__, n__, X__.template at<CPU>(), X__.ld(), X__.template at<CPU>(), X__.ld(), s.template at<CPU>(), s.ld());
+            if (pass == 0) {
+                double tr{0};
+                for (int i = 0; i < m__; i++) {
+                    tr += std::real(s(i, i));
+                }
+                double shift = 11 * (double(n__) * m__ + double(m__) * (m__ + 1)) *
+                               std::numeric_limits<double>::epsilon() * tr;
+                for (int i = 0; i < m__; i++) {
+                    s(i, i) += shift;
+                }
+            }
+            if (linalg<CPU>::potrf(m__, s.template at<CPU>(), s.ld())) {
+                return false;
+            }
+            if (linalg<CPU>::trtri(m__, s.template at<CPU>(), s.ld())) {
+                return false;
+            }
+            linalg<CPU>::trmm('R', 'U', 'N', n__, m__, linalg_const<T>::one(), s.template at<CPU>(), s.ld(), X__.template at<CPU>(), X__.ld());
+        }
+        return true;
+    }
+
+    /// Rotate the orthonormal basis X and the product AX to the Ritz vectors.
+    inline void rayleigh_ritz(int n__, int m__, matrix<T>& X__, matrix<T>& AX__, std::vector<double>& theta__,
+                              matrix<T>& tmp__) const
+    {
+        dmatrix<T> h(m__, m__);
+        dmatrix<T> q(m__, m__);
+        linalg<CPU>::gemm(2, 0, m__, m__, n__, X__.template at<CPU>(), X__.ld(), AX__.template at<CPU>(), AX__.ld(), h.template at<CPU>(), h.ld());
+        Eigensolver_lapack<T>().solve(m__, h, theta__.data(), q);
+
+        for (auto e : {&X__, &AX__}) {
+            linalg<CPU>::gemm(0, 0, n__, m__, m__, e->template at<CPU>(), e->ld(), q.template at<CPU>(), q.ld(),
+                              tmp__.template at<CPU>(), tmp__.ld());
+            std::copy(tmp__.template at<CPU>(), tmp__.template at<CPU>() + tmp__.size(), e->template at<CPU>());
+        }
+    }
+
+    /// Replace the columns [k0, m) of X by p(A) X, where p is the scaled Chebyshev polynomial which damps [a, b].
+    /** Polynomial is normalized at the point a0 below the interval. */
+    inline void filter(int n__, int k0__, int m__, T* A__, int lda__, matrix<T>& X__, double a0__, double a__,
+                       double b__) const
+    {
+        splindex<block> spl(m__ - k0__, comm_.size(), comm_.rank());
+        int nc = spl.local_size();
+        int j0 = k0__ + spl.global_offset();
+
+        if (nc) {
+            double e = (b__ - a__) / 2;
+            double c = (b__ + a__) / 2;
+            double sigma = e / (a0__ - c);
+            double tau = 2 / sigma;
+
+            std::array<matrix<T>, 3> y;
+            for (auto& yk : y) {
+                yk = matrix<T>(n__, nc);
+            }
+            std::copy(X__.template at<CPU>(0, j0), X__.template at<CPU>(0, j0) + static_cast<size_t>(n__) * nc,
+                      y[0].template at<CPU>());
+
+            /* y_1 = (A - c) y_0 sigma / e */
+            linalg<CPU>::gemm(0, 0, n__, nc, n__, A__, lda__, y[0].template at<CPU>(), y[0].ld(), y[1].template at<CPU>(), y[1].ld());
+            #pragma omp parallel for schedule(static)
+            for (int j = 0; j < nc; j++) {
+                for (int i = 0; i < n__; i++) {
+                    y[1](i, j) = (y[1](i, j) - c * y[0](i, j)) * (sigma / e);
+                }
+            }
+            int i0{0}, i1{1}, i2{2};
+            for (int k = 2; k <= degree_; k++) {
+                double sigma1 = 1 / (tau - sigma);
+                /* y_{k} = 2 sigma1 / e (A - c) y_{k-1} - sigma sigma1 y_{k-2} */
+                linalg<CPU>::gemm(0, 0, n__, nc, n__, A__, lda__, y[i1].template at<CPU>(), y[i1].ld(), y[i2].template at<CPU>(), y[i2].ld());
+                #pragma omp parallel for schedule(static)
+                for (int j = 0; j < nc; j++) {
+                    for (int i = 0; i < n__; i++) {
+                        y[i2](i, j) = (y[i2](i, j) - c * y[i1](i, j)) * (2 * sigma1 / e) - (sigma * sigma1) * y[i0](i, j);
+                    }
+                }
+                sigma = sigma1;
+                std::swap(i0, i1);
+                std::swap(i1, i2);
+            }
+            std::copy(y[i1].template at<CPU>(), y[i1].template at<CPU>() + static_cast<size_t>(n__) * nc,
+                      X__.template at<CPU>(0, j0));
+        }
+        allgather_columns(n__, j0, nc, X__);
+    }
+
+    /// Find the lowest eigen-pairs of the Hermitian matrix A; X contains the starting guess.
+    bool subspace_iteration(int n__, int m__, int nev__, T* A__, int lda__, matrix<T>& X__, double* eval__) const
+    {
+        matrix<T> AX(n__, m__);
+        matrix<T> tmp(n__, m__);
+        std::vector<double> theta(m__);
+
+        if (!orthonormalize(n__, m__, X__)) {
+            return false;
+        }
+        multiply(n__, m__, A__, lda__, X__, AX);
+        rayleigh_ritz(n__, m__, X__, AX, theta, tmp);
+
+        double b = upper_bound(n__, A__, lda__);
+
+        for (int iter = 0; iter < num_iter_; iter++) {
+            /* residuals of the wanted pairs */
+            std::vector<double> res(nev__);
+            #pragma omp parallel for schedule(static)
+            for (int j = 0; j < nev__; j++) {
+                double r{0};
+                for (int i = 0; i < n__; i++) {
+                    r += std::pow(std::abs(AX(i, j) - theta[j] * X__(i, j)), 2);
+                }
+                res[j] = std::sqrt(r);
+            }
+            /* leading converged pairs are locked: they are not filtered any more */
+            int k0{0};
+            while (k0 < nev__ && res[k0] < tol_) {
+                k0++;
+            }
+            if (k0 == nev__) {
+                std::copy(theta.begin(), theta.begin() + nev__, eval__);
+                return true;
+            }
+            if (theta[m__ - 1] >= b) {
+                return false;
+            }
+            filter(n__, k0, m__, A__, lda__, X__, theta[0], theta[m__ - 1], b);
+            if (!orthonormalize(n__, m__, X__)) {
+                return false;
+            }
+            multiply(n__, m__, A__, lda__, X__, AX);
+            rayleigh_ritz(n__, m__, X__, AX, theta, tmp);
+        }
+        return false;
+    }
+
+  public:
+    Eigensolver_chebyshev(Communicator const& comm__ = mpi_comm_self(), int degree__ = 10, double tol__ = 1e-8,
+                          int num_iter__ = 50)
+        : comm_(comm__)
+        , degree_(degree__)
+        , tol_(tol__)
+        , num_iter_(num_iter__)
+    {
+    }
+
+    inline bool is_parallel()
+    {
+        return false;
+    }
+
+    /// Solve a standard eigen-value problem for N lowest eigen-pairs.
+    int solve(ftn_int matrix_size__, ftn_int nev__, dmatrix<T>& A__, double* eval__, dmatrix<T>& Z__)
+    {
+        sddk::timer t0("Eigensolver_chebyshev::solve_std");
+
+        int n = matrix_size__;
+        int m = std::min(n, nev__ + std::max(10, nev__ / 5));
+        /* small problem or large fraction of the spectrum */
+        if (n < 4 * m) {
+            return Eigensolver_lapack<T>().solve(matrix_size__, nev__, A__, eval__, Z__);
+        }
+
+        /* full matrix is needed for the matrix-matrix products */
+        for (int j = 0; j < n; j++) {
+            for (int i = 0; i < j; i++) {
+                A__(j, i) = conj(A__(i, j));
+            }
+        }
+
+        matrix<T> x(n, m);
+        bool guess = true;
+        for (int j = 0; j < m; j++) {
+            double nrm{0};
+            for (int i = 0; i < n; i++) {
+                x(i, j) = (j < nev__) ? Z__(i, j) : random();
+                nrm += std::pow(std::abs(x(i, j)), 2);
+            }
+            guess = guess && std::isfinite(nrm) && nrm > 0;
+        }
+        if (!guess) {
+            for (int j = 0; j < m; j++) {
+                for (int i = 0; i < n; i++) {
+                    x(i, j) = random();
+                }
+            }
+        }
+
+        if (subspace_iteration(n, m, nev__, A__.template at<CPU>(), A__.ld(), x, eval__)) {
+            for (int j = 0; j < nev__; j++) {
+                std::copy(x.template at<CPU>(0, j), x.template at<CPU>(0, j) + n, Z__.template at<CPU>(0, j));
+            }
+            return 0;
+        }
+        return Eigensolver_lapack<T>().solve(matrix_size__, nev__, A__, eval__, Z__);
+    }
+
+    /// Solve a generalized eigen-value problem for N lowest eigen-pairs.
+    int solve(ftn_int matrix_size__, ftn_int nev__, dmatrix<T>& A__, dmatrix<T>& B__, double* eval__, dmatrix<T>& Z__)
+    {
+        sddk::timer t0("Eigensolver_chebyshev::solve_gen");
+
+        int n = matrix_size__;
+        int m = std::min(n, nev__ + std::max(10, nev__ / 5));
+        if (n < 4 * m) {
+            return Eigensolver_lapack<T>().solve(matrix_size__, nev__, A__, B__, eval__, Z__);
+        }
+
+        /* B = U^{H}U */
+        if (linalg<CPU>::potrf(n, B__.template at<CPU>(), B__.ld())) {
+            return 1;
+        }
+        /* starting guess in the orthonormal basis: U Z */
+        linalg<CPU>::trmm('L', 'U', 'N', n, nev__, linalg_const<T>::one(), B__.template at<CPU>(), B__.ld(),
+                          Z__.template at<CPU>(), Z__.ld());
+        if (linalg<CPU>::trtri(n, B__.template at<CPU>(), B__.ld())) {
+            return 1;
+        }
+        /* A = U^{-H} A U^{-1}; only the upper part of A is referenced by the generalized solvers */
+        for (int j = 0; j < n; j++) {
+            for (int i = 0; i < j; i++) {
+                A__(j, i) = conj(A__(i, j));
+            }
+        }
+        linalg<CPU>::trmm('R', 'U', 'N', n, n, linalg_const<T>::one(), B__.template at<CPU>(), B__.ld(),
+                          A__.template at<CPU>(), A__.ld());
+        linalg<CPU>::trmm('L', 'U', 'C', n, n, linalg_const<T>::one(), B__.template at<CPU>(), B__.ld(),
+                          A__.template at<CPU>(), A__.ld());
+
+        int result = solve(matrix_size__, nev__, A__, eval__, Z__);
+        if (result) {
+            return result;
+        }
+        /* back-transform eigen-vectors: U^{-1} Z */
+        linalg<CPU>::trmm('L', 'U', 'N', n, nev__, linalg_const<T>::one(), B__.template at<CPU>(), B__.ld(),
+                          Z__.template at<CPU>(), Z__.ld());
+        return 0;
+    }
+};
+
 #ifdef __ELPA
 template <typename T>
 class Eigensolver_elpa: public Eigensolver<T>
@@ -962,8 +1412,12 @@ class Eigensolver_plasma: public Eigensolver<T>
 };
 #endif
 
+/// Create eigen-value solver.
+/** Communicator is used by the sequential solvers which can share the work between the ranks holding the
+ *  replicated matrices. */
 template <typename T>
-std::unique_ptr<Eigensolver<T>> Eigensolver_factory(ev_solver_t ev_solver_type__)
+std::unique_ptr<Eigensolver<T>> Eigensolver_factory(ev_solver_t ev_solver_type__,
+                                                    Communicator const& comm__ = mpi_comm_self())
 {
     Eigensolver<T>* ptr;
     switch (ev_solver_type__) {
@@ -987,6 +1441,10 @@ std::unique_ptr<Eigensolver<T>> Eigensolver_factory(ev_solver_t ev_solver_type__
             ptr = new Eigensolver_magma<T>();
             break;
         }
+        case ev_solver_t::chebyshev: {
+            ptr = new Eigensolver_chebyshev<T>(comm__);
+            break;
+        }
         default: {
             TERMINATE("not implemented");
         }
@@ -0,0 +1,380 @@
+// Copyright (c) 2013-2018 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file eigensolver_tuner.hpp
+ *
+ *  \brief Contains definition and implementation of Eigensolver_tuner class.
+ */
+
+#ifndef __EIGENSOLVER_TUNER_HPP__
+#define __EIGENSOLVER_TUNER_HPP__
+
+#include <fstream>
+#include <limits>
+#include "eigenproblem.h"
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+namespace sirius {
+
+/// Select the fastest combination of eigen-value solvers, BLACS grid and cyclic block size.
+/** Each candidate setup is benchmarked on a random Hermitian standard and generalized eigen-value problem of the
+ *  representative size. All k-point groups run the same benchmarks at the same time and the timings are reduced
+ *  with the global communicator, so every rank arrives at the same decision. The winner is stored in a JSON file
+ *  under a key which is made of the matrix size (in half-octave bins), the band fraction nev/N (in 10% steps),
+ *  the number of band ranks, the data type and the processing unit. Later runs with the same key reuse it. */
+class Eigensolver_tuner
+{
+  public:
+    /// Setup of the eigen-value problem.
+    struct config_t
+    {
+        /// Solver of the standard eigen-value problem.
+        ev_solver_t std_solver{ev_solver_t::lapack};
+
+        /// Solver of the generalized eigen-value problem.
+        ev_solver_t gen_solver{ev_solver_t::lapack};
+
+        /// Number of BLACS grid rows; zero for the sequential solvers.
+        int num_ranks_row{0};
+
+        /// Number of BLACS grid columns; zero for the sequential solvers.
+        int num_ranks_col{0};
+
+        /// Cyclic block size; -1 if it is not relevant (sequential solvers).
+        int bs{-1};
+    };
+
+  private:
+    /// Communicator of the entire simulation.
+    Communicator const& comm_;
+
+    /// Communicator of the band parallelization inside k-point group.
+    Communicator const& comm_band_;
+
+    /// Representative size of the matrix.
+    int matrix_size_;
+
+    /// Representative number of the eigen-pairs.
+    int nev_;
+
+    /// True if the matrices are real (Gamma-point case).
+    bool real_;
+
+    /// Main processing unit.
+    device_t pu_;
+
+    /// Name of the tuning cache file.
+    std::string file_name_;
+
+    /// Verbosity level.
+    int verbosity_;
+
+    static inline void set_element(double& a__, double x__, double y__)
+    {
+        a__ = x__;
+    }
+
+    static inline void set_element(double_complex& a__, double x__, double y__)
+    {
+        a__ = double_complex(x__, y__);
+    }
+
+    /// Fill Hermitian matrix; the elements depend only on the global indices.
+    /** The diagonal part spreads the spectrum over [0, N) and the off-diagonal part is small and dense. */
+    template <typename T>
+    inline void fill_matrix(dmatrix<T>& A__, double diag__, double offdiag__) const
+    {
+        for (int jloc = 0; jloc < A__.num_cols_local(); jloc++) {
+            int j = A__.icol(jloc);
+            for (int iloc = 0; iloc < A__.num_rows_local(); iloc++) {
+                int i = A__.irow(iloc);
+                if (i == j) {
+                    set_element(A__(iloc, jloc), 1 + diag__ * i, 0);
+                } else {
+                    int i0 = std::min(i, j);
+                    int j0 = std::max(i, j);
+                    double x = std::sin(12.9898 * i0 + 78.233 * j0);
+                    double y = (i < j) ? std::cos(39.346 * i0 + 11.135 * j0) : -std::cos(39.346 * i0 + 11.135 * j0);
+                    set_element(A__(iloc, jloc), offdiag__ * x, offdiag__ * y);
+                }
+            }
+        }
+    }
+
+    /// Return wall time of the single call to the solver (maximum across all ranks).
+    template <typename T>
+    double benchmark(ev_solver_t type__, bool gen__, BLACS_grid const& blacs_grid__, int bs__) const
+    {
+        auto solver = Eigensolver_factory<T>(type__);
+
+        auto mem = (type__ == ev_solver_t::magma) ? memory_t::host_pinned : memory_t::host;
+
+        int n = matrix_size_;
+        dmatrix<T> A(n, n, blacs_grid__, bs__, bs__, mem);
+        dmatrix<T> B(n, n, blacs_grid__, bs__, bs__, mem);
+        dmatrix<T> Z(n, n, blacs_grid__, bs__, bs__);
+        std::vector<double> eval(n);
+
+        fill_matrix(A, 1, 0.1);
+        fill_matrix(B, 0, 0.1 / n);
+
+        comm_.barrier();
+        double t = -omp_get_wtime();
+        int result = (gen__) ? solver->solve(n, nev_, A, B, eval.data(), Z) : solver->solve(n, nev_, A, eval.data(), Z);
+        t += omp_get_wtime();
+        if (result) {
+            t = std::numeric_limits<double>::max();
+        }
+        comm_.allreduce<double, mpi_op_t::max>(&t, 1);
+        return t;
+    }
+
+    template <typename T>
+    double benchmark(config_t& cfg__, std::vector<ev_solver_t> const& std_solvers__,
+                     std::vector<ev_solver_t> const& gen_solvers__) const
+    {
+        bool parallel = (cfg__.num_ranks_row != 0);
+
+        std::unique_ptr<BLACS_grid> blacs_grid;
+        if (parallel) {
+            blacs_grid = std::unique_ptr<BLACS_grid>(new BLACS_grid(comm_band_, cfg__.num_ranks_row, cfg__.num_ranks_col));
+        } else {
+            blacs_grid = std::unique_ptr<BLACS_grid>(new BLACS_grid(mpi_comm_self(), 1, 1));
+        }
+        int bs = (parallel) ? cfg__.bs : 1;
+
+        double time{0};
+        for (bool gen : {false, true}) {
+            double tmin = std::numeric_limits<double>::max();
+            for (auto type : (gen) ? gen_solvers__ : std_solvers__) {
+                if (Eigensolver_factory<T>(type)->is_parallel() != parallel) {
+                    continue;
+                }
+                double t = benchmark<T>(type, gen, *blacs_grid, bs);
+                if (comm_.rank() == 0 && verbosity_ >= 2) {
+                    printf("%s evp, solver: %-9s, grid: %3i x %-3i, block size: %3i, time: %12.6f sec.\n",
+                           (gen) ? "gen" : "std", ev_solver_name(type).c_str(), blacs_grid->num_ranks_row(),
+                           blacs_grid->num_ranks_col(), bs, t);
+                }
+                if (t < tmin) {
+                    tmin = t;
+                    if (gen) {
+                        cfg__.gen_solver = type;
+                    } else {
+                        cfg__.std_solver = type;
+                    }
+                }
+            }
+            if (tmin == std::numeric_limits<double>::max()) {
+                return tmin;
+            }
+            time += tmin;
+        }
+        return time;
+    }
+
+    /// Key of the problem in the tuning cache.
+    std::string key() const
+    {
+        std::stringstream s;
+        s << "N" << static_cast<int>(std::round(2 * std::log2(double(matrix_size_))))
+          << "_f" << static_cast<int>(std::round(10.0 * nev_ / matrix_size_))
+          << "_p" << comm_band_.size()
+          << ((real_) ? "_real" : "_complex")
+          << ((pu_ == GPU) ? "_gpu" : "_cpu");
+        return s.str();
+    }
+
+    json read_cache() const
+    {
+        json dict = json::object();
+        std::ifstream ifs(file_name_);
+        if (ifs.is_open()) {
+            try {
+                ifs >> dict;
+            } catch (std::exception const& e) {
+                std::stringstream s;
+                s << "failed to read eigen-solver tuning cache " << file_name_ << std::endl
+                  << e.what();
+                WARNING(s);
+                dict = json::object();
+            }
+        }
+        return dict;
+    }
+
+    /// Read the setup from the cache file and check that it can be used by this build and this communicator.
+    bool load(config_t& cfg__, std::vector<ev_solver_t> const& std_solvers__,
+              std::vector<ev_solver_t> const& gen_solvers__) const
+    {
+        std::vector<int> buf(6, -1);
+        if (comm_.rank() == 0) {
+            auto dict = read_cache();
+            auto k = key();
+            if (dict.count(k)) {
+                try {
+                    buf[1] = static_cast<int>(get_ev_solver_t(dict[k]["std_evp_solver_type"].get<std::string>()));
+                    buf[2] = static_cast<int>(get_ev_solver_t(dict[k]["gen_evp_solver_type"].get<std::string>()));
+                    auto grid = dict[k]["blacs_grid"].get<std::vector<int>>();
+                    buf[3] = grid.at(0);
+                    buf[4] = grid.at(1);
+                    buf[5] = dict[k]["cyclic_block_size"].get<int>();
+                    buf[0] = 1;
+                } catch (std::exception const& e) {
+                    std::stringstream s;
+                    s << "wrong entry " << k << " in the eigen-solver tuning cache " << file_name_;
+                    WARNING(s);
+                }
+            }
+        }
+        comm_.bcast(buf.data(), 6, 0);
+        if (buf[0] != 1) {
+            return false;
+        }
+        cfg__.std_solver    = static_cast<ev_solver_t>(buf[1]);
+        cfg__.gen_solver    = static_cast<ev_solver_t>(buf[2]);
+        cfg__.num_ranks_row = buf[3];
+        cfg__.num_ranks_col = buf[4];
+        cfg__.bs            = buf[5];
+
+        /* solvers must be available and compatible with the grid */
+        if (std::find(std_solvers__.begin(), std_solvers__.end(), cfg__.std_solver) == std_solvers__.end() ||
+            std::find(gen_solvers__.begin(), gen_solvers__.end(), cfg__.gen_solver) == gen_solvers__.end()) {
+            return false;
+        }
+        bool parallel = (cfg__.num_ranks_row != 0);
+        if (parallel && cfg__.num_ranks_row * cfg__.num_ranks_col != comm_band_.size()) {
+            return false;
+        }
+        for (auto type : {cfg__.std_solver, cfg__.gen_solver}) {
+            if (Eigensolver_factory<double>(type)->is_parallel() != parallel) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void save(config_t const& cfg__, double time__) const
+    {
+        if (comm_.rank() != 0) {
+            return;
+        }
+        auto dict = read_cache();
+        auto k = key();
+        dict[k]["std_evp_solver_type"] = ev_solver_name(cfg__.std_solver);
+        dict[k]["gen_evp_solver_type"] = ev_solver_name(cfg__.gen_solver);
+        dict[k]["blacs_grid"]          = std::vector<int>({cfg__.num_ranks_row, cfg__.num_ranks_col});
+        dict[k]["cyclic_block_size"]   = cfg__.bs;
+        dict[k]["matrix_size"]         = matrix_size_;
+        dict[k]["nev"]                 = nev_;
+        dict[k]["time"]                = time__;
+
+        std::ofstream ofs(file_name_, std::ofstream::out | std::ofstream::trunc);
+        if (!ofs.is_open()) {
+            std::stringstream s;
+            s << "failed to write eigen-solver tuning cache " << file_name_;
+            WARNING(s);
+            return;
+        }
+        ofs << dict.dump(4) << std::endl;
+    }
+
+  public:
+    Eigensolver_tuner(Communicator const& comm__,
+                      Communicator const& comm_band__,
+                      int matrix_size__,
+                      int nev__,
+                      bool real__,
+                      device_t pu__,
+                      std::string file_name__,
+                      int verbosity__)
+        : comm_(comm__)
+        , comm_band_(comm_band__)
+        , matrix_size_(matrix_size__)
+        , nev_(std::min(nev__, matrix_size__))
+        , real_(real__)
+        , pu_(pu__)
+        , file_name_(file_name__)
+        , verbosity_(verbosity__)
+    {
+    }
+
+    /// Find the best setup among the candidates or take it from the tuning cache.
+    /** \param [in] std_solvers  Candidate solvers of the standard eigen-value problem.
+     *  \param [in] gen_solvers  Candidate solvers of the generalized eigen-value problem.
+     *  \param [in] grids        Candidate BLACS grids for the parallel solvers; the size of each grid must
+     *                           match the size of the band communicator.
+     *  \param [in] block_sizes  Candidate cyclic block sizes for the parallel solvers.
+     */
+    config_t tune(std::vector<ev_solver_t> const& std_solvers__,
+                  std::vector<ev_solver_t> const& gen_solvers__,
+                  std::vector<std::pair<int, int>> const& grids__,
+                  std::vector<int> const& block_sizes__)
+    {
+        PROFILE("sirius::Eigensolver_tuner::tune");
+
+        config_t best;
+        if (load(best, std_solvers__, gen_solvers__)) {
+            if (comm_.rank() == 0 && verbosity_ >= 1) {
+                printf("eigen-solver setup for %s is taken from %s\n", key().c_str(), file_name_.c_str());
+            }
+            return best;
+        }
+
+        /* sequential setup goes first; it is always available */
+        std::vector<config_t> setups(1);
+        for (auto& g : grids__) {
+            for (int bs : block_sizes__) {
+                config_t cfg;
+                cfg.num_ranks_row = g.first;
+                cfg.num_ranks_col = g.second;
+                cfg.bs            = bs;
+                setups.push_back(cfg);
+            }
+        }
+
+        double tbest = std::numeric_limits<double>::max();
+        for (auto& cfg : setups) {
+            double t = (real_) ? benchmark<double>(cfg, std_solvers__, gen_solvers__)
+                               : benchmark<double_complex>(cfg, std_solvers__, gen_solvers__);
+            if (t < tbest) {
+                tbest = t;
+                best  = cfg;
+            }
+        }
+        if (tbest == std::numeric_limits<double>::max()) {
+            TERMINATE("none of the eigen-value solvers has passed the benchmark");
+        }
+
+        if (comm_.rank() == 0 && verbosity_ >= 1) {
+            printf("eigen-solver setup for %s: %s / %s, grid: %i x %i, block size: %i, time: %f sec.\n",
+                   key().c_str(), ev_solver_name(best.std_solver).c_str(), ev_solver_name(best.gen_solver).c_str(),
+                   best.num_ranks_row, best.num_ranks_col, best.bs, tbest);
+        }
+        save(best, tbest);
+
+        return best;
+    }
+};
+
+} // namespace sirius
+
+#endif // __EIGENSOLVER_TUNER_HPP__
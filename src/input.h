@@ -268,6 +268,28 @@ struct Iterative_solver_input
      *  the randomized wave functions. */
     std::string init_subspace_{"lcao"};
 
+    /// Number of bands to which the LAPW Hamiltonian and overlap operators are applied at once.
+    /** Negative value means that all bands are processed in a single block. Smaller blocks reduce the size of the
+     *  temporary arrays in the matrix-free LAPW solver. */
+    int apply_block_size_{-1};
+
+    /// Iterative solver tolerance above which the Davidson subspace is expanded in single precision.
+    /** As long as the current tolerance of the iterative solver is larger than this value the subspace matrices and
+     *  the residuals of the pseudopotential Davidson solver are computed with the single precision GEMMs. The final
+     *  update of the wave-functions is always done in double precision. Zero value disables the mixed precision. */
+    double mixed_precision_tolerance_{0};
+
+    /// Orthogonalize new basis functions and project the Hamiltonian in a single pass over the basis.
+    /** Used by the pseudopotential Davidson solver with orthogonalized basis. If the projected overlap matrix is
+     *  not positive definite the solver falls back to the regular Gram-Schmidt orthogonalization. */
+    bool fused_expansion_{false};
+
+    /// Method of the orthogonalization of new basis functions ("cholesky", "cholesky_qr2" or "tsqr").
+    /** Cholesky-QR2 and TSQR replace the distributed Cholesky factorization of the overlap matrix by a replicated
+     *  one and are used on CPU only. TSQR requires complex wave-functions and no S operator (no augmentation);
+     *  it is not available in the Gamma-point and full-potential cases. */
+    std::string orthogonalization_{"cholesky"};
+
     void read(json const& parser)
     {
         if (parser.count("iterative_solver")) {
@@ -286,6 +308,11 @@ struct Iterative_solver_input
             orthogonalize_          = parser["iterative_solver"].value("orthogonalize", orthogonalize_);
             init_eval_old_          = parser["iterative_solver"].value("init_eval_old", init_eval_old_);
             init_subspace_          = parser["iterative_solver"].value("init_subspace", init_subspace_);
+            apply_block_size_       = parser["iterative_solver"].value("apply_block_size", apply_block_size_);
+            mixed_precision_tolerance_ = parser["iterative_solver"].value("mixed_precision_tolerance",
+                                                                           mixed_precision_tolerance_);
+            fused_expansion_        = parser["iterative_solver"].value("fused_expansion", fused_expansion_);
+            orthogonalization_      = parser["iterative_solver"].value("orthogonalization", orthogonalization_);
             std::transform(init_subspace_.begin(), init_subspace_.end(), init_subspace_.begin(), ::tolower);
         }
     }
@@ -303,6 +330,10 @@ struct Iterative_solver_input
  *      "electronic_structure_method" : (string) electronic structure method
  *      "processing_unit" : (string) primary processing unit
  *      "fft_mode" : (string) serial or parallel FFT
+ *      "evp_autotune" : (bool) benchmark eigen-value solvers, BLACS grids and block sizes at startup
+ *      "evp_autotune_file" : (string) file where the results of the eigen-solver tuning are cached
+ *      "wf_storage" : (string) storage of the k-point wave-functions between uses: memory, disk or disk_sp
+ *      "wf_storage_path" : (string) node-local directory for the wave-function files (default: $TMPDIR or /tmp)
  *    }
  *  \endcode
  */
@@ -335,6 +366,47 @@ struct Control_input
     bool print_timers_{true};
     bool print_neighbors_{false};
 
+    /// Memory budget (in Mb) for the cache of the phase factors of atoms.
+    /** Phase factors are cached for the atom types, which fit into the budget, and are generated on demand
+     *  for the remaining types. */
+    double phase_factors_cache_size_{0};
+
+    /// Memory budget (in Mb) for the table of G-G' indices of a single k-point.
+    /** The table is used in the setup of the interstitial part of the LAPW Hamiltonian and overlap matrices.
+     *  If it doesn't fit into the budget the indices are computed on the fly. The default budget is zero,
+     *  i.e. the cache is off and the indices are always computed on the fly. */
+    double g12_index_cache_size_{0};
+
+    /// Distribution of k-points between k-groups.
+    /** Possible values are:
+     *    - "block": equal number of k-points in each k-group \n
+     *    - "cost": k-points are split into chunks of equal estimated cost \n
+     *    - "dynamic": as "cost", and k-points are redistributed between SCF iterations using the measured
+     *      number of iterative solver steps */
+    std::string kpoint_distribution_{"block"};
+
+    /// Minimum reduction of the k-point load imbalance for which the k-points are redistributed.
+    double kpoint_imbalance_tol_{0.05};
+
+    /// Select eigen-value solvers, BLACS grid and cyclic block size by benchmarking them at startup.
+    /** Solver types and block size which are given explicitly in the input are kept fixed. */
+    bool evp_autotune_{false};
+
+    /// Cache of the eigen-solver tuning results; the best setup is reused by the runs with the same problem size.
+    std::string evp_autotune_file_{"sirius_evp_tuning.json"};
+
+    /// Storage of the wave-functions of k-points which are not being processed.
+    /** Possible values are:
+     *    - "memory": wave-functions of all local k-points are kept in memory \n
+     *    - "disk": wave-functions are written to the node-local storage and read back (with prefetch of the
+     *      next k-point) when needed \n
+     *    - "disk_sp": as "disk", but the coefficients are stored in single precision */
+    std::string wf_storage_{"memory"};
+
+    /// Node-local directory for the wave-function files.
+    /** If empty, $TMPDIR is used or /tmp if $TMPDIR is not set. */
+    std::string wf_storage_path_{""};
+
     void read(json const& parser)
     {
         if (parser.count("control")) {
@@ -358,8 +430,17 @@ struct Control_input
             print_forces_        = parser["control"].value("print_forces", print_forces_);
             print_timers_        = parser["control"].value("print_timers", print_timers_);
             print_neighbors_     = parser["control"].value("print_neighbors", print_neighbors_);
-
-            auto strings = {&std_evp_solver_name_, &gen_evp_solver_name_, &fft_mode_, &processing_unit_};
+            phase_factors_cache_size_ = parser["control"].value("phase_factors_cache_size", phase_factors_cache_size_);
+            g12_index_cache_size_ = parser["control"].value("g12_index_cache_size", g12_index_cache_size_);
+            kpoint_distribution_ = parser["control"].value("kpoint_distribution", kpoint_distribution_);
+            kpoint_imbalance_tol_ = parser["control"].value("kpoint_imbalance_tol", kpoint_imbalance_tol_);
+            evp_autotune_        = parser["control"].value("evp_autotune", evp_autotune_);
+            evp_autotune_file_   = parser["control"].value("evp_autotune_file", evp_autotune_file_);
+            wf_storage_          = parser["control"].value("wf_storage", wf_storage_);
+            wf_storage_path_     = parser["control"].value("wf_storage_path", wf_storage_path_);
+
+            auto strings = {&std_evp_solver_name_, &gen_evp_solver_name_, &fft_mode_, &processing_unit_,
+                            &kpoint_distribution_, &wf_storage_};
             for (auto s : strings) {
                 std::transform(s->begin(), s->end(), s->begin(), ::tolower);
             }
@@ -439,6 +520,9 @@ struct Parameters_input
     /// Type of periodic boundary conditions.
     std::string esm_bc_{"pbc"};
 
+    /// Order of density and wave-function extrapolation between ionic steps (0, 1 or 2).
+    int extrapolation_order_{2};
+
     void read(json const& parser)
     {
         if (parser.count("parameters")) {
@@ -479,6 +563,7 @@ struct Parameters_input
             potential_tol_  = parser["parameters"].value("potential_tol", potential_tol_);
             molecule_       = parser["parameters"].value("molecule", molecule_);
             nn_radius_      = parser["parameters"].value("nn_radius", nn_radius_);
+            extrapolation_order_ = parser["parameters"].value("extrapolation_order", extrapolation_order_);
             if (parser["parameters"].count("spin_orbit")) {
                 so_correction_ = parser["parameters"].value("spin_orbit", so_correction_);
                 num_mag_dims_  = 3;
@@ -503,6 +588,14 @@ struct Settings_input
     bool always_update_wf_{true};
     double mixer_rss_min_{1e-12};
 
+    /// Number of local G-vectors processed at once by the G-blocked kernels.
+    /** Bounds the size of the temporary arrays (e.g. in the generation of the augmentation charge) independently
+     *  of the total number of G-vectors. */
+    int gvec_block_size_{8192};
+
+    /// Muffin-tin potential components with \f$ \max_r |V_{\ell m}(r)| \f$ below this value are skipped in the radial integrals.
+    double mt_radial_integrals_tol_{1e-12};
+
     void read(json const& parser)
     {
         if (parser.count("settings")) {
@@ -512,6 +605,8 @@ struct Settings_input
             nprii_rho_core_   = parser["settings"].value("nprii_rho_core", nprii_rho_core_);
             always_update_wf_ = parser["settings"].value("always_update_wf", always_update_wf_);
             mixer_rss_min_    = parser["settings"].value("mixer_rss_min", mixer_rss_min_);
+            gvec_block_size_  = parser["settings"].value("gvec_block_size", gvec_block_size_);
+            mt_radial_integrals_tol_ = parser["settings"].value("mt_radial_integrals_tol", mt_radial_integrals_tol_);
         }
     }
 };
@@ -28,6 +28,8 @@
 #include "periodic_function.h"
 #include "matching_coefficients.h"
 #include "Beta_projectors/beta_projectors.h"
+#include <future>
+#include <unistd.h>
 #include "wave_functions.hpp"
 
 namespace sirius
@@ -88,6 +90,15 @@ class K_point
         /// Two-component (spinor) hubbard wave functions where the S matrix is applied (if ppus).
         std::unique_ptr<Wave_functions> hubbard_wave_functions_{nullptr};
 
+        /// Base name of the files which hold the wave-functions when they are moved out of memory.
+        std::string wf_fname_;
+
+        /// True if the wave-functions are stored in files.
+        bool wf_spilled_{false};
+
+        /// Background read of the stored wave-functions.
+        std::future<void> wf_prefetch_;
+
         /// Band occupation numbers.
         mdarray<double, 2> band_occupancies_;
 
@@ -117,6 +128,10 @@ class K_point
         /** Used by matching_coefficients class. */
         std::vector<int> igk_loc_;
 
+        /// Indices of G-G' vectors for the local row and column G+k vectors.
+        /** The table is created on the first request if it fits into Control_input::g12_index_cache_size_. */
+        mdarray<int, 2> gvec_index_g12_;
+
         /// Number of G+k vectors distributed along rows of MPI grid
         int num_gkvec_row_{0};
 
@@ -182,6 +197,22 @@ class K_point
         /// Communicator between(!!) columns.
         Communicator const& comm_col_;
 
+        /// List of wave-functions which are moved to the node-local storage together with the file name suffixes.
+        inline std::vector<std::pair<Wave_functions*, std::string>> spill_list()
+        {
+            std::vector<std::pair<Wave_functions*, std::string>> list;
+            if (fv_states_ != nullptr) {
+                list.push_back(std::make_pair(fv_states_.get(), std::string("fv")));
+            }
+            if (spinor_wave_functions_ != nullptr) {
+                list.push_back(std::make_pair(spinor_wave_functions_.get(), std::string("sp")));
+            }
+            if (hubbard_wave_functions_ != nullptr) {
+                list.push_back(std::make_pair(hubbard_wave_functions_.get(), std::string("hub")));
+            }
+            return std::move(list);
+        }
+
         /// Generate G+k and local orbital basis sets.
         inline void generate_gklo_basis();
 
@@ -241,6 +272,33 @@ class K_point
 
             rank_row_ = comm_row_.rank();
             rank_col_ = comm_col_.rank();
+
+            static int num_kpoints_created{0};
+            std::string path = ctx_.control().wf_storage_path_;
+            if (path.empty()) {
+                auto tmp = std::getenv("TMPDIR");
+                path = (tmp) ? tmp : "/tmp";
+            }
+            /* the storage can be shared by several jobs, so the file names include the job and process ids */
+            std::stringstream s;
+            s << path << "/sirius_wf_";
+            if (auto job_id = std::getenv("SLURM_JOB_ID")) {
+                s << job_id << "_";
+            }
+            s << getpid() << "_" << mpi_comm_world().rank() << "_" << num_kpoints_created++;
+            wf_fname_ = s.str();
+        }
+
+        ~K_point()
+        {
+            if (wf_prefetch_.valid()) {
+                wf_prefetch_.get();
+            }
+            if (spill_wave_functions_enabled()) {
+                for (auto e: {"fv", "sp", "hub"}) {
+                    std::remove((wf_fname_ + "_" + e + ".bin").c_str());
+                }
+            }
         }
 
         /// Find G+k vectors within the cutoff.
@@ -278,6 +336,20 @@ class K_point
         /// Initialize the k-point related arrays and data.
         inline void initialize();
 
+        /// Update the position-dependent data after the atoms were moved.
+        inline void update()
+        {
+            PROFILE("sirius::K_point::update");
+
+            for (auto e: {beta_projectors_.get(), beta_projectors_row_.get(), beta_projectors_col_.get()}) {
+                if (e != nullptr) {
+                    e->update();
+                }
+            }
+            /* atomic orbitals are regenerated on demand */
+            hubbard_wave_functions_ = nullptr;
+        }
+
         /// Generate first-variational states from eigen-vectors.
         /** First-variational states are obtained from the first-variational eigen-vectors and
          *  LAPW matching coefficients.
@@ -399,22 +471,77 @@ class K_point
 
         inline Wave_functions& fv_states()
         {
+            restore_wave_functions();
             return *fv_states_;
         }
 
         inline Wave_functions& spinor_wave_functions()
         {
+            restore_wave_functions();
             return *spinor_wave_functions_;
         }
 
         inline Wave_functions& hubbard_wave_functions()
         {
+            restore_wave_functions();
             return *hubbard_wave_functions_;
         }
 
-        inline Wave_functions const& hubbard_wave_functions() const
+        /// Return true if the wave-functions are moved out of memory when the k-point is not processed.
+        /** Only the host memory is managed, so the spill is disabled when the wave-functions live on a GPU. */
+        inline bool spill_wave_functions_enabled() const
         {
-            return *hubbard_wave_functions_;
+            return (ctx_.control().wf_storage_ != "memory" && ctx_.processing_unit() == CPU);
+        }
+
+        /// Write the wave-functions to the node-local storage and release the host memory.
+        inline void spill_wave_functions()
+        {
+            if (!spill_wave_functions_enabled() || wf_spilled_) {
+                return;
+            }
+            PROFILE("sirius::K_point::spill_wave_functions");
+
+            bool sp = (ctx_.control().wf_storage_ == "disk_sp");
+            for (auto& e: spill_list()) {
+                e.first->offload(wf_fname_ + "_" + e.second + ".bin", sp);
+            }
+            wf_spilled_ = true;
+        }
+
+        /// Start reading the stored wave-functions in a background thread.
+        inline void prefetch_wave_functions()
+        {
+            if (!wf_spilled_ || wf_prefetch_.valid()) {
+                return;
+            }
+            auto list = spill_list();
+            auto fname = wf_fname_;
+            wf_prefetch_ = std::async(std::launch::async, [list, fname]()
+            {
+                for (auto& e: list) {
+                    e.first->reload(fname + "_" + e.second + ".bin");
+                }
+            });
+        }
+
+        /// Make sure that the wave-functions are in memory.
+        /** Wave-functions are read back from the node-local storage or the pending prefetch is completed. */
+        inline void restore_wave_functions()
+        {
+            if (!wf_spilled_) {
+                return;
+            }
+            PROFILE("sirius::K_point::restore_wave_functions");
+
+            if (wf_prefetch_.valid()) {
+                wf_prefetch_.get();
+            } else {
+                for (auto& e: spill_list()) {
+                    e.first->reload(wf_fname_ + "_" + e.second + ".bin");
+                }
+            }
+            wf_spilled_ = false;
         }
 
         inline void allocate_hubbard_wave_functions(int size)
@@ -538,6 +665,29 @@ class K_point
             return igk_col_;
         }
 
+        /// Return the table of G-G' indices for the row and column G+k vectors.
+        /** An empty array is returned if the table doesn't fit into the memory budget. */
+        inline mdarray<int, 2> const& gvec_index_g12()
+        {
+            double sz = static_cast<double>(num_gkvec_row()) * num_gkvec_col() * sizeof(int) / (1 << 20);
+            if (gvec_index_g12_.size() == 0 && sz > 0 &&
+                sz <= ctx_.control().g12_index_cache_size_) {
+                PROFILE("sirius::K_point::gvec_index_g12");
+
+                gvec_index_g12_ = mdarray<int, 2>(num_gkvec_row(), num_gkvec_col(), memory_t::host,
+                                                  "K_point::gvec_index_g12_");
+                #pragma omp parallel for schedule(static)
+                for (int igk_col = 0; igk_col < num_gkvec_col(); igk_col++) {
+                    auto gvec_col = gkvec().gvec(igk_col_[igk_col]);
+                    for (int igk_row = 0; igk_row < num_gkvec_row(); igk_row++) {
+                        auto gvec_row = gkvec().gvec(igk_row_[igk_row]);
+                        gvec_index_g12_(igk_row, igk_col) = ctx_.gvec().index_g12(gvec_row, gvec_col);
+                    }
+                }
+            }
+            return gvec_index_g12_;
+        }
+
         inline int num_ranks_row() const
         {
             return num_ranks_row_;
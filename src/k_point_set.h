@@ -50,6 +50,13 @@ class K_point_set
 
         splindex<chunk> spl_num_kpoints_;
 
+        /// Number of G+k vectors for each k-point.
+        /** This is known before the k-points are initialized and is used to estimate the cost of each k-point. */
+        std::vector<int> num_gkvec_;
+
+        /// Number of iterative solver steps for each k-point in the last band solution.
+        std::vector<int> num_solver_iter_;
+
         double energy_fermi_{0};
 
         double band_gap_{0};
@@ -60,6 +67,61 @@ class K_point_set
 
         K_point_set(K_point_set& src) = delete;
 
+        /// Count G+k vectors inside the cutoff sphere without creating the full G-vector set.
+        inline int count_gkvec(vector3d<double> vk__) const
+        {
+            auto& M = unit_cell_.reciprocal_lattice_vectors();
+            auto limits = find_translations(ctx_.gk_cutoff(), M);
+
+            int n{0};
+            for (int i0 = -limits[0] / 2 - 1; i0 <= limits[0] / 2 + 1; i0++) {
+                for (int i1 = -limits[1] / 2 - 1; i1 <= limits[1] / 2 + 1; i1++) {
+                    for (int i2 = -limits[2] / 2 - 1; i2 <= limits[2] / 2 + 1; i2++) {
+                        auto vgk = M * (vector3d<double>(i0, i1, i2) + vk__);
+                        if (vgk.length() <= ctx_.gk_cutoff()) {
+                            n++;
+                        }
+                    }
+                }
+            }
+            return n;
+        }
+
+        /// Estimate the relative cost of band diagonalization for each k-point.
+        /** The cost of the exact solver scales as a cube of the basis size. The cost of the iterative solver
+         *  is proportional to the number of G+k vectors, number of bands and the number of iterations, which
+         *  was measured for the k-point in the previous band solution. */
+        inline std::vector<double> kpoint_cost() const
+        {
+            std::vector<double> cost(num_kpoints());
+            for (int ik = 0; ik < num_kpoints(); ik++) {
+                double ngk = num_gkvec_[ik];
+                if (ctx_.iterative_solver_input().type_ == "exact") {
+                    cost[ik] = std::pow(ngk, 3);
+                } else {
+                    cost[ik] = ngk * ctx_.num_bands() * std::max(num_solver_iter_[ik], 1);
+                }
+            }
+            return std::move(cost);
+        }
+
+        /// Ratio between the maximum and the average cost of k-point groups.
+        inline double imbalance(std::vector<double> const& cost__, std::vector<int> const& counts__) const
+        {
+            double cmax{0};
+            double total_cost{0};
+            int ik{0};
+            for (int r = 0; r < static_cast<int>(counts__.size()); r++) {
+                double c{0};
+                for (int i = 0; i < counts__[r]; i++) {
+                    c += cost__[ik++];
+                }
+                cmax = std::max(cmax, c);
+                total_cost += c;
+            }
+            return (total_cost > 0) ? cmax * counts__.size() / total_cost : 1.0;
+        }
+
     public:
 
         K_point_set(Simulation_context& ctx__)
@@ -169,16 +231,34 @@ class K_point_set
         /// Initialize the k-point set
         void initialize(std::vector<int> counts = std::vector<int>())
         {
+            num_gkvec_ = std::vector<int>(num_kpoints());
+            for (int ik = 0; ik < num_kpoints(); ik++) {
+                num_gkvec_[ik] = count_gkvec(kpoints_[ik]->vk());
+            }
+            num_solver_iter_ = std::vector<int>(num_kpoints(), 1);
+
             /* distribute k-points along the 1-st dimension of the MPI grid */
             if (counts.empty()) {
-                splindex<block> spl_tmp(num_kpoints(), comm_k_.size(), comm_k_.rank());
-                spl_num_kpoints_ = splindex<chunk>(num_kpoints(), comm_k_.size(), comm_k_.rank(), spl_tmp.counts());
+                if (ctx_.control().kpoint_distribution_ == "block") {
+                    splindex<block> spl_tmp(num_kpoints(), comm_k_.size(), comm_k_.rank());
+                    counts = spl_tmp.counts();
+                } else {
+                    counts = split_by_cost(kpoint_cost(), comm_k_.size());
+                }
+                spl_num_kpoints_ = splindex<chunk>(num_kpoints(), comm_k_.size(), comm_k_.rank(), counts);
             } else {
                 spl_num_kpoints_ = splindex<chunk>(num_kpoints(), comm_k_.size(), comm_k_.rank(), counts);
             }
 
+            auto& wfs = ctx_.control().wf_storage_;
+            if (wfs != "memory" && wfs != "disk" && wfs != "disk_sp") {
+                TERMINATE("wrong type of wave-function storage: " + wfs);
+            }
+
+            /* wave-functions are moved out of memory right after the allocation to keep the peak memory low */
             for (int ikloc = 0; ikloc < spl_num_kpoints_.local_size(); ikloc++) {
                 kpoints_[spl_num_kpoints_[ikloc]]->initialize();
+                kpoints_[spl_num_kpoints_[ikloc]]->spill_wave_functions();
             }
 
             if (ctx_.control().verbosity_ > 0) {
@@ -190,6 +270,41 @@ class K_point_set
             }
         }
 
+        /// Redistribute k-points between k-groups according to the measured cost.
+        void rebalance();
+
+        /// Number of iterative solver steps made for a local k-point in the last band solution.
+        inline int& num_solver_iter(int ik__)
+        {
+            return num_solver_iter_[ik__];
+        }
+
+        /// Bring the wave-functions of a local k-point to memory and start reading the next local k-point.
+        /** This is a no-op if the wave-functions are always kept in memory. */
+        inline K_point* acquire_local(int ikloc__)
+        {
+            auto kp = kpoints_[spl_num_kpoints_[ikloc__]].get();
+            kp->restore_wave_functions();
+            if (ikloc__ + 1 < spl_num_kpoints_.local_size()) {
+                kpoints_[spl_num_kpoints_[ikloc__ + 1]]->prefetch_wave_functions();
+            }
+            return kp;
+        }
+
+        /// Move the wave-functions of a processed local k-point to the node-local storage.
+        inline void release_local(int ikloc__)
+        {
+            kpoints_[spl_num_kpoints_[ikloc__]]->spill_wave_functions();
+        }
+
+        /// Update the position-dependent data of the local k-points after the atoms were moved.
+        inline void update()
+        {
+            for (int ikloc = 0; ikloc < spl_num_kpoints_.local_size(); ikloc++) {
+                kpoints_[spl_num_kpoints_[ikloc]]->update();
+            }
+        }
+
         /// Find Fermi energy and band occupation numbers
         void find_band_occupancies();
 
@@ -349,6 +464,103 @@ inline void K_point_set::sync_band_energies()
     }
 }
 
+/** K-points for which the owner changes are initialized by the new k-group and their wave-functions are sent
+ *  from the old k-group. Ranks of the old and new k-groups with the same band index hold the same fraction of
+ *  G+k vectors, so the transfer is a point-to-point communication in comm_k. K-point objects released by the
+ *  old owner are replaced by uninitialized ones.
+ *
+ *  Only the pseudopotential case is rebalanced; full-potential k-points keep their initial distribution. */
+inline void K_point_set::rebalance()
+{
+    PROFILE("sirius::K_point_set::rebalance");
+
+    if (ctx_.full_potential() || comm_k_.size() == 1) {
+        return;
+    }
+
+    /* make the iteration counts of all k-points available everywhere */
+    std::vector<int> niter(num_kpoints(), 0);
+    for (int ikloc = 0; ikloc < spl_num_kpoints_.local_size(); ikloc++) {
+        int ik = spl_num_kpoints_[ikloc];
+        niter[ik] = num_solver_iter_[ik];
+    }
+    comm_k_.allreduce(niter.data(), num_kpoints());
+    num_solver_iter_ = niter;
+
+    auto cost = kpoint_cost();
+    std::vector<int> counts_old(comm_k_.size());
+    for (int r = 0; r < comm_k_.size(); r++) {
+        counts_old[r] = spl_num_kpoints_.local_size(r);
+    }
+    auto counts_new = split_by_cost(cost, comm_k_.size());
+
+    double imb_old = imbalance(cost, counts_old);
+    double imb_new = imbalance(cost, counts_new);
+
+    if (ctx_.comm().rank() == 0 && ctx_.control().verbosity_ >= 1) {
+        printf("k-point load imbalance (max / average cost): %f, after rebalancing: %f\n", imb_old, imb_new);
+    }
+
+    /* don't move wave-functions for a marginal gain */
+    if (imb_old - imb_new < ctx_.control().kpoint_imbalance_tol_) {
+        return;
+    }
+
+    splindex<chunk> spl_new(num_kpoints(), comm_k_.size(), comm_k_.rank(), counts_new);
+
+    int rank = comm_k_.rank();
+    int ns = ctx_.num_spins();
+
+    /* send wave-functions of the k-points which leave this k-group */
+    for (int ik = 0; ik < num_kpoints(); ik++) {
+        int r_old = spl_num_kpoints_.local_rank(ik);
+        int r_new = spl_new.local_rank(ik);
+        if (r_old == rank && r_new != rank) {
+            for (int ispn = 0; ispn < ns; ispn++) {
+                auto& wf = kpoints_[ik]->spinor_wave_functions().pw_coeffs(ispn).prime();
+                comm_k_.isend(wf.at<CPU>(), static_cast<int>(wf.size()), r_new, ik * ns + ispn);
+            }
+        }
+    }
+    /* initialize k-points which arrive to this k-group and receive their wave-functions */
+    for (int ik = 0; ik < num_kpoints(); ik++) {
+        int r_old = spl_num_kpoints_.local_rank(ik);
+        int r_new = spl_new.local_rank(ik);
+        if (r_old != rank && r_new == rank) {
+            kpoints_[ik]->initialize();
+            for (int ispn = 0; ispn < ns; ispn++) {
+                auto& wf = kpoints_[ik]->spinor_wave_functions().pw_coeffs(ispn).prime();
+                comm_k_.recv(wf.at<CPU>(), static_cast<int>(wf.size()), r_old, ik * ns + ispn);
+            }
+            #ifdef __GPU
+            if (ctx_.processing_unit() == GPU && keep_wf_on_gpu) {
+                kpoints_[ik]->spinor_wave_functions().copy_to_device(2, 0, ctx_.num_bands());
+            }
+            #endif
+        }
+    }
+    /* all receives are complete, so the send buffers can be released */
+    comm_k_.barrier();
+
+    for (int ik = 0; ik < num_kpoints(); ik++) {
+        int r_old = spl_num_kpoints_.local_rank(ik);
+        int r_new = spl_new.local_rank(ik);
+        if (r_old == rank && r_new != rank) {
+            auto vk = kpoints_[ik]->vk();
+            std::unique_ptr<K_point> kp(new K_point(ctx_, &vk[0], kpoints_[ik]->weight()));
+            for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) {
+                for (int j = 0; j < ctx_.num_bands(); j++) {
+                    kp->band_energy(j, ispn)    = kpoints_[ik]->band_energy(j, ispn);
+                    kp->band_occupancy(j, ispn) = kpoints_[ik]->band_occupancy(j, ispn);
+                }
+            }
+            kpoints_[ik] = std::move(kp);
+        }
+    }
+
+    spl_num_kpoints_ = spl_new;
+}
+
 inline void K_point_set::find_band_occupancies()
 {
     PROFILE("sirius::K_point_set::find_band_occupancies");
@@ -132,6 +132,53 @@ class Potential
             double one_elec_energy_{0.0};
         };
 
+        /// Persistent workspace of the one-centre XC of the local PAW atoms of one type.
+        /** Atoms of the same type share the radial grid, so the all-electron and pseudo functions of all local atoms
+         *  of a type are stacked along the radial index. The SHT transforms are then done with one GEMM per component
+         *  and libxc is called once per thread for the whole batch; only the radial gradients of the GGA terms are
+         *  computed atom by atom. The buffers are allocated in init_PAW() and reused in every SCF iteration. */
+        struct paw_xc_batch_t
+        {
+            /// Atom type of the batch.
+            Atom_type const* type_{nullptr};
+
+            /// Local indices of the atoms in paw_potential_data_.
+            std::vector<int> atoms_;
+
+            /// Total density or spin-up and spin-down densities in Rlm.
+            std::vector<mdarray<double, 1>> rho_lm_;
+
+            /// Total density or spin-up and spin-down densities in (theta, phi).
+            std::vector<mdarray<double, 2>> rho_tp_;
+
+            /// Charge density and magnetization in (theta, phi) for the non-collinear case.
+            std::vector<mdarray<double, 2>> rho_nc_tp_;
+
+            /// Total XC potential or spin-up and spin-down XC potentials in (theta, phi).
+            std::vector<mdarray<double, 2>> vxc_tp_;
+
+            /// XC energy density in (theta, phi).
+            mdarray<double, 2> exc_tp_;
+
+            /// Gradients of the densities in (theta, phi), three components for each spin.
+            std::vector<mdarray<double, 2>> grad_rho_tp_;
+
+            /// Laplacians of the densities in (theta, phi).
+            std::vector<mdarray<double, 2>> lapl_rho_tp_;
+
+            /// Contracted density gradients (total or uu, ud and dd) in (theta, phi).
+            std::vector<mdarray<double, 2>> sigma_tp_;
+
+            /// Derivatives of the XC energy density with respect to the contracted gradients.
+            std::vector<mdarray<double, 2>> vsigma_tp_;
+
+            /// Gradient of a single vsigma component in (theta, phi).
+            std::vector<mdarray<double, 2>> grad_vsigma_tp_;
+
+            /// Scratch space for three stacked functions in Rlm.
+            mdarray<double, 2> f_lm_;
+        };
+
         std::vector<double> paw_hartree_energies_;
         std::vector<double> paw_xc_energies_;
         std::vector<double> paw_core_energies_;
@@ -144,24 +191,23 @@ class Potential
 
         std::vector<paw_potential_data_t> paw_potential_data_;
 
+        /// One-centre XC workspaces of the local PAW atoms, one per atom type.
+        std::vector<paw_xc_batch_t> paw_xc_batch_;
+
         mdarray<double, 4> paw_dij_;
 
         int max_paw_basis_size_{0};
 
         void init_PAW();
 
-        double xc_mt_PAW_nonmagnetic(Spheric_function<spectral, double>& full_potential,
-                                     Spheric_function<spectral, double> const& full_density,
-                                     std::vector<double> const& rho_core);
+        /// Add the one-centre XC potential of the stacked PAW functions and compute their XC energies.
+        void xc_mt_PAW(paw_xc_batch_t& batch__,
+                       std::vector<std::vector<Spheric_function<spectral, double>> const*> const& density__,
+                       std::vector<std::vector<double> const*> const& rho_core__,
+                       std::vector<std::vector<Spheric_function<spectral, double>>*> const& potential__,
+                       std::vector<double>& energy__);
 
-
-        double xc_mt_PAW_collinear(std::vector<Spheric_function<spectral, double>>& potential,
-                                   std::vector<Spheric_function<spectral, double>> const& density,
-                                   std::vector<double> const& rho_core);
-
-        double xc_mt_PAW_noncollinear(std::vector<Spheric_function<spectral, double>>& potential,
-                                      std::vector<Spheric_function<spectral, double>> const& density,
-                                      std::vector<double> const& rho_core);
+        void calc_PAW_xc_potential(paw_xc_batch_t& batch__, Density const& density__);
 
         void calc_PAW_local_potential(paw_potential_data_t &pdd,
                                       std::vector<Spheric_function<spectral, double>> const& ae_density,
@@ -271,7 +317,7 @@ class Potential
         {
             PROFILE("sirius::Potential::generate_local_potential");
             
-            Radial_integrals_vloc<false> ri(ctx_.unit_cell(), ctx_.pw_cutoff(), ctx_.settings().nprii_vloc_);
+            auto& ri = ctx_.vloc_ri();
             auto v = ctx_.make_periodic_function<index_domain_t::local>([&](int iat, double g)
                                                                         {
                                                                             if (this->ctx_.unit_cell().atom_type(iat).local_potential().empty()) {
@@ -910,6 +956,22 @@ class Potential
             }
         }
         
+        /// Update the position-dependent parts of the potential after the atoms were moved.
+        inline void update()
+        {
+            PROFILE("sirius::Potential::update");
+
+            if (!ctx_.full_potential()) {
+                bool is_empty{true};
+                for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+                    is_empty &= unit_cell_.atom_type(iat).local_potential().empty();
+                }
+                if (!is_empty) {
+                    generate_local_potential();
+                }
+            }
+        }
+
         inline void update_atomic_potential()
         {
             for (int ic = 0; ic < unit_cell_.num_atom_symmetry_classes(); ic++) {
@@ -463,6 +463,255 @@ class Radial_solver
             return nn;
         }
 
+        /// Integrate the homogeneous radial equation forward for a batch of energies.
+        /** All energies share the radial grid and the interpolated potential, so the spline is evaluated once per
+         *  grid step for the whole batch and the inner loops run over independent energies. Only the quantities
+         *  needed to locate the band edges are returned: the number of nodes, \f$ p(R) \f$ and \f$ p'(R) \f$.
+         *
+         *  With radial_integrator_t::rk4 the arithmetic is identical to integrate_forward_rk4() with zero
+         *  inhomogeneous terms. With radial_integrator_t::abm4 the first three steps are done with RK4 and the rest
+         *  with the fourth-order Adams-Bashforth predictor and Adams-Moulton corrector (PECE). The right-hand side
+         *  is then evaluated twice per step and only at the grid points, so the mid-point values of the potential
+         *  spline are not needed. The Adams weights are the integrals of the Lagrange polynomials over the current
+         *  step of the non-uniform grid; they are computed with the two-point Gauss rule, which is exact for cubic
+         *  polynomials. */
+        template <relativity_t rel, radial_integrator_t method>
+        void integrate_forward_batch(int l__,
+                                     std::vector<double> const& enu__,
+                                     std::vector<int>& nn__,
+                                     std::vector<double>& p__,
+                                     std::vector<double>& dpdr__) const
+        {
+            static_assert(rel != relativity_t::dirac, "batched integration is not implemented for Dirac equation");
+
+            int nr = num_points();
+            int nb = static_cast<int>(enu__.size());
+
+            double sq_alpha_half = (rel == relativity_t::none) ? 0 : 0.5 / std::pow(speed_of_light, 2);
+
+            double ll_half = l__ * (l__ + 1) / 2.0;
+
+            auto rel_mass = [sq_alpha_half](double enu__, double v__) -> double
+            {
+                switch (rel) {
+                    case relativity_t::koelling_harmon: {
+                        return 1.0 + sq_alpha_half * (enu__ - v__);
+                    }
+                    case relativity_t::zora: {
+                        return 1.0 - sq_alpha_half * v__;
+                    }
+                    case relativity_t::iora: {
+                        double m0 = 1.0 - sq_alpha_half * v__;
+                        return m0 / (1 - sq_alpha_half * enu__ / m0);
+                    }
+                    default: {
+                        return 1.0;
+                    }
+                }
+            };
+
+            /* effective potential V - E + l(l+1)/(2Mr^2) at a point with the potential v and x^2 = xsq */
+            auto w_eff = [ll_half, sq_alpha_half, &rel_mass](double e, double v, double xsq) -> double
+            {
+                if (rel == relativity_t::iora) {
+                    /* energy-independent part of the IORA centrifugal term */
+                    double m = 1 - sq_alpha_half * v;
+                    double a = ll_half / m / xsq;
+                    return v - e + a - sq_alpha_half * a * e / m;
+                } else {
+                    return v - e + ll_half / rel_mass(e, v) / xsq;
+                }
+            };
+
+            nn__.assign(nb, 0);
+            p__.resize(nb);
+            dpdr__.resize(nb);
+            std::vector<double> q(nb);
+
+            double x2    = radial_grid_[0];
+            double xinv2 = radial_grid_.x_inv(0);
+            double v2    = ve_(0) - zn_ / x2;
+
+            /* r->0 asymptotics */
+            for (int j = 0; j < nb; j++) {
+                if (l__ == 0) {
+                    p__[j] = 2 * zn_ * x2;
+                    q[j]   = -std::pow(zn_, 2) * x2;
+                } else {
+                    p__[j] = std::pow(x2, l__ + 1);
+                    q[j]   = std::pow(x2, l__) * l__ / 2;
+                }
+            }
+
+            /* derivatives p' and q' at the last four grid points for the Adams steps; point i is stored in the
+             * slot i % 4 */
+            std::vector<double> dp;
+            std::vector<double> dq;
+            /* store derivatives at the grid point i */
+            auto store_deriv = [&](int i, double xinv, double v, double xsq)
+            {
+                for (int j = 0; j < nb; j++) {
+                    double e = enu__[j];
+                    dp[(i % 4) * nb + j] = 2 * rel_mass(e, v) * q[j] + p__[j] * xinv;
+                    dq[(i % 4) * nb + j] = w_eff(e, v, xsq) * p__[j] - q[j] * xinv;
+                }
+            };
+            if (method == radial_integrator_t::abm4) {
+                dp.resize(4 * nb);
+                dq.resize(4 * nb);
+                store_deriv(0, xinv2, v2, std::pow(x2, 2));
+            }
+
+            /* integrals of the Lagrange polynomials with the nodes t[0..3] over [a, b] */
+            auto adams_weights = [](double const* t, double a, double b, double* w)
+            {
+                double h = b - a;
+                double g[] = {a + h * (0.5 - 0.5 / std::sqrt(3.0)), a + h * (0.5 + 0.5 / std::sqrt(3.0))};
+                for (int k = 0; k < 4; k++) {
+                    w[k] = 0;
+                    for (double x: g) {
+                        double L{1};
+                        for (int m = 0; m < 4; m++) {
+                            if (m != k) {
+                                L *= (x - t[m]) / (t[k] - t[m]);
+                            }
+                        }
+                        w[k] += L * h / 2;
+                    }
+                }
+            };
+
+            for (int i = 0; i < nr - 1; i++) {
+                /* grid and potential are shared by all energies */
+                double x0     = x2;
+                double xinv0  = xinv2;
+                double v0     = v2;
+                double h      = radial_grid_.dx(i);
+                x2            = radial_grid_[i + 1];
+                xinv2         = radial_grid_.x_inv(i + 1);
+                v2            = ve_(i + 1) - zn_ * xinv2;
+
+                double x0sq = std::pow(x0, 2);
+                double x2sq = std::pow(x2, 2);
+
+                if (method == radial_integrator_t::rk4 || i < 3) {
+                    double h_half = h / 2;
+                    double x1     = x0 + h_half;
+                    double xinv1  = 1.0 / x1;
+                    double v1     = ve_(i, h_half) - zn_ * xinv1;
+                    double x1sq   = std::pow(x1, 2);
+
+                    for (int j = 0; j < nb; j++) {
+                        double e  = enu__[j];
+                        double M0 = rel_mass(e, v0);
+                        double M1 = rel_mass(e, v1);
+                        double M2 = rel_mass(e, v2);
+                        /* effective potentials at x, x + h/2 and x + h */
+                        double w0 = w_eff(e, v0, x0sq);
+                        double w1 = w_eff(e, v1, x1sq);
+                        double w2 = w_eff(e, v2, x2sq);
+
+                        double p0 = p__[j];
+                        double q0 = q[j];
+
+                        double pk0 = 2 * M0 * q0 + p0 * xinv0;
+                        double qk0 = w0 * p0 - q0 * xinv0;
+
+                        double pk1 = 2 * M1 * (q0 + qk0 * h_half) + (p0 + pk0 * h_half) * xinv1;
+                        double qk1 = w1 * (p0 + pk0 * h_half) - (q0 + qk0 * h_half) * xinv1;
+
+                        double pk2 = 2 * M1 * (q0 + qk1 * h_half) + (p0 + pk1 * h_half) * xinv1;
+                        double qk2 = w1 * (p0 + pk1 * h_half) - (q0 + qk1 * h_half) * xinv1;
+
+                        double pk3 = 2 * M2 * (q0 + qk2 * h) + (p0 + pk2 * h) * xinv2;
+                        double qk3 = w2 * (p0 + pk2 * h) - (q0 + qk2 * h) * xinv2;
+
+                        double p2 = p0 + (pk0 + 2 * (pk1 + pk2) + pk3) * h / 6.0;
+                        double q2 = q0 + (qk0 + 2 * (qk1 + qk2) + qk3) * h / 6.0;
+
+                        /* rescale; this changes neither the number of nodes nor the signs of p and p' */
+                        if (std::abs(p2) > 1e4) {
+                            p2 /= 1e4;
+                            q2 /= 1e4;
+                            for (int k = 0; k < static_cast<int>(dp.size()) / nb; k++) {
+                                dp[k * nb + j] /= 1e4;
+                                dq[k * nb + j] /= 1e4;
+                            }
+                        }
+                        if (p0 * p2 < 0.0) {
+                            nn__[j]++;
+                        }
+                        p__[j] = p2;
+                        q[j]   = q2;
+                    }
+                    if (method == radial_integrator_t::abm4) {
+                        store_deriv(i + 1, xinv2, v2, x2sq);
+                    }
+                } else {
+                    /* Adams-Bashforth weights with the nodes x_{i-3}..x_i and Adams-Moulton weights with the
+                     * nodes x_{i-2}..x_{i+1} */
+                    double wb[4];
+                    double wm[4];
+                    double t[] = {radial_grid_[i - 3], radial_grid_[i - 2], radial_grid_[i - 1], x0, x2};
+                    adams_weights(&t[0], x0, x2, wb);
+                    adams_weights(&t[1], x0, x2, wm);
+                    /* slots of the points i-3, i-2, i-1, i; slot of i-3 is reused for i+1 */
+                    int s[] = {(i - 3) % 4, (i - 2) % 4, (i - 1) % 4, i % 4};
+
+                    for (int j = 0; j < nb; j++) {
+                        double e  = enu__[j];
+                        double M2 = rel_mass(e, v2);
+                        double w2 = w_eff(e, v2, x2sq);
+
+                        double p0 = p__[j];
+                        double q0 = q[j];
+
+                        /* predict */
+                        double p2 = p0;
+                        double q2 = q0;
+                        for (int k = 0; k < 4; k++) {
+                            p2 += wb[k] * dp[s[k] * nb + j];
+                            q2 += wb[k] * dq[s[k] * nb + j];
+                        }
+                        /* evaluate */
+                        double dp2 = 2 * M2 * q2 + p2 * xinv2;
+                        double dq2 = w2 * p2 - q2 * xinv2;
+                        /* correct */
+                        p2 = p0 + wm[3] * dp2;
+                        q2 = q0 + wm[3] * dq2;
+                        for (int k = 0; k < 3; k++) {
+                            p2 += wm[k] * dp[s[k + 1] * nb + j];
+                            q2 += wm[k] * dq[s[k + 1] * nb + j];
+                        }
+
+                        /* rescale; this changes neither the number of nodes nor the signs of p and p' */
+                        if (std::abs(p2) > 1e4) {
+                            p2 /= 1e4;
+                            q2 /= 1e4;
+                            for (int k = 1; k < 4; k++) {
+                                dp[s[k] * nb + j] /= 1e4;
+                                dq[s[k] * nb + j] /= 1e4;
+                            }
+                        }
+                        if (p0 * p2 < 0.0) {
+                            nn__[j]++;
+                        }
+                        p__[j] = p2;
+                        q[j]   = q2;
+                        /* evaluate */
+                        dp[s[0] * nb + j] = 2 * M2 * q2 + p2 * xinv2;
+                        dq[s[0] * nb + j] = w2 * p2 - q2 * xinv2;
+                    }
+                }
+            }
+
+            double V = ve_(nr - 1) - zn_ * radial_grid_.x_inv(nr - 1);
+            for (int j = 0; j < nb; j++) {
+                /* P' = 2MQ + \frac{P}{r} */
+                dpdr__[j] = 2 * rel_mass(enu__[j], V) * q[j] + p__[j] * radial_grid_.x_inv(nr - 1);
+            }
+        }
+
         //== inline double extrapolate_to_zero(int istep, double y, double* x, double* work) const
         //== {
         //==     double dy = y;
@@ -1046,6 +1295,66 @@ class Enu_finder: public Radial_solver
         double etop_;
         double ebot_;
 
+        /// Number of energies integrated simultaneously in the search for the band edges.
+        static const int batch_size_{8};
+
+        /// Method of the forward integration.
+        radial_integrator_t integrator_;
+
+        /// Integrate radial equation for a batch of energies.
+        template <radial_integrator_t method>
+        void integrate_batch(relativity_t rel__,
+                             std::vector<double> const& enu__,
+                             std::vector<int>& nn__,
+                             std::vector<double>& p__,
+                             std::vector<double>& dpdr__) const
+        {
+            switch (rel__) {
+                case relativity_t::none: {
+                    integrate_forward_batch<relativity_t::none, method>(l_, enu__, nn__, p__, dpdr__);
+                    break;
+                }
+                case relativity_t::koelling_harmon: {
+                    integrate_forward_batch<relativity_t::koelling_harmon, method>(l_, enu__, nn__, p__, dpdr__);
+                    break;
+                }
+                case relativity_t::zora: {
+                    integrate_forward_batch<relativity_t::zora, method>(l_, enu__, nn__, p__, dpdr__);
+                    break;
+                }
+                case relativity_t::iora: {
+                    integrate_forward_batch<relativity_t::iora, method>(l_, enu__, nn__, p__, dpdr__);
+                    break;
+                }
+                default: {
+                    TERMINATE_NOT_IMPLEMENTED
+                }
+            }
+        }
+
+        /// Integrate radial equation for a batch of energies with the selected method.
+        void integrate_batch(relativity_t rel__,
+                             std::vector<double> const& enu__,
+                             std::vector<int>& nn__,
+                             std::vector<double>& p__,
+                             std::vector<double>& dpdr__) const
+        {
+            switch (integrator_) {
+                case radial_integrator_t::rk4: {
+                    integrate_batch<radial_integrator_t::rk4>(rel__, enu__, nn__, p__, dpdr__);
+                    break;
+                }
+                case radial_integrator_t::abm4: {
+                    integrate_batch<radial_integrator_t::abm4>(rel__, enu__, nn__, p__, dpdr__);
+                    break;
+                }
+            }
+        }
+
+        /// Find the band edges and the linearization energy.
+        /** Both edges are first bracketed by a batch of energies with growing steps and then refined by
+         *  multisection: each pass over the radial grid evaluates batch_size_ equally spaced energies inside the
+         *  bracket and shrinks it by a factor of batch_size_ + 1. */
         void find_enu(relativity_t rel__, double enu_start__)
         {
             int np = num_points();
@@ -1057,170 +1366,172 @@ class Enu_finder: public Radial_solver
             std::vector<double> q(np);
             std::vector<double> dpdr(np);
             std::vector<double> dqdr(np);
-            
-            double enu = enu_start__;
-            double de = 0.001;
-            bool found = false;
-            int nndp = 0;
+
+            int const nb = batch_size_;
+
+            std::vector<double> e(nb);
+            std::vector<int> nn_b;
+            std::vector<double> p_b;
+            std::vector<double> dpdr_b;
 
             /* We want to find enu such that the wave-function at the muffin-tin boundary is zero
              * and the number of nodes inside muffin-tin is equal to n-l-1. This will be the top 
-             * of the band. */
-            for (int i = 0; i < 1000; i++) {
-                int nnd{0};
+             * of the band. Number of nodes is greater than n-l-1 above this energy. */
+            int nn_top = n_ - l_ - 1;
 
-                switch (rel__) {
-                    case relativity_t::none: {
-                        nnd = integrate_forward_rk4<relativity_t::none, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
-                        break;
-                    }
-                    case relativity_t::koelling_harmon: {
-                        nnd = integrate_forward_rk4<relativity_t::koelling_harmon, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
-                        break;
-                    }
-                    case relativity_t::zora: {
-                        nnd = integrate_forward_rk4<relativity_t::zora, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
+            integrate_batch(rel__, {enu_start__}, nn_b, p_b, dpdr_b);
+            bool above = (nn_b[0] > nn_top);
+
+            double e_lo{enu_start__};
+            double e_hi{enu_start__};
+            bool found{false};
+            double e0 = enu_start__;
+            double de = 0.001;
+            for (int iter = 0; iter < 100 && !found; iter++) {
+                for (int j = 0; j < nb; j++) {
+                    e[j] = e0 + (above ? -de : de) * (j + 1);
+                }
+                integrate_batch(rel__, e, nn_b, p_b, dpdr_b);
+                for (int j = 0; j < nb; j++) {
+                    if ((nn_b[j] > nn_top) != above) {
+                        e_lo = (j == 0) ? e0 : e[j - 1];
+                        e_hi = e[j];
+                        found = true;
                         break;
                     }
-                    case relativity_t::iora: {
-                        nnd = integrate_forward_rk4<relativity_t::iora, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
+                }
+                e0 = e[nb - 1];
+                de *= 2;
+            }
+            if (e_lo > e_hi) {
+                std::swap(e_lo, e_hi);
+            }
+            for (int iter = 0; iter < 100 && found && e_hi - e_lo > 1e-10; iter++) {
+                for (int j = 0; j < nb; j++) {
+                    e[j] = e_lo + (e_hi - e_lo) * (j + 1) / (nb + 1);
+                }
+                integrate_batch(rel__, e, nn_b, p_b, dpdr_b);
+                int j0{nb};
+                for (int j = 0; j < nb; j++) {
+                    if (nn_b[j] > nn_top) {
+                        j0 = j;
                         break;
                     }
-                    default: {
-                        TERMINATE_NOT_IMPLEMENTED
-                    }
                 }
-                nnd -= (n_ - l_ - 1);
-
-                enu = (nnd > 0) ? enu - de : enu + de;
-
-                if (i) {
-                    de = (nnd != nndp) ? de * 0.5 : de * 1.25;
+                if (j0 > 0) {
+                    e_lo = e[j0 - 1];
                 }
-                if (std::abs(de) < 1e-10) {
-                    found = true;
-                    break;
+                if (j0 < nb) {
+                    e_hi = e[j0];
                 }
-                nndp = nnd;
             }
-            etop_ = (!found) ? enu_start__ : enu;
-
-            auto surface_deriv = [this, &dpdr, &p]()
-            {
-                if (true) {
-                    /* return  p'(R) */
-                    return dpdr.back();
-                } else {
-                    /* return R*u'(R) */
-                    return dpdr.back() - p.back() / radial_grid_.last();
-                }
-            };
+            etop_ = (!found) ? enu_start__ : (e_lo + e_hi) / 2;
 
-            double sd = surface_deriv();
+            /* surface derivative p'(R) just below the top of the band; p(R) and p'(R) of the strongly
+             * bound states change sign together at the top, so the side of the bracket matters */
+            integrate_batch(rel__, {found ? e_lo : enu_start__}, nn_b, p_b, dpdr_b);
+            double sd = dpdr_b[0];
             
             /* Now we go down in energy and serach for enu such that the wave-function derivative is zero
              * at the muffin-tin boundary. This will be the bottom of the band. */
+            e0 = etop_;
+            e_lo = e_hi = etop_;
             de = 1e-4;
-            for (int i = 0; i < 100; i++) {
-                de *= 1.1;
-                enu -= de;
-                switch (rel__) {
-                    case relativity_t::none: {
-                        integrate_forward_rk4<relativity_t::none, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
-                        break;
-                    }
-                    case relativity_t::koelling_harmon: {
-                        integrate_forward_rk4<relativity_t::koelling_harmon, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
+            found = false;
+            /* at most 100 energies are tried */
+            for (int i = 0; i < 100 && !found; i += nb) {
+                e.resize(std::min(nb, 100 - i));
+                for (size_t j = 0; j < e.size(); j++) {
+                    de *= 1.1;
+                    e[j] = ((j == 0) ? e0 : e[j - 1]) - de;
+                }
+                integrate_batch(rel__, e, nn_b, p_b, dpdr_b);
+                for (size_t j = 0; j < e.size(); j++) {
+                    e_lo = e[j];
+                    e_hi = (j == 0) ? e0 : e[j - 1];
+                    if (dpdr_b[j] * sd <= 0) {
+                        found = true;
                         break;
                     }
-                    case relativity_t::zora: {
-                        integrate_forward_rk4<relativity_t::zora, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
+                }
+                e0 = e.back();
+            }
+            e.resize(nb);
+
+            /* refine bottom energy; derivative has the same sign as sd above the bottom of the band */
+            double enu = e_lo;
+            for (int iter = 0; iter < 100 && e_hi - e_lo > 1e-12; iter++) {
+                for (int j = 0; j < nb; j++) {
+                    e[j] = e_lo + (e_hi - e_lo) * (j + 1) / (nb + 1);
+                }
+                integrate_batch(rel__, e, nn_b, p_b, dpdr_b);
+                int j0{nb};
+                bool exact{false};
+                for (int j = 0; j < nb; j++) {
+                    /* derivative at the boundary */
+                    if (std::abs(dpdr_b[j]) < 1e-10) {
+                        enu = e[j];
+                        exact = true;
                         break;
                     }
-                    case relativity_t::iora: {
-                        integrate_forward_rk4<relativity_t::iora, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
+                    if (dpdr_b[j] * sd > 0) {
+                        j0 = j;
                         break;
                     }
-                    default: {
-                        TERMINATE_NOT_IMPLEMENTED
-                    }
                 }
-                if (surface_deriv() * sd <= 0) {
+                if (exact) {
+                    e_lo = e_hi = enu;
                     break;
                 }
+                if (j0 > 0) {
+                    e_lo = e[j0 - 1];
+                }
+                if (j0 < nb) {
+                    e_hi = e[j0];
+                }
+                enu = (e_lo + e_hi) / 2;
             }
-
-            /* refine bottom energy */
-            double e1 = enu;
-            double e0 = enu + de;
-
-            for (int i = 0; i < 100; i++) {
-                enu = (e1 + e0) / 2.0;
+        
+            ebot_ = enu;
+            /* last check; the nodes of the strongly bound states near the band edges depend on the integration
+             * error, so they are counted with the same method */
+            int nn{0};
+            if (integrator_ == radial_integrator_t::rk4) {
                 switch (rel__) {
                     case relativity_t::none: {
-                        integrate_forward_rk4<relativity_t::none, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
+                        nn = integrate_forward_rk4<relativity_t::none, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
                         break;
                     }
                     case relativity_t::koelling_harmon: {
-                        integrate_forward_rk4<relativity_t::koelling_harmon, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
+                        nn = integrate_forward_rk4<relativity_t::koelling_harmon, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
                         break;
                     }
                     case relativity_t::zora: {
-                        integrate_forward_rk4<relativity_t::zora, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
+                        nn = integrate_forward_rk4<relativity_t::zora, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
                         break;
                     }
                     case relativity_t::iora: {
-                        integrate_forward_rk4<relativity_t::iora, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
+                        nn = integrate_forward_rk4<relativity_t::iora, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
                         break;
                     }
                     default: {
                         TERMINATE_NOT_IMPLEMENTED
                     }
                 }
-                /* derivative at the boundary */
-                if (std::abs(surface_deriv()) < 1e-10) {
-                    break;
-                }
-
-                if (surface_deriv() * sd > 0) {
-                    e0 = enu;
-                } else {
-                    e1 = enu;
-                }
-            }
-        
-            ebot_ = enu;
-            /* last check */
-            int nn{0};
-            switch (rel__) {
-                case relativity_t::none: {
-                    nn = integrate_forward_rk4<relativity_t::none, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
-                    break;
-                }
-                case relativity_t::koelling_harmon: {
-                    nn = integrate_forward_rk4<relativity_t::koelling_harmon, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
-                    break;
-                }
-                case relativity_t::zora: {
-                    nn = integrate_forward_rk4<relativity_t::zora, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
-                    break;
-                }
-                case relativity_t::iora: {
-                    nn = integrate_forward_rk4<relativity_t::iora, false>(enu, l_, 0, chi_p, chi_q, p, dpdr, q, dqdr);
-                    break;
-                }
-                default: {
-                    TERMINATE_NOT_IMPLEMENTED
-                }
+            } else {
+                integrate_batch(rel__, {enu}, nn_b, p_b, dpdr_b);
+                nn = nn_b[0];
             }
 
             if (nn != n_ - l_ - 1) {
-                FILE* fout = fopen("p.dat", "w");
-                for (int ir = 0; ir < np; ir++) {
-                    double x = radial_grid(ir);
-                    fprintf(fout, "%16.8f %16.8f %16.8f\n", x, p[ir], q[ir]);
+                if (integrator_ == radial_integrator_t::rk4) {
+                    FILE* fout = fopen("p.dat", "w");
+                    for (int ir = 0; ir < np; ir++) {
+                        double x = radial_grid(ir);
+                        fprintf(fout, "%16.8f %16.8f %16.8f\n", x, p[ir], q[ir]);
+                    }
+                    fclose(fout);
                 }
-                fclose(fout);
 
                 //printf("n: %i, l: %i, nn: %i", n_, l_, nn);
                 std::stringstream s;
@@ -1244,10 +1555,12 @@ class Enu_finder: public Radial_solver
                    int l__,
                    Radial_grid<double> const& radial_grid__,
                    std::vector<double> const& v__,
-                   double enu_start__)
+                   double enu_start__,
+                   radial_integrator_t integrator__ = radial_integrator_t::rk4)
             : Radial_solver(zn__, v__, radial_grid__),
               n_(n__),
-              l_(l__)
+              l_(l__),
+              integrator_(integrator__)
         {
             assert(l_ < n_); 
             find_enu(rel__, enu_start__);
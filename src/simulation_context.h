@@ -101,6 +101,19 @@ class Simulation_context : public Simulation_context_base
         }
     }
 
+    /// Update the position-dependent data after the atoms were moved.
+    /** Augmentation operators depend only on atom types and are kept. */
+    void update_atomic_positions()
+    {
+        PROFILE("sirius::Simulation_context::update_atomic_positions");
+
+        Simulation_context_base::update_atomic_positions();
+
+        if (full_potential()) {
+            step_function_ = std::unique_ptr<Step_function>(new Step_function(*this));
+        }
+    }
+
     Step_function const& step_function() const
     {
         return *step_function_;
@@ -31,6 +31,7 @@
 #include "simulation_parameters.h"
 #include "mpi_grid.hpp"
 #include "radial_integrals.h"
+#include "eigensolver_tuner.hpp"
 
 #ifdef __GPU
 extern "C" void generate_phase_factors_gpu(int num_gvec_loc__,
@@ -102,6 +103,12 @@ class Simulation_context_base: public Simulation_parameters
         
         /// Phase factors for atom types.
         mdarray<double_complex, 2> phase_factors_t_;
+
+        /// Cached phase factors of atoms for each atom type.
+        /** For each atom type the array of size (number of local G-vectors) x (number of atoms of the type) is stored
+         *  if it fits into the memory budget defined by Control_input::phase_factors_cache_size_; otherwise the
+         *  array is empty and the phase factors are generated on demand. */
+        std::vector<mdarray<double_complex, 2>> phase_factors_cache_;
         
         mdarray<int, 2> gvec_coord_;
 
@@ -117,6 +124,10 @@ class Simulation_context_base: public Simulation_parameters
 
         std::unique_ptr<Radial_integrals_atomic_wf> atomic_wf_ri_;
 
+        std::unique_ptr<Radial_integrals_vloc<false>> vloc_ri_;
+
+        std::unique_ptr<Radial_integrals_rho_core_pseudo<false>> ps_core_ri_;
+
         std::vector<std::vector<std::pair<int, double>>> atoms_to_grid_idx_;
 
         // TODO remove to somewhere
@@ -126,6 +137,9 @@ class Simulation_context_base: public Simulation_parameters
 
         bool initialized_{false};
 
+        /// Select eigen-value solvers, BLACS grid and cyclic block size by benchmarking them.
+        inline void tune_evp_solvers();
+
         inline void init_fft()
         {
             auto rlv = unit_cell_.reciprocal_lattice_vectors();
@@ -240,6 +254,94 @@ class Simulation_context_base: public Simulation_parameters
             }
         }
 
+        /// Generate phase factors of atoms and of the symmetry operations.
+        void init_phase_factors()
+        {
+            PROFILE("sirius::Simulation_context_base::init_phase_factors");
+
+            auto& fft_grid = fft().grid();
+            std::pair<int, int> limits(0, 0);
+            for (int x: {0, 1, 2}) {
+                limits.first  = std::min(limits.first,  fft_grid.limits(x).first); 
+                limits.second = std::max(limits.second, fft_grid.limits(x).second); 
+            }
+
+            phase_factors_ = mdarray<double_complex, 3>(3, limits, unit_cell().num_atoms(), memory_t::host, "phase_factors_");
+
+            #pragma omp parallel for
+            for (int i = limits.first; i <= limits.second; i++) {
+                for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
+                    auto pos = unit_cell_.atom(ia).position();
+                    for (int x: {0, 1, 2}) {
+                        phase_factors_(x, i, ia) = std::exp(double_complex(0.0, twopi * (i * pos[x])));
+                    }
+                }
+            }
+
+            /* cache phase factors of atom types within the memory budget */
+            phase_factors_cache_ = std::vector<mdarray<double_complex, 2>>(unit_cell().num_atom_types());
+            size_t cache_size{0};
+            for (int iat = 0; iat < unit_cell().num_atom_types(); iat++) {
+                size_t sz = sizeof(double_complex) * gvec().count() * unit_cell().atom_type(iat).num_atoms();
+                if ((cache_size + sz) / double(1 << 20) <= control().phase_factors_cache_size_) {
+                    mdarray<double_complex, 2> pf(gvec().count(), unit_cell().atom_type(iat).num_atoms(), memory_t::host,
+                                                  "phase_factors_cache_");
+                    generate_phase_factors(iat, 0, gvec().count(), pf.at<CPU>(), pf.ld());
+                    phase_factors_cache_[iat] = std::move(pf);
+                    cache_size += sz;
+                }
+            }
+
+            phase_factors_t_ = mdarray<double_complex, 2>(gvec().count(), unit_cell().num_atom_types());
+            phase_factors_t_.zero();
+            int const gvec_block_size{1024};
+            for (int iat = 0; iat < unit_cell().num_atom_types(); iat++) {
+                int na = unit_cell().atom_type(iat).num_atoms();
+                mdarray<double_complex, 2> pf(std::min(gvec_block_size, gvec().count()), na);
+                for (int igloc0 = 0; igloc0 < gvec().count(); igloc0 += gvec_block_size) {
+                    int ngv = std::min(gvec_block_size, gvec().count() - igloc0);
+                    generate_phase_factors(iat, igloc0, ngv, pf.at<CPU>(), pf.ld());
+                    #pragma omp parallel for schedule(static)
+                    for (int j = 0; j < ngv; j++) {
+                        for (int i = 0; i < na; i++) {
+                            phase_factors_t_(igloc0 + j, iat) += pf(j, i);
+                        }
+                    }
+                }
+            }
+
+            if (use_symmetry()) {
+                sym_phase_factors_ = mdarray<double_complex, 3>(3, limits, unit_cell().symmetry().num_mag_sym());
+
+                #pragma omp parallel for
+                for (int i = limits.first; i <= limits.second; i++) {
+                    for (int isym = 0; isym < unit_cell().symmetry().num_mag_sym(); isym++) {
+                        auto t = unit_cell().symmetry().magnetic_group_symmetry(isym).spg_op.t;
+                        for (int x: {0, 1, 2}) {
+                            sym_phase_factors_(x, i, isym) = std::exp(double_complex(0.0, twopi * (i * t[x])));
+                        }
+                    }
+                }
+            }
+        }
+
+        /// Copy atomic positions to the device memory.
+        void init_atom_coord()
+        {
+            atom_coord_.clear();
+            for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+                int nat = unit_cell_.atom_type(iat).num_atoms();
+                atom_coord_.push_back(std::move(mdarray<double, 2>(nat, 3, memory_t::host | memory_t::device)));
+                for (int i = 0; i < nat; i++) {
+                    int ia = unit_cell_.atom_type(iat).atom_id(i);
+                    for (int x: {0, 1, 2}) {
+                        atom_coord_.back()(i, x) = unit_cell_.atom(ia).position()[x];
+                    }
+                }
+                atom_coord_.back().copy<memory_t::host, memory_t::device>();
+            }
+        }
+
     public:
 
         Simulation_context_base(std::string const& fname__,
@@ -262,6 +364,28 @@ class Simulation_context_base: public Simulation_parameters
         /// Initialize the similation (can only be called once).
         void initialize();
 
+        /// Update the position-dependent data after the atoms were moved.
+        /** Nearest neighbours, symmetry, mapping of atoms to the real-space grid and the phase factors are
+         *  regenerated. Radial integrals and all other tables which don't depend on atomic positions are kept. */
+        void update_atomic_positions()
+        {
+            PROFILE("sirius::Simulation_context_base::update_atomic_positions");
+
+            if (!initialized_) {
+                TERMINATE("simulation context is not initialized");
+            }
+
+            unit_cell_.update();
+
+            init_atoms_to_grid_idx();
+
+            init_phase_factors();
+
+            if (processing_unit() == GPU) {
+                init_atom_coord();
+            }
+        }
+
         std::vector<std::vector<std::pair<int,double>>> const& atoms_to_grid_idx_map()
         {
             return atoms_to_grid_idx_;
@@ -437,10 +561,13 @@ class Simulation_context_base: public Simulation_parameters
             return std::move(Eigensolver_factory<T>(std_evp_solver_type_));
         }
 
+        /// Solver of the generalized eigen-value problem.
+        /** Sequential solvers can share the work between the ranks of the communicator if all of them hold
+         *  the same matrices. */
         template <typename T>
-        inline std::unique_ptr<Eigensolver<T>> gen_evp_solver()
+        inline std::unique_ptr<Eigensolver<T>> gen_evp_solver(Communicator const& comm__ = mpi_comm_self())
         {
-            return std::move(Eigensolver_factory<T>(gen_evp_solver_type_));
+            return std::move(Eigensolver_factory<T>(gen_evp_solver_type_, comm__));
         }
 
         /// Phase factors \f$ e^{i {\bf G} {\bf r}_{\alpha}} \f$
@@ -467,26 +594,81 @@ class Simulation_context_base: public Simulation_parameters
             return atom_coord_[iat__];
         }
 
+        /// Generate phase factors \f$ e^{i {\bf G} {\bf r}_{\alpha}} \f$ for a block of local G-vectors and all atoms of a given type.
+        /** Phase factors are stored in the (G-vector, atom) order with the leading dimension ld__, which makes the
+         *  result ready to be used in GEMMs. Cached phase factors are copied if available. Otherwise the full
+         *  triple product of the 1D phase factors is computed only at the beginning of each z-column of G-vectors;
+         *  along the column the recurrence \f$ e^{i ({\bf G} + {\bf b}_3) {\bf r}_{\alpha}} =
+         *  e^{i {\bf G} {\bf r}_{\alpha}} e^{i {\bf b}_3 {\bf r}_{\alpha}} \f$ is used.
+         *
+         *  \param [in]  iat__    Index of atom type.
+         *  \param [in]  igloc0__ Local index of the first G-vector in the block.
+         *  \param [in]  ngv__    Number of G-vectors in the block.
+         *  \param [out] pf__     Pointer to the output phase factors.
+         *  \param [in]  ld__     Leading dimension of the output array.
+         */
+        inline void generate_phase_factors(int iat__, int igloc0__, int ngv__, double_complex* pf__, int ld__) const
+        {
+            int na = unit_cell_.atom_type(iat__).num_atoms();
+
+            if (phase_factors_cache_.size() && phase_factors_cache_[iat__].size()) {
+                #pragma omp parallel for schedule(static)
+                for (int i = 0; i < na; i++) {
+                    std::copy(&phase_factors_cache_[iat__](igloc0__, i), &phase_factors_cache_[iat__](igloc0__, i) + ngv__,
+                              &pf__[i * ld__]);
+                }
+                return;
+            }
+
+            /* G-vectors are processed in chunks; the recurrence is restarted at the beginning of each chunk */
+            int const chunk_size{256};
+            int nchunk = (ngv__ + chunk_size - 1) / chunk_size;
+
+            #pragma omp parallel for schedule(static)
+            for (int ichunk = 0; ichunk < nchunk; ichunk++) {
+                int ig_begin = ichunk * chunk_size;
+                int ig_end   = std::min(ngv__, ig_begin + chunk_size);
+                for (int i = 0; i < na; i++) {
+                    int ia = unit_cell_.atom_type(iat__).atom_id(i);
+                    double_complex z;
+                    vector3d<int> G0;
+                    for (int j = ig_begin; j < ig_end; j++) {
+                        auto G = gvec().gvec(gvec().offset() + igloc0__ + j);
+                        if (j != ig_begin && G[0] == G0[0] && G[1] == G0[1] && G[2] == G0[2] + 1) {
+                            z *= phase_factors_(2, 1, ia);
+                        } else {
+                            z = gvec_phase_factor(G, ia);
+                        }
+                        pf__[j + i * ld__] = z;
+                        G0 = G;
+                    }
+                }
+            }
+        }
+
+        /// Structure factor of the ionic point charges \f$ \sum_{\alpha} Z_{\alpha} e^{i {\bf G} {\bf r}_{\alpha}} \f$.
+        inline double_complex ion_charge_structure_factor(int igloc__) const
+        {
+            double_complex rho(0, 0);
+            for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+                rho += phase_factors_t_(igloc__, iat) * static_cast<double>(unit_cell_.atom_type(iat).zn());
+            }
+            return rho;
+        }
+
         /// Generate phase factors \f$ e^{i {\bf G} {\bf r}_{\alpha}} \f$ for all atoms of a given type.
         inline void generate_phase_factors(int iat__, mdarray<double_complex, 2>& phase_factors__) const
         {
             PROFILE("sirius::Simulation_context_base::generate_phase_factors");
 
-            int na = unit_cell_.atom_type(iat__).num_atoms();
             switch (processing_unit_) {
                 case CPU: {
-                    #pragma omp parallel for
-                    for (int igloc = 0; igloc < gvec().count(); igloc++) {
-                        int ig = gvec().offset() + igloc;
-                        for (int i = 0; i < na; i++) {
-                            int ia = unit_cell().atom_type(iat__).atom_id(i);
-                            phase_factors__(igloc, i) = gvec_phase_factor(ig, ia);
-                        }
-                    }
+                    generate_phase_factors(iat__, 0, gvec().count(), phase_factors__.at<CPU>(), phase_factors__.ld());
                     break;
                 }
                 case GPU: {
                     #ifdef __GPU
+                    int na = unit_cell_.atom_type(iat__).num_atoms();
                     generate_phase_factors_gpu(gvec().count(), na, gvec_coord().at<GPU>(), atom_coord(iat__).at<GPU>(),
                                                phase_factors__.at<GPU>());
                     #else
@@ -497,37 +679,83 @@ class Simulation_context_base: public Simulation_parameters
             }
         }
 
-        /// Make periodic function out of form factors.
-        /** Return vector of plane-wave coefficients */
+        /// Make several periodic functions out of form factors in one pass.
+        /** Form factors depend only on the length of G-vector, so they are evaluated once per (shell, atom type)
+         *  pair for the shells present in the local fraction of G-vectors and then scattered to all G-vectors of
+         *  the shell with the precomputed structure factors of atom types. Return a vector of plane-wave
+         *  coefficients for each form factor. */
         template <index_domain_t index_domain>
-        inline std::vector<double_complex> make_periodic_function(std::function<double(int, double)> form_factors__) const
+        inline std::vector<std::vector<double_complex>>
+        make_periodic_function(std::vector<std::function<double(int, double)>> form_factors__) const
         {
             PROFILE("sirius::Simulation_context_base::make_periodic_function");
 
             double fourpi_omega = fourpi / unit_cell_.omega();
 
+            int nff = static_cast<int>(form_factors__.size());
+            int nat = unit_cell_.num_atom_types();
+
             int ngv = (index_domain == index_domain_t::local) ? gvec().count() : gvec().num_gvec();
-            std::vector<double_complex> f_pw(ngv, double_complex(0, 0));
+            std::vector<std::vector<double_complex>> f_pw(nff, std::vector<double_complex>(ngv, double_complex(0, 0)));
 
-            #pragma omp parallel for schedule(static)
+            /* local index of G-shell for each local G-vector */
+            std::vector<int> igsh_loc(gvec().count());
+            /* G-vector length for each local G-shell */
+            std::vector<double> gsh_len;
+            std::vector<int> idx_sh(gvec().num_shells(), -1);
             for (int igloc = 0; igloc < gvec().count(); igloc++) {
-                /* global index of G-vector */
-                int ig = gvec().offset() + igloc;
-                double g = gvec().gvec_len(ig);
+                int ig  = gvec().offset() + igloc;
+                int igs = gvec().shell(ig);
+                if (idx_sh[igs] < 0) {
+                    idx_sh[igs] = static_cast<int>(gsh_len.size());
+                    gsh_len.push_back(gvec().gvec_len(ig));
+                }
+                igsh_loc[igloc] = idx_sh[igs];
+            }
+            int nsh = static_cast<int>(gsh_len.size());
+
+            /* table of form factors for each local shell and atom type */
+            mdarray<double, 3> ff(nat, nsh, nff);
+            #pragma omp parallel for schedule(dynamic)
+            for (int i = 0; i < nsh * nat; i++) {
+                int ish = i / nat;
+                int iat = i % nat;
+                for (int k = 0; k < nff; k++) {
+                    ff(iat, ish, k) = fourpi_omega * form_factors__[k](iat, gsh_len[ish]);
+                }
+            }
 
-                int j = (index_domain == index_domain_t::local) ? igloc : ig;
-                for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
-                    f_pw[j] += fourpi_omega * std::conj(phase_factors_t_(igloc, iat)) * form_factors__(iat, g);
+            #pragma omp parallel for schedule(static)
+            for (int igloc = 0; igloc < gvec().count(); igloc++) {
+                int j   = (index_domain == index_domain_t::local) ? igloc : gvec().offset() + igloc;
+                int ish = igsh_loc[igloc];
+                for (int k = 0; k < nff; k++) {
+                    double_complex z(0, 0);
+                    for (int iat = 0; iat < nat; iat++) {
+                        z += std::conj(phase_factors_t_(igloc, iat)) * ff(iat, ish, k);
+                    }
+                    f_pw[k][j] = z;
                 }
             }
 
             if (index_domain == index_domain_t::global) {
-                comm_.allgather(&f_pw[0], gvec().offset(), gvec().count());
+                for (int k = 0; k < nff; k++) {
+                    comm_.allgather(&f_pw[k][0], gvec().offset(), gvec().count());
+                }
             }
 
             return std::move(f_pw);
         }
 
+        /// Make periodic function out of form factors.
+        /** Return vector of plane-wave coefficients */
+        template <index_domain_t index_domain>
+        inline std::vector<double_complex> make_periodic_function(std::function<double(int, double)> form_factors__) const
+        {
+            auto f_pw = make_periodic_function<index_domain>(std::vector<std::function<double(int, double)>>({form_factors__}));
+            return std::move(f_pw[0]);
+        }
+
         /// Return pointer to already allocated temporary memory buffer.
         /** Buffer can only grow in size. The requested buffer length is in bytes. */
         inline void* memory_buffer(size_t size__)
@@ -558,6 +786,16 @@ class Simulation_context_base: public Simulation_parameters
         {
             return *atomic_wf_ri_;
         }
+
+        inline Radial_integrals_vloc<false> const& vloc_ri() const
+        {
+            return *vloc_ri_;
+        }
+
+        inline Radial_integrals_rho_core_pseudo<false> const& ps_core_ri() const
+        {
+            return *ps_core_ri_;
+        }
         
         /// Find the lambda parameter used in the Ewald summation.
         /** lambda parameter scales the erfc function argument:
@@ -698,53 +936,8 @@ inline void Simulation_context_base::initialize()
         }
     }
 
-    auto& fft_grid = fft().grid();
-    std::pair<int, int> limits(0, 0);
-    for (int x: {0, 1, 2}) {
-        limits.first  = std::min(limits.first,  fft_grid.limits(x).first); 
-        limits.second = std::max(limits.second, fft_grid.limits(x).second); 
-    }
+    init_phase_factors();
 
-    phase_factors_ = mdarray<double_complex, 3>(3, limits, unit_cell().num_atoms(), memory_t::host, "phase_factors_");
-
-    #pragma omp parallel for
-    for (int i = limits.first; i <= limits.second; i++) {
-        for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
-            auto pos = unit_cell_.atom(ia).position();
-            for (int x: {0, 1, 2}) {
-                phase_factors_(x, i, ia) = std::exp(double_complex(0.0, twopi * (i * pos[x])));
-            }
-        }
-    }
-
-    phase_factors_t_ = mdarray<double_complex, 2>(gvec().count(), unit_cell().num_atom_types());
-    #pragma omp parallel for schedule(static)
-    for (int igloc = 0; igloc < gvec().count(); igloc++) {
-        /* global index of G-vector */
-        int ig = gvec().offset() + igloc;
-        for (int iat = 0; iat < unit_cell().num_atom_types(); iat++) {
-            double_complex z(0, 0);
-            for (int ia = 0; ia < unit_cell().atom_type(iat).num_atoms(); ia++) {
-                z += gvec_phase_factor(ig, unit_cell().atom_type(iat).atom_id(ia));
-            }
-            phase_factors_t_(igloc, iat) = z;
-        }
-    }
-
-    if (use_symmetry()) {
-        sym_phase_factors_ = mdarray<double_complex, 3>(3, limits, unit_cell().symmetry().num_mag_sym());
-
-        #pragma omp parallel for
-        for (int i = limits.first; i <= limits.second; i++) {
-            for (int isym = 0; isym < unit_cell().symmetry().num_mag_sym(); isym++) {
-                auto t = unit_cell().symmetry().magnetic_group_symmetry(isym).spg_op.t;
-                for (int x: {0, 1, 2}) {
-                    sym_phase_factors_(x, i, isym) = std::exp(double_complex(0.0, twopi * (i * t[x])));
-                }
-            }
-        }
-    }
-    
     int nbnd = static_cast<int>(unit_cell_.num_valence_electrons() / 2.0) +
                                 std::max(10, static_cast<int>(0.1 * unit_cell_.num_valence_electrons()));
     if (full_potential()) {
@@ -805,24 +998,8 @@ inline void Simulation_context_base::initialize()
 
     ev_solver_t* evst[] = {&std_evp_solver_type_, &gen_evp_solver_type_};
 
-    std::map<std::string, ev_solver_t> str_to_ev_solver_t = {
-        {"lapack",    ev_solver_t::lapack},
-        {"scalapack", ev_solver_t::scalapack},
-        {"elpa1",     ev_solver_t::elpa1},
-        {"elpa2",     ev_solver_t::elpa2},
-        {"magma",     ev_solver_t::magma},
-        {"plasma",    ev_solver_t::plasma}
-    };
-
     for (int i: {0, 1}) {
-        auto name = evsn[i];
-
-        if (str_to_ev_solver_t.count(name) == 0) {
-            std::stringstream s;
-            s << "wrong eigen value solver " << name;
-            TERMINATE(s);
-        }
-        *evst[i] = str_to_ev_solver_t[name];
+        *evst[i] = get_ev_solver_t(evsn[i]);
     }
 
     auto std_solver = std_evp_solver<double>();
@@ -839,6 +1016,11 @@ inline void Simulation_context_base::initialize()
         blacs_grid_ = std::unique_ptr<BLACS_grid>(new BLACS_grid(mpi_comm_self(), 1, 1));
     }
 
+    /* replace the default setup by the fastest one */
+    if (control().evp_autotune_) {
+        tune_evp_solvers();
+    }
+
     /* setup the cyclic block size */
     if (cyclic_block_size() < 0) {
         double a = std::min(std::log2(double(num_bands()) / blacs_grid_->num_ranks_col()),
@@ -862,17 +1044,7 @@ inline void Simulation_context_base::initialize()
         }
         gvec_coord_.copy<memory_t::host, memory_t::device>();
 
-        for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
-            int nat = unit_cell_.atom_type(iat).num_atoms();
-            atom_coord_.push_back(std::move(mdarray<double, 2>(nat, 3, memory_t::host | memory_t::device)));
-            for (int i = 0; i < nat; i++) {
-                int ia = unit_cell_.atom_type(iat).atom_id(i);
-                for (int x: {0, 1, 2}) {
-                    atom_coord_.back()(i, x) = unit_cell_.atom(ia).position()[x];
-                }
-            }
-            atom_coord_.back().copy<memory_t::host, memory_t::device>();
-        }
+        init_atom_coord();
     }
 
     if (!full_potential()) {
@@ -881,6 +1053,8 @@ inline void Simulation_context_base::initialize()
         beta_ri_djl_  = std::unique_ptr<Radial_integrals_beta<true>>(new Radial_integrals_beta<true>(unit_cell(), gk_cutoff() + 1, settings().nprii_beta_));
         aug_ri_       = std::unique_ptr<Radial_integrals_aug<false>>(new Radial_integrals_aug<false>(unit_cell(), pw_cutoff() + 1, settings().nprii_aug_));
         atomic_wf_ri_ = std::unique_ptr<Radial_integrals_atomic_wf>(new Radial_integrals_atomic_wf(unit_cell(), gk_cutoff(), 20));
+        vloc_ri_      = std::unique_ptr<Radial_integrals_vloc<false>>(new Radial_integrals_vloc<false>(unit_cell(), pw_cutoff(), settings().nprii_vloc_));
+        ps_core_ri_   = std::unique_ptr<Radial_integrals_rho_core_pseudo<false>>(new Radial_integrals_rho_core_pseudo<false>(unit_cell(), pw_cutoff(), settings().nprii_rho_core_));
     }
 
     //time_active_ = -runtime::wtime();
@@ -905,6 +1079,91 @@ inline void Simulation_context_base::initialize()
     initialized_ = true;
 }
 
+inline void Simulation_context_base::tune_evp_solvers()
+{
+    PROFILE("sirius::Simulation_context_base::tune_evp_solvers");
+
+    /* representative size of the eigen-value problem */
+    int n, nev;
+    if (full_potential()) {
+        /* estimated number of G+k vectors and the local orbitals */
+        n = static_cast<int>(unit_cell_.omega() * std::pow(gk_cutoff(), 3) / 6 / std::pow(pi, 2)) +
+            unit_cell_.mt_lo_basis_size();
+        nev = num_fv_states();
+    } else {
+        /* average size of the subspace of the iterative solver */
+        nev = num_bands();
+        n   = nev * (1 + iterative_solver_input_.subspace_size_) / 2;
+    }
+    n = std::max(n, nev + 1);
+
+    /* the Chebyshev solver is not tuned: it relies on the eigen-vectors of the previous SCF iteration and a benchmark
+     * from a random start is not representative; it must be selected in the input */
+    std::vector<ev_solver_t> candidates({ev_solver_t::lapack});
+    #if defined(__GPU) && defined(__MAGMA)
+    if (processing_unit() == GPU) {
+        candidates.push_back(ev_solver_t::magma);
+    }
+    #endif
+
+    std::vector<std::pair<int, int>> grids;
+    std::vector<int> block_sizes;
+    #ifdef __SCALAPACK
+    int npb = comm_band().size();
+    if (npb > 1) {
+        candidates.push_back(ev_solver_t::scalapack);
+        #ifdef __ELPA
+        candidates.push_back(ev_solver_t::elpa1);
+        candidates.push_back(ev_solver_t::elpa2);
+        #endif
+    }
+    for (int r = 1; r <= npb; r++) {
+        if (npb % r == 0) {
+            int c = npb / r;
+            /* grids which are far from square are not worth trying, except the one from the input */
+            if (std::max(r, c) <= 4 * std::min(r, c) || (r == mpi_grid_dims()[0] && c == mpi_grid_dims()[1])) {
+                grids.push_back(std::make_pair(r, c));
+            }
+        }
+    }
+    if (cyclic_block_size() > 0) {
+        block_sizes.push_back(cyclic_block_size());
+    } else {
+        for (int bs : {16, 32, 64, 128}) {
+            if (bs * static_cast<int>(std::sqrt(npb)) <= n) {
+                block_sizes.push_back(bs);
+            }
+        }
+        if (block_sizes.empty()) {
+            block_sizes.push_back(16);
+        }
+    }
+    #endif
+
+    /* solvers which are set in the input are not tuned */
+    std::vector<ev_solver_t> std_candidates(candidates);
+    std::vector<ev_solver_t> gen_candidates(candidates);
+    if (std_evp_solver_name().size()) {
+        std_candidates = {get_ev_solver_t(std_evp_solver_name())};
+    }
+    if (gen_evp_solver_name().size()) {
+        gen_candidates = {get_ev_solver_t(gen_evp_solver_name())};
+    }
+
+    Eigensolver_tuner tuner(comm(), comm_band(), n, nev, gamma_point(), processing_unit(),
+                            control().evp_autotune_file_, control().verbosity_);
+    auto cfg = tuner.tune(std_candidates, gen_candidates, grids, block_sizes);
+
+    std_evp_solver_type_ = cfg.std_solver;
+    gen_evp_solver_type_ = cfg.gen_solver;
+    if (cfg.num_ranks_row) {
+        blacs_grid_ = std::unique_ptr<BLACS_grid>(new BLACS_grid(comm_band(), cfg.num_ranks_row, cfg.num_ranks_col));
+        control_input_.cyclic_block_size_ = cfg.bs;
+    } else {
+        blacs_grid_ = std::unique_ptr<BLACS_grid>(new BLACS_grid(mpi_comm_self(), 1, 1));
+    }
+}
+
 inline void Simulation_context_base::print_info()
 {
     tm const* ptm = localtime(&start_time_.tv_sec); 
@@ -974,6 +1233,7 @@ inline void Simulation_context_base::print_info()
     printf("lmax_pot                           : %i\n", lmax_pot());
     printf("lmax_rf                            : %i\n", unit_cell_.lmax());
     printf("smearing width                     : %f\n", smearing_width());
+    printf("BLACS grid                         : %i x %i\n", blacs_grid_->num_ranks_row(), blacs_grid_->num_ranks_col());
     printf("cyclic block size                  : %i\n", cyclic_block_size());
     printf("|G+k| cutoff                       : %f\n", gk_cutoff());
 
@@ -1048,6 +1308,10 @@ inline void Simulation_context_base::print_info()
                 printf("PLASMA\n");
                 break;
             }
+            case ev_solver_t::chebyshev: {
+                printf("Chebyshev-filtered subspace iteration\n");
+                break;
+            }
             default: {
                 TERMINATE("wrong eigen-value solver");
             }
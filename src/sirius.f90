@@ -747,6 +747,19 @@ module sirius
             &bind(C, name="sirius_update_atomic_potential")
         end subroutine
 
+        subroutine sirius_update_atomic_positions()&
+            &bind(C, name="sirius_update_atomic_positions")
+        end subroutine
+
+        subroutine sirius_save_ionic_step(kset_id)&
+            &bind(C, name="sirius_save_ionic_step")
+            integer,                 intent(in)  :: kset_id
+        end subroutine
+
+        subroutine sirius_extrapolate_ionic_step()&
+            &bind(C, name="sirius_extrapolate_ionic_step")
+        end subroutine
+
         subroutine sirius_get_matching_coefficients(kset_id, ik, apwalm, ngkmax, apwordmax)&
             &bind(C, name="sirius_get_matching_coefficients")
             integer,                 intent(in)  :: kset_id
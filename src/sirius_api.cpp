@@ -49,6 +49,9 @@ std::map<std::string, sddk::timer*> ftimers;
 std::unique_ptr<sirius::Stress> stress_tensor{nullptr};
 std::unique_ptr<sirius::Force> forces{nullptr};
 
+/// Extrapolation of density and wave-functions between ionic steps.
+std::unique_ptr<sirius::Extrapolation> extrapolation{nullptr};
+
 extern "C" {
 
 /// Initialize the library.
@@ -72,6 +75,7 @@ void sirius_clear(void)
 {
     density = nullptr;
     potential = nullptr;
+    extrapolation = nullptr;
     dft_ground_state = nullptr;
     for (size_t i = 0; i < kset_list.size(); i++) {
         if (kset_list[i] != nullptr) {
@@ -230,6 +234,7 @@ void sirius_create_ground_state(int32_t* kset_id__)
 
 void sirius_delete_ground_state()
 {
+    extrapolation = nullptr;
     dft_ground_state = nullptr;
     hamiltonian = nullptr;
 }
@@ -2056,6 +2061,50 @@ void sirius_set_atom_pos(int32_t* atom_id, double* pos)
     sim_ctx->unit_cell().atom(*atom_id - 1).set_position(vector3d<double>(pos[0], pos[1], pos[2]));
 }
 
+/// Update the position-dependent data after the atoms were moved with sirius_set_atom_pos().
+void sirius_update_atomic_positions()
+{
+    sim_ctx->update_atomic_positions();
+    if (dft_ground_state != nullptr) {
+        dft_ground_state->update();
+    } else {
+        for (auto ks: kset_list) {
+            if (ks != nullptr) {
+                ks->update();
+            }
+        }
+        if (potential != nullptr) {
+            potential->update();
+        }
+        if (density != nullptr) {
+            density->update();
+        }
+    }
+}
+
+/// Save the converged density and wave-functions of the current ionic step.
+/** Must be called before the atoms are moved with sirius_set_atom_pos(). */
+void sirius_save_ionic_step(int32_t* kset_id__)
+{
+    if (extrapolation == nullptr) {
+        extrapolation = std::unique_ptr<sirius::Extrapolation>(
+            new sirius::Extrapolation(*sim_ctx, *density, *kset_list[*kset_id__],
+                                      sim_ctx->parameters_input().extrapolation_order_));
+    }
+    extrapolation->save();
+}
+
+/// Extrapolate density and wave-functions to the new atomic positions and generate the starting potential.
+/** Must be called after sirius_update_atomic_positions(). */
+void sirius_extrapolate_ionic_step()
+{
+    if (extrapolation == nullptr) {
+        TERMINATE("sirius_save_ionic_step() must be called first");
+    }
+    extrapolation->extrapolate();
+    potential->generate(*density);
+}
+
 void sirius_core_leakage(double* core_leakage)
 {
     *core_leakage = density->core_leakage();
@@ -159,16 +159,27 @@ class Smooth_periodic_function
 
             assert(gvecp_ != nullptr);
 
+            /* real functions are transformed on CPU with the real-to-complex FFT directly from / to f_rg */
+            bool is_real = std::is_same<T, double>::value && fft_->pu() == CPU;
+
             switch (direction__) {
                 case 1: {
                     gather_f_pw_fft();
-                    fft_->transform<1>(f_pw_fft_.at<CPU>());
-                    fft_->output(f_rg_.template at<CPU>());
+                    if (is_real) {
+                        fft_->transform<1>(f_pw_fft_.at<CPU>(), reinterpret_cast<double*>(f_rg_.template at<CPU>()));
+                    } else {
+                        fft_->transform<1>(f_pw_fft_.at<CPU>());
+                        fft_->output(f_rg_.template at<CPU>());
+                    }
                     break;
                 }
                 case -1: {
-                    fft_->input(f_rg_.template at<CPU>());
-                    fft_->transform<-1>(f_pw_fft_.at<CPU>());
+                    if (is_real) {
+                        fft_->transform<-1>(f_pw_fft_.at<CPU>(), reinterpret_cast<double*>(f_rg_.template at<CPU>()));
+                    } else {
+                        fft_->input(f_rg_.template at<CPU>());
+                        fft_->transform<-1>(f_pw_fft_.at<CPU>());
+                    }
                     int count  = gvecp_->gvec_fft_slab().counts[gvecp_->comm_ortho_fft().rank()];
                     int offset = gvecp_->gvec_fft_slab().offsets[gvecp_->comm_ortho_fft().rank()];
                     std::memcpy(f_pw_local_.at<CPU>(), f_pw_fft_.at<CPU>(offset), count * sizeof(double_complex));
@@ -179,4 +179,14 @@ enum class relativity_t
     dirac
 };
 
+/// Method of the forward integration of the radial equation.
+enum class radial_integrator_t
+{
+    /// Runge-Kutta method of 4th order.
+    rk4,
+
+    /// Adams-Bashforth-Moulton predictor-corrector of 4th order.
+    abm4
+};
+
 #endif // __TYPEDEFS_H__